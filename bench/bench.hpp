@@ -0,0 +1,99 @@
+/**
+ * @file bench.hpp
+ * @brief Tiny self-registering microbenchmark harness.
+ *
+ * @details A benchmark is a function that does its setup and then loops
+ * on state.keepRunning(); only the loop is timed.  The runner picks the
+ * iteration count so each repetition lasts long enough to measure.
+ *
+ *     BENCHMARK(spatial_query_nearest) {
+ *         ...setup...
+ *         state.setItemsPerIteration(queries.size());
+ *         while (state.keepRunning()) {...}
+ *     }
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class BenchmarkState {
+public:
+    explicit BenchmarkState(uint64_t iterations) : target(iterations) {}
+
+    /**
+     * @brief True while more timed iterations are wanted
+     */
+    bool keepRunning(){
+        if (done == 0 && !started) {
+            started = true;
+            start = std::chrono::steady_clock::now();
+        }
+        if (done == target) {
+            stop = std::chrono::steady_clock::now();
+            return false;
+        }
+        done++;
+        return true;
+    }
+
+    /**
+     * @brief Work items (queries, samples, ...) handled per iteration,
+     * used to report a throughput next to the time per iteration
+     */
+    void setItemsPerIteration(double items) { items_per_iteration = items; }
+
+    /**
+     * @brief Extra named number to report alongside the timing, like
+     * the compressed size of a map
+     */
+    void setCounter(const std::string& name, double value) { counters.emplace_back(name, value); }
+    const std::vector<std::pair<std::string, double>>& reportedCounters() const { return counters; }
+
+    double seconds() const { return std::chrono::duration<double>(stop - start).count(); }
+    uint64_t iterations() const { return target; }
+    double itemsPerIteration() const { return items_per_iteration; }
+
+private:
+    uint64_t target;
+    uint64_t done = 0;
+    bool started = false;
+    double items_per_iteration = 0;
+    std::vector<std::pair<std::string, double>> counters;
+    std::chrono::steady_clock::time_point start, stop;
+};
+
+/**
+ * @brief Keeps the compiler from deleting work whose result isn't used
+ */
+template <typename T>
+inline void doNotOptimize(const T& value){
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+using BenchmarkFunction = void (*)(BenchmarkState&);
+
+struct Benchmark {
+    std::string name;
+    BenchmarkFunction function;
+};
+
+std::vector<Benchmark>& benchmarkRegistry();
+
+inline bool registerBenchmark(const char* name, BenchmarkFunction function){
+    benchmarkRegistry().push_back(Benchmark{name, function});
+    return true;
+}
+
+#define BENCHMARK(name) \
+    static void name(BenchmarkState& state); \
+    static const bool name##_registered = registerBenchmark(#name, name); \
+    static void name(BenchmarkState& state)
@@ -0,0 +1,95 @@
+/**
+ * @file bench_compact_log.cpp
+ * @brief Encode and decode speed of compact log blocks.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "../session/compact_log.hpp"
+
+#include <cmath>
+#include <random>
+
+namespace {
+
+const size_t session_samples = 1 << 20;
+const size_t block_samples = 4096;
+
+/**
+ * @brief Samples shaped like a real session: the servo sweeping back and
+ * forth a degree at a time, distances following a wall with a little
+ * noise, and a read() every few samples at 9600 baud
+ */
+const std::vector<CompactSample>& recordedSamples(){
+    static std::vector<CompactSample> samples = []() {
+        std::mt19937 random(5);
+        std::normal_distribution<float> noise(0.0f, 0.7f);
+        std::uniform_int_distribution<int> per_read(1, 4);
+        std::vector<CompactSample> out(session_samples);
+        uint64_t timestamp_ns = 1000000000;
+        int degree = 0, step = 1, left_in_read = 0;
+        for (CompactSample& sample : out) {
+            if (left_in_read-- == 0) {
+                left_in_read = per_read(random);
+                timestamp_ns += 8000000 + random() % 500000;
+            }
+            const float wall = 30 + 12*std::sin(degree * 0.05f);
+            sample = CompactSample{timestamp_ns, degree, int(wall + noise(random))};
+            if (degree + step < 0 || degree + step > 180) {step = -step;}
+            degree += step;
+        }
+        return out;
+    }();
+    return samples;
+}
+
+std::vector<uint8_t> encodeAll(const std::vector<CompactSample>& samples){
+    std::vector<uint8_t> log;
+    CompactBlockEncoder encoder;
+    for (size_t first = 0; first < samples.size(); first += block_samples) {
+        encoder.reset(0, samples[first].timestamp_ns);
+        const size_t last = std::min(first + block_samples, samples.size());
+        for (size_t i = first; i < last; i++) {
+            encoder.add(samples[i].timestamp_ns, samples[i].degree, samples[i].distance_cm);
+        }
+        encoder.finish(log);
+    }
+    return log;
+}
+
+} // namespace
+
+BENCHMARK(compact_log_encode) {
+    const std::vector<CompactSample>& samples = recordedSamples();
+    state.setItemsPerIteration(double(samples.size()));
+    size_t bytes = 0;
+    while (state.keepRunning()) {
+        std::vector<uint8_t> log = encodeAll(samples);
+        bytes = log.size();
+        doNotOptimize(log.data());
+    }
+    state.setCounter("bytes/sample", double(bytes) / samples.size());
+}
+
+BENCHMARK(compact_log_decode) {
+    const std::vector<CompactSample>& samples = recordedSamples();
+    const std::vector<uint8_t> log = encodeAll(samples);
+    std::vector<CompactSample> block;
+    state.setItemsPerIteration(double(samples.size()));
+    while (state.keepRunning()) {
+        size_t offset = 0;
+        CompactBlockHeader header;
+        while (offset < log.size()
+               && decodeCompactBlock(log.data() + offset, log.size() - offset, block, header) == BlockStatus::Ok) {
+            offset += sizeof(header) + header.payload_bytes;
+            doNotOptimize(block.data());
+        }
+    }
+    // Both rates, encoded is the one a reader of the file sees, decoded
+    // is about four times that
+    const double seconds_per_pass = state.seconds() / state.iterations();
+    state.setCounter("encoded MB/s", log.size() / seconds_per_pass / 1e6);
+    state.setCounter("decoded MB/s", samples.size() * sizeof(CompactSample) / seconds_per_pass / 1e6);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file bench_compressed_grid.cpp
+ * @brief Size and access time of compressed tiles against raw tiles.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "bench_maps.hpp"
+#include "../mapping/compressed_grid.hpp"
+
+#include <cmath>
+#include <random>
+
+namespace {
+
+const size_t lookups = 1 << 20;
+
+/**
+ * @brief Building map where only the rooms near one corner were scanned,
+ * the rest is still unknown like a real session part way through
+ */
+const OccupancyGrid& scannedBuilding(){
+    static OccupancyGrid grid = []() {
+        OccupancyGrid building = makeBuildingGrid();
+        for (int y = 0; y < building.height(); y++) {
+            for (int x = 0; x < building.width(); x++) {
+                if (std::hypot(x, y) > 600) {building.data()[size_t(y)*building.width() + x] = OccupancyGrid::unknown;}
+            }
+        }
+        building.markModified();
+        return building;
+    }();
+    return grid;
+}
+
+/**
+ * @brief Random cells, clustered the way a renderer or planner walks
+ * the map rather than spread uniformly
+ */
+std::vector<std::pair<int, int>> clusteredCells(const OccupancyGrid& grid){
+    std::mt19937 random(11);
+    std::uniform_int_distribution<int> center(0, grid.width() - 1);
+    std::uniform_int_distribution<int> offset(-40, 40);
+    std::vector<std::pair<int, int>> cells(lookups);
+    int cx = center(random), cy = center(random);
+    for (size_t i = 0; i < lookups; i++) {
+        if (i % 256 == 0) {cx = center(random); cy = center(random);}
+        cells[i] = {std::clamp(cx + offset(random), 0, grid.width() - 1),
+                    std::clamp(cy + offset(random), 0, grid.height() - 1)};
+    }
+    return cells;
+}
+
+void benchmarkCompress(BenchmarkState& state, TileCompression mode){
+    const OccupancyGrid& grid = scannedBuilding();
+    size_t bytes = 0;
+    while (state.keepRunning()) {
+        CompressedGrid compressed = CompressedGrid::compress(grid, mode);
+        bytes = compressed.compressedBytes();
+        doNotOptimize(bytes);
+    }
+    state.setItemsPerIteration(double(grid.width()) * grid.height());
+    state.setCounter("bytes", double(bytes));
+}
+
+void benchmarkAccess(BenchmarkState& state, TileCompression mode){
+    const CompressedGrid compressed = CompressedGrid::compress(scannedBuilding(), mode);
+    const auto cells = clusteredCells(scannedBuilding());
+    state.setItemsPerIteration(lookups);
+    while (state.keepRunning()) {
+        int sum = 0;
+        for (const auto& [x, y] : cells) {sum += compressed.at(x, y);}
+        doNotOptimize(sum);
+    }
+}
+
+void benchmarkDecompress(BenchmarkState& state, TileCompression mode){
+    const CompressedGrid compressed = CompressedGrid::compress(scannedBuilding(), mode);
+    state.setItemsPerIteration(double(compressed.width()) * compressed.height());
+    while (state.keepRunning()) {
+        OccupancyGrid grid = compressed.decompress();
+        doNotOptimize(grid.data());
+    }
+}
+
+}  // namespace
+
+BENCHMARK(compressed_grid_compress) {benchmarkCompress(state, TileCompression::Best);}
+BENCHMARK(compressed_grid_compress_raw_tiles) {benchmarkCompress(state, TileCompression::RawOnly);}
+BENCHMARK(compressed_grid_access) {benchmarkAccess(state, TileCompression::Best);}
+BENCHMARK(compressed_grid_access_raw_tiles) {benchmarkAccess(state, TileCompression::RawOnly);}
+BENCHMARK(compressed_grid_decompress) {benchmarkDecompress(state, TileCompression::Best);}
+BENCHMARK(compressed_grid_decompress_raw_tiles) {benchmarkDecompress(state, TileCompression::RawOnly);}
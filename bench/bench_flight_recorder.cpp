@@ -0,0 +1,36 @@
+/**
+ * @file bench_flight_recorder.cpp
+ * @brief Cost of putting a sample into the flight recorder ring.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "../session/flight_recorder.hpp"
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+BENCHMARK(flight_recorder_sample) {
+    const std::string path = "/tmp/bench_flight_" + std::to_string(getpid());
+    FlightRecorder recorder;
+    if (!recorder.open(path, size_t(1) << 18)) {return;}
+
+    std::vector<ParsedSample> samples(4096);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = ParsedSample{int(i % 181), int(i % 50)};
+    }
+    state.setItemsPerIteration(double(samples.size()));
+    uint64_t timestamp_ns = 0;
+    while (state.keepRunning()) {
+        for (const ParsedSample& sample : samples) {
+            recorder.recordSample(timestamp_ns++, sample);
+        }
+    }
+    recorder.close();
+    std::remove(path.c_str());
+    std::remove((path + ".prev").c_str());
+}
@@ -0,0 +1,45 @@
+/**
+ * @file bench_latency_histogram.cpp
+ * @brief Cost of timing a pipeline stage, with recording on and off.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "../util/latency_histogram.hpp"
+
+#include <vector>
+
+BENCHMARK(latency_histogram_record) {
+    std::vector<uint64_t> durations(4096);
+    for (size_t i = 0; i < durations.size(); i++) {
+        durations[i] = (i * 2654435761u) % 5000000;
+    }
+    state.setItemsPerIteration(double(durations.size()));
+    while (state.keepRunning()) {
+        for (uint64_t duration : durations) {
+            recordStageLatency(PipelineStage::Render, duration);
+        }
+    }
+}
+
+BENCHMARK(latency_histogram_stage_timer) {
+    setStageLatencyEnabled(true);
+    state.setItemsPerIteration(1024);
+    while (state.keepRunning()) {
+        for (int i = 0; i < 1024; i++) {
+            StageTimer timer(PipelineStage::Present);
+        }
+    }
+    setStageLatencyEnabled(false);
+}
+
+BENCHMARK(latency_histogram_stage_timer_off) {
+    state.setItemsPerIteration(1024);
+    while (state.keepRunning()) {
+        for (int i = 0; i < 1024; i++) {
+            StageTimer timer(PipelineStage::Present);
+        }
+    }
+}
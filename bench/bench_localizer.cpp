@@ -0,0 +1,67 @@
+/**
+ * @file bench_localizer.cpp
+ * @brief One particle filter step (predict, weight, resample) with the
+ * default 10k particles, against the budget of one sweep.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "bench_maps.hpp"
+#include "../mapping/distance_field.hpp"
+#include "../mapping/localizer.hpp"
+#include "../mapping/raycaster.hpp"
+#include "../util/thread_pool.hpp"
+
+#include <cmath>
+
+namespace {
+
+// The arduino sends a sample every 30 ms and a sweep is 181 of them, so
+// a filter step has to fit well inside this to keep up
+const double sweep_ms = 181 * 30.0;
+const float max_range_cm = 400;
+
+/**
+ * @brief What the scanner sees from the middle of a room of the building
+ */
+Scan makeRoomScan(const OccupancyGrid& grid, const DistanceField& field, Vec2 position){
+    const Raycaster raycaster(grid, field);
+    Scan scan;
+    for (int degree = 1; degree <= 181; degree++) {
+        const RayHit hit = raycaster.cast(position, degreesToRadians(float(degree)), max_range_cm);
+        scan.samples.push_back(RangeSample{float(degree), hit.hit ? hit.range_cm : max_range_cm});
+    }
+    return scan;
+}
+
+}  // namespace
+
+BENCHMARK(localizer_update_10k) {
+    const OccupancyGrid grid = makeBuildingGrid();
+    DistanceField distance;
+    distance.build(grid);
+    LikelihoodModel model;
+    model.max_range_cm = max_range_cm;
+    LikelihoodField field;
+    field.build(grid, model);
+    const Pose2 scanner{730, 760, 0.3f};
+    const Scan scan = makeRoomScan(grid, distance, Vec2{scanner.x, scanner.y});
+
+    ThreadPool pool;
+    LocalizerConfig config;
+    MonteCarloLocalizer localizer(config, pool);
+    localizer.initialize(scanner, 20.0f, 0.1f);
+
+    state.setItemsPerIteration(double(config.particles));
+    while (state.keepRunning()) {
+        localizer.predict();
+        localizer.update(scan, field, max_range_cm);
+        doNotOptimize(localizer.estimate());
+    }
+    const LocalizerTiming& timing = localizer.timing();
+    state.setCounter("mean ms/update", timing.total_ms_sum / timing.updates);
+    state.setCounter("worst ms/update", timing.worst_total_ms);
+    state.setCounter("worst-case updates per sweep", sweep_ms / timing.worst_total_ms);
+}
@@ -0,0 +1,211 @@
+/**
+ * @file bench_main.cpp
+ * @brief Runs every registered benchmark and prints the timings.
+ *
+ * @details Results can also be written as JSON and checked against an
+ * earlier run's JSON, so a change can be timed before it goes in:
+ *
+ *     bench_runner [FILTER] [--json OUT.json] [--compare BASELINE.json] [--threshold PERCENT]
+ *
+ * A benchmark counts as regressed when its median is more than
+ * threshold percent (10 by default) slower than the baseline's and even
+ * its fastest repetition is slower than the baseline's median, so one
+ * noisy repetition isn't enough.  The exit status is 1 if any regressed.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+
+std::vector<Benchmark>& benchmarkRegistry(){
+    static std::vector<Benchmark> registry;
+    return registry;
+}
+
+namespace {
+
+const double min_repetition_seconds = 0.2;
+const int repetitions = 5;
+
+struct Result {
+    double ns_per_iteration;
+    double items_per_second;
+    std::vector<std::pair<std::string, double>> counters;
+    double min_ns_per_iteration = 0;
+    double max_ns_per_iteration = 0;
+};
+
+struct RunnerOptions {
+    std::string filter;
+    std::string json_path;
+    std::string baseline_path;
+    double threshold_percent = 10;
+};
+
+bool parseOptions(int argc, char** argv, RunnerOptions& options){
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc) {
+            options.json_path = argv[++i];
+        } else if (arg == "--compare" && i + 1 < argc) {
+            options.baseline_path = argv[++i];
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            options.threshold_percent = std::atof(argv[++i]);
+        } else if (arg[0] != '-' && options.filter.empty()) {
+            options.filter = arg;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Times one benchmark, median of several repetitions
+ *
+ * @details The iteration count doubles until one run takes long enough,
+ * then that count is reused for every repetition.
+ *
+ * @param benchmark The benchmark to run
+ */
+Result runBenchmark(const Benchmark& benchmark){
+    uint64_t iterations = 1;
+    while (true) {
+        BenchmarkState state(iterations);
+        benchmark.function(state);
+        if (state.seconds() >= min_repetition_seconds || iterations >= (1ull << 40)) {break;}
+        const double scale = state.seconds() > 0 ? min_repetition_seconds / state.seconds() : 100;
+        iterations = std::max<uint64_t>(iterations * 2, uint64_t(iterations * std::min(scale * 1.2, 100.0)));
+    }
+
+    std::vector<Result> runs;
+    for (int i = 0; i < repetitions; i++) {
+        BenchmarkState state(iterations);
+        benchmark.function(state);
+        const double seconds = state.seconds();
+        runs.push_back(Result{seconds * 1e9 / iterations,
+                              state.itemsPerIteration() * iterations / seconds,
+                              state.reportedCounters()});
+    }
+    std::sort(runs.begin(), runs.end(), [](const Result& a, const Result& b) {
+        return a.ns_per_iteration < b.ns_per_iteration;
+    });
+    Result median = runs[runs.size() / 2];
+    median.min_ns_per_iteration = runs.front().ns_per_iteration;
+    median.max_ns_per_iteration = runs.back().ns_per_iteration;
+    return median;
+}
+
+/**
+ * @brief Writes results as JSON, one benchmark per line
+ */
+bool writeJson(const std::string& path, const std::vector<std::pair<std::string, Result>>& results){
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::fprintf(stderr, "Error writing %s\n", path.c_str());
+        return false;
+    }
+    std::fprintf(file, "{\"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& [name, result] = results[i];
+        std::fprintf(file, "  {\"name\": \"%s\", \"ns_per_iteration\": %.3f, \"min_ns_per_iteration\": %.3f, "
+                     "\"max_ns_per_iteration\": %.3f, \"items_per_second\": %.6e, \"counters\": {",
+                     name.c_str(), result.ns_per_iteration, result.min_ns_per_iteration,
+                     result.max_ns_per_iteration, result.items_per_second);
+        for (size_t c = 0; c < result.counters.size(); c++) {
+            std::fprintf(file, "%s\"%s\": %.6g", c ? ", " : "", result.counters[c].first.c_str(),
+                         result.counters[c].second);
+        }
+        std::fprintf(file, "}}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "]}\n");
+    return std::fclose(file) == 0;
+}
+
+/**
+ * @brief Median ns/iter per benchmark from a file writeJson wrote
+ *
+ * @details Only understands that layout (one benchmark per line), which
+ * keeps the runner free of a JSON library.
+ */
+bool readBaseline(const std::string& path, std::map<std::string, double>& baseline){
+    std::ifstream file(path);
+    if (!file) {
+        std::fprintf(stderr, "Error reading baseline %s\n", path.c_str());
+        return false;
+    }
+    const std::string name_key = "\"name\": \"";
+    const std::string time_key = "\"ns_per_iteration\": ";
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t name_at = line.find(name_key);
+        const size_t time_at = line.find(time_key);
+        if (name_at == std::string::npos || time_at == std::string::npos) {continue;}
+        const size_t name_start = name_at + name_key.size();
+        const size_t name_end = line.find('"', name_start);
+        if (name_end == std::string::npos) {continue;}
+        baseline[line.substr(name_start, name_end - name_start)] = std::atof(line.c_str() + time_at + time_key.size());
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv){
+    // Optional substring filter, e.g. ./bench_runner spatial_query
+    RunnerOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage: %s [FILTER] [--json OUT.json] [--compare BASELINE.json] [--threshold PERCENT]\n",
+                     argv[0]);
+        return 1;
+    }
+    std::map<std::string, double> baseline;
+    if (!options.baseline_path.empty() && !readBaseline(options.baseline_path, baseline)) {return 1;}
+
+    std::vector<std::pair<std::string, Result>> results;
+    std::vector<std::string> regressed;
+    for (const Benchmark& benchmark : benchmarkRegistry()) {
+        if (benchmark.name.find(options.filter) == std::string::npos) {continue;}
+        const Result result = runBenchmark(benchmark);
+        results.emplace_back(benchmark.name, result);
+        if (result.items_per_second > 0) {
+            std::printf("%-40s %14.1f ns/iter %14.3e items/s\n", benchmark.name.c_str(),
+                        result.ns_per_iteration, result.items_per_second);
+        } else {
+            std::printf("%-40s %14.1f ns/iter\n", benchmark.name.c_str(), result.ns_per_iteration);
+        }
+        for (const auto& [name, value] : result.counters) {
+            std::printf("    %-36s %14.0f\n", name.c_str(), value);
+        }
+
+        const auto before = baseline.find(benchmark.name);
+        if (before != baseline.end() && before->second > 0) {
+            const double change_percent = 100 * (result.ns_per_iteration / before->second - 1);
+            const bool slower = change_percent > options.threshold_percent
+                             && result.min_ns_per_iteration > before->second;
+            const bool faster = change_percent < -options.threshold_percent
+                             && result.max_ns_per_iteration < before->second;
+            std::printf("    %-36s %+13.1f%% %s\n", "vs baseline", change_percent,
+                        slower ? "REGRESSION" : faster ? "faster" : "");
+            if (slower) {regressed.push_back(benchmark.name);}
+        }
+        std::fflush(stdout);
+    }
+
+    if (!options.json_path.empty() && !writeJson(options.json_path, results)) {return 1;}
+    if (!options.baseline_path.empty()) {
+        std::printf("%zu of %zu benchmarks regressed more than %.1f%%\n", regressed.size(), results.size(),
+                    options.threshold_percent);
+        for (const std::string& name : regressed) {std::printf("    %s\n", name.c_str());}
+    }
+    return regressed.empty() ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file bench_map_update.cpp
+ * @brief Cost of folding a sample into the map, and of casting rays
+ * through it.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "bench_maps.hpp"
+#include "../mapping/coverage_map.hpp"
+#include "../mapping/distance_field.hpp"
+#include "../mapping/raycaster.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Same setup as main, 1 cm cells with the scanner in the middle
+const int map_cells = 400;
+const float max_range_cm = 50;
+
+struct SweepSample {
+    float degree;
+    float distance_cm;
+};
+
+std::vector<SweepSample> makeSweep(){
+    std::vector<SweepSample> sweep;
+    for (int degree = 0; degree <= 180; degree++) {
+        sweep.push_back(SweepSample{float(degree), 25 + 20*std::fabs(std::sin(degree * 0.05f))});
+    }
+    return sweep;
+}
+
+void benchmarkIntegrate(BenchmarkState& state, bool with_coverage){
+    OccupancyGrid grid(map_cells, map_cells, 1.0f, Vec2{-map_cells/2.0f, -map_cells/2.0f});
+    CoverageMap coverage(grid);
+    const std::vector<SweepSample> sweep = makeSweep();
+    const Pose2 scanner;
+    uint32_t time_ms = 0;
+
+    state.setItemsPerIteration(double(sweep.size()));
+    while (state.keepRunning()) {
+        for (const SweepSample& sample : sweep) {
+            grid.integrateRay(scanner, sample.degree, sample.distance_cm, max_range_cm,
+                              with_coverage ? &coverage : nullptr, time_ms);
+        }
+        time_ms++;
+        doNotOptimize(grid.data()[0]);
+    }
+}
+
+}  // namespace
+
+BENCHMARK(map_update_integrate_ray) {benchmarkIntegrate(state, false);}
+BENCHMARK(map_update_integrate_ray_coverage) {benchmarkIntegrate(state, true);}
+
+BENCHMARK(raycast_building) {
+    const OccupancyGrid grid = makeBuildingGrid();
+    DistanceField field;
+    field.build(grid);
+    const Raycaster raycaster(grid, field);
+
+    std::mt19937 random(4);
+    std::uniform_real_distribution<float> coordinate(0.0f, 5000.0f);
+    std::uniform_real_distribution<float> angle(0.0f, float(2*M_PI));
+    struct Cast {
+        Vec2 start;
+        float angle_rad;
+    };
+    std::vector<Cast> casts(4096);
+    for (Cast& cast : casts) {cast = Cast{Vec2{coordinate(random), coordinate(random)}, angle(random)};}
+
+    state.setItemsPerIteration(double(casts.size()));
+    while (state.keepRunning()) {
+        for (const Cast& cast : casts) {
+            const RayHit hit = raycaster.cast(cast.start, cast.angle_rad, 1000.0f);
+            doNotOptimize(hit);
+        }
+    }
+}
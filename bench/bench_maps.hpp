@@ -0,0 +1,38 @@
+/**
+ * @file bench_maps.hpp
+ * @brief Synthetic maps shared by the mapping benchmarks.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "../mapping/occupancy_grid.hpp"
+
+/**
+ * @brief A building floor: a grid of rooms with a door in every wall
+ *
+ * @details Cells are 5 cm, so the default 1000x1000 grid is a 50 m
+ * square split into 5 m rooms.  Everything not a wall is marked free.
+ *
+ * @param cells Grid edge length in cells
+ * @param room_cells Room edge length in cells
+ */
+inline OccupancyGrid makeBuildingGrid(int cells = 1000, int room_cells = 100){
+    OccupancyGrid grid(cells, cells, 5.0f, Vec2{0, 0});
+    int8_t* data = grid.data();
+    const int door = room_cells / 5;
+    for (int y = 0; y < cells; y++) {
+        for (int x = 0; x < cells; x++) {
+            const int in_room_x = x % room_cells;
+            const int in_room_y = y % room_cells;
+            const bool outer = x == 0 || y == 0 || x == cells - 1 || y == cells - 1;
+            const bool wall_x = in_room_x == 0 && !(in_room_y > room_cells/2 - door/2 && in_room_y < room_cells/2 + door/2);
+            const bool wall_y = in_room_y == 0 && !(in_room_x > room_cells/2 - door/2 && in_room_x < room_cells/2 + door/2);
+            data[size_t(y)*cells + x] = (outer || wall_x || wall_y) ? OccupancyGrid::max_log_odds : -OccupancyGrid::max_log_odds;
+        }
+    }
+    grid.markModified();
+    return grid;
+}
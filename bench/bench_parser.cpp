@@ -0,0 +1,64 @@
+/**
+ * @file bench_parser.cpp
+ * @brief Throughput of SampleParser on serial-sized chunks.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "../ingest/sample_parser.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace {
+
+/**
+ * @brief A sweep back and forth as the arduino sends it, "deg:dist.xx|"
+ */
+std::string makeSerialStream(size_t samples){
+    std::string stream;
+    int degree = 0, step = 1;
+    for (size_t i = 0; i < samples; i++) {
+        const double distance = 30 + 15*std::sin(degree * 0.07);
+        stream += std::to_string(degree) + ":" + std::to_string(distance).substr(0, 5) + "|";
+        if (degree + step < 0 || degree + step > 180) {step = -step;}
+        degree += step;
+    }
+    return stream;
+}
+
+}  // namespace
+
+BENCHMARK(parser_feed_serial_chunks) {
+    const size_t samples = 4096;
+    const std::string stream = makeSerialStream(samples);
+    // read() on the port hands back at most 255 bytes, usually far fewer
+    const size_t chunk_bytes = 37;
+    state.setItemsPerIteration(double(samples));
+    int checksum = 0;
+    while (state.keepRunning()) {
+        SampleParser parser;
+        for (size_t offset = 0; offset < stream.size(); offset += chunk_bytes) {
+            const size_t count = std::min(chunk_bytes, stream.size() - offset);
+            parser.feed(stream.data() + offset, count, [&](const ParsedSample& sample){
+                checksum += sample.distance_cm;
+            });
+        }
+        doNotOptimize(checksum);
+    }
+}
+
+BENCHMARK(parser_parse_message) {
+    const std::string message = "137:42.17";
+    state.setItemsPerIteration(1024);
+    ParsedSample sample;
+    while (state.keepRunning()) {
+        for (int i = 0; i < 1024; i++) {
+            parseMessage(message, sample);
+            doNotOptimize(sample);
+        }
+    }
+}
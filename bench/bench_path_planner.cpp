@@ -0,0 +1,69 @@
+/**
+ * @file bench_path_planner.cpp
+ * @brief Jump point search on the building map, single and batched.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "bench_maps.hpp"
+#include "../mapping/path_planner.hpp"
+#include "../util/thread_pool.hpp"
+
+#include <random>
+
+namespace {
+
+/**
+ * @brief Random start/goal pairs, both in free space
+ *
+ * @param grid Map to pick cells from
+ * @param count How many requests
+ */
+std::vector<PlanRequest> randomRequests(const OccupancyGrid& grid, size_t count){
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> cell(1, grid.width() - 2);
+    auto freePoint = [&]() {
+        while (true) {
+            const int x = cell(random), y = cell(random);
+            if (!grid.isOccupied(x, y)) {return grid.cellCenter(x, y);}
+        }
+    };
+    std::vector<PlanRequest> requests(count);
+    for (PlanRequest& request : requests) {
+        request.start = freePoint();
+        request.goal = freePoint();
+    }
+    return requests;
+}
+
+}  // namespace
+
+BENCHMARK(path_planner_building_query) {
+    const OccupancyGrid grid = makeBuildingGrid();
+    PathPlanner planner(grid);
+    const std::vector<PlanRequest> requests = randomRequests(grid, 64);
+    size_t next = 0;
+
+    state.setItemsPerIteration(1);
+    while (state.keepRunning()) {
+        const PlanRequest& request = requests[next++ % requests.size()];
+        PlanResult result = planner.plan(request.start, request.goal);
+        doNotOptimize(result.length_cm);
+    }
+}
+
+BENCHMARK(path_planner_building_batch_64) {
+    static ThreadPool pool;
+    const OccupancyGrid grid = makeBuildingGrid();
+    BatchPathPlanner planner(grid, pool);
+    const std::vector<PlanRequest> requests = randomRequests(grid, 64);
+    std::vector<PlanResult> results;
+
+    state.setItemsPerIteration(requests.size());
+    while (state.keepRunning()) {
+        planner.plan(requests, results);
+        doNotOptimize(results.data());
+    }
+}
@@ -0,0 +1,71 @@
+/**
+ * @file bench_radar.cpp
+ * @brief Cost of drawing the radar, per frame and per piece.
+ *
+ * @details Needs opencv, left out of the build with NO_OPENCV=1.  Nothing
+ * is shown, so the numbers are drawing only, not the window.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "../render/radar.hpp"
+
+BENCHMARK(radar_draw_line_at_angle) {
+    cv::Mat frame = cv::Mat::zeros(size, CV_8UC3);
+    state.setItemsPerIteration(181);
+    while (state.keepRunning()) {
+        for (int angle = 0; angle <= 180; angle++) {
+            drawLineAtAngle(frame, circle_center, angle, 100, green, false);
+        }
+        doNotOptimize(frame.data[0]);
+    }
+}
+
+BENCHMARK(radar_draw_line_at_angle_text) {
+    cv::Mat frame = cv::Mat::zeros(size, CV_8UC3);
+    state.setItemsPerIteration(181);
+    while (state.keepRunning()) {
+        for (int angle = 0; angle <= 180; angle++) {
+            drawLineAtAngle(frame, circle_center, angle, 100, green, true);
+        }
+        doNotOptimize(frame.data[0]);
+    }
+}
+
+BENCHMARK(radar_draw_radar) {
+    cv::Mat frame;
+    while (state.keepRunning()) {
+        drawRadar(frame);
+        doNotOptimize(frame.data[0]);
+    }
+}
+
+BENCHMARK(radar_update_radar) {
+    cv::Mat frame;
+    drawRadar(frame);
+    line_deque.clear();
+    int degree = 0, step = 1;
+    while (state.keepRunning()) {
+        updateRadar(frame, degree, 20 + degree % 30);
+        if (degree + step < 0 || degree + step > 180) {step = -step;}
+        degree += step;
+        doNotOptimize(frame.data[0]);
+    }
+    line_deque.clear();
+}
+
+BENCHMARK(radar_update_radar_cached) {
+    cv::Mat frame;
+    drawRadar(frame);
+    line_deque.clear();
+    int degree = 0, step = 1;
+    while (state.keepRunning()) {
+        updateRadarCached(frame, degree, 20 + degree % 30);
+        if (degree + step < 0 || degree + step > 180) {step = -step;}
+        degree += step;
+        doNotOptimize(frame.data[0]);
+    }
+    line_deque.clear();
+}
@@ -0,0 +1,91 @@
+/**
+ * @file bench_spatial_query.cpp
+ * @brief Throughput of the batched spatial query API.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "bench_maps.hpp"
+#include "../mapping/spatial_query.hpp"
+#include "../util/thread_pool.hpp"
+
+#include <cmath>
+#include <random>
+
+namespace {
+
+const size_t batch_size = 65536;
+
+/**
+ * @brief Engine over the building map, shared by all three benchmarks
+ */
+SpatialQueryEngine& buildingEngine(){
+    static ThreadPool pool;
+    static SpatialQueryEngine engine(pool);
+    static bool ready = false;
+    if (!ready) {
+        engine.setSnapshot(makeMapSnapshot(makeBuildingGrid(), &pool));
+        ready = true;
+    }
+    return engine;
+}
+
+Vec2 randomPoint(std::mt19937& random){
+    std::uniform_real_distribution<float> coordinate(0.0f, 5000.0f);
+    return Vec2{coordinate(random), coordinate(random)};
+}
+
+}  // namespace
+
+BENCHMARK(spatial_query_nearest_obstacle) {
+    SpatialQueryEngine& engine = buildingEngine();
+    std::mt19937 random(1);
+    std::vector<Vec2> points(batch_size);
+    for (Vec2& point : points) {point = randomPoint(random);}
+    std::vector<NearestObstacle> results;
+
+    state.setItemsPerIteration(batch_size);
+    while (state.keepRunning()) {
+        engine.nearestObstacle(points, results);
+        doNotOptimize(results.data());
+    }
+}
+
+BENCHMARK(spatial_query_segment_free) {
+    SpatialQueryEngine& engine = buildingEngine();
+    std::mt19937 random(2);
+    std::uniform_real_distribution<float> offset(-300.0f, 300.0f);
+    std::vector<Segment> segments(batch_size);
+    for (Segment& segment : segments) {
+        segment.from = randomPoint(random);
+        segment.to = Vec2{segment.from.x + offset(random), segment.from.y + offset(random)};
+    }
+    std::vector<uint8_t> results;
+
+    state.setItemsPerIteration(batch_size);
+    while (state.keepRunning()) {
+        engine.segmentFree(segments, results);
+        doNotOptimize(results.data());
+    }
+}
+
+BENCHMARK(spatial_query_range_along_ray) {
+    SpatialQueryEngine& engine = buildingEngine();
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> angle(0.0f, float(2*M_PI));
+    std::vector<Ray> rays(batch_size);
+    for (Ray& ray : rays) {
+        ray.start = randomPoint(random);
+        ray.angle_rad = angle(random);
+        ray.max_range_cm = 1000.0f;
+    }
+    std::vector<RayHit> results;
+
+    state.setItemsPerIteration(batch_size);
+    while (state.keepRunning()) {
+        engine.rangeAlongRay(rays, results);
+        doNotOptimize(results.data());
+    }
+}
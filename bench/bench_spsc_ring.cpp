@@ -0,0 +1,65 @@
+/**
+ * @file bench_spsc_ring.cpp
+ * @brief Cost of handing a chunk from the ingest thread to the main loop.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "../ingest/serial_ingest.hpp"
+#include "../util/spsc_ring.hpp"
+
+#include <atomic>
+#include <thread>
+
+BENCHMARK(spsc_ring_push_pop_chunk) {
+    SpscRing<IngestChunk> ring(1024);
+    IngestChunk chunk;
+    chunk.bytes = 40;
+    state.setItemsPerIteration(64);
+    uint64_t checksum = 0;
+    while (state.keepRunning()) {
+        for (int i = 0; i < 64; i++) {
+            chunk.read_ns = uint64_t(i);
+            ring.push(chunk);
+        }
+        IngestChunk out;
+        while (ring.pop(out)) {checksum += out.read_ns;}
+        doNotOptimize(checksum);
+    }
+}
+
+BENCHMARK(spsc_ring_cross_thread) {
+    // A producer on another thread, as with the ingest thread, so the
+    // indices really do bounce between cores; either side yields when
+    // it can't go on so a single core still makes progress
+    SpscRing<uint64_t> ring(1024);
+    std::atomic<bool> stop{false};
+    std::thread producer([&]{
+        uint64_t value = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (ring.push(value)) {
+                value++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    state.setItemsPerIteration(1024);
+    uint64_t checksum = 0;
+    while (state.keepRunning()) {
+        uint64_t value;
+        for (int taken = 0; taken < 1024;) {
+            if (ring.pop(value)) {
+                checksum += value;
+                taken++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        doNotOptimize(checksum);
+    }
+    stop.store(true, std::memory_order_relaxed);
+    producer.join();
+}
@@ -0,0 +1,22 @@
+/**
+ * @file bench_trace.cpp
+ * @brief Cost of a TRACE_SCOPE with tracing off, the case every build pays.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "bench.hpp"
+#include "../util/trace.hpp"
+
+BENCHMARK(trace_scope_disabled) {
+    state.setItemsPerIteration(1024);
+    int work = 0;
+    while (state.keepRunning()) {
+        for (int i = 0; i < 1024; i++) {
+            TRACE_SCOPE("bench");
+            work += i;
+            doNotOptimize(work);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * @file arduino_emulator.hpp
+ * @brief Produces the same "degree:distance|" stream the arduino sketch
+ * prints, for load tests and soak runs without the hardware.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * @brief Sweeps 1 to 180 degrees and back over a room with a wall 40 cm
+ * in front, capped at 300 cm, with a little jitter in the distances
+ */
+class ArduinoEmulator {
+public:
+    // Time the sketch waits per step for the servo to settle
+    static constexpr uint64_t sample_interval_ns = 30000000;
+
+    /**
+     * @brief Appends the next message to out
+     */
+    void next(std::string& out){
+        const double radians = degree * M_PI / 180;
+        const double wall = 40 / std::max(0.2, std::fabs(std::sin(radians)));
+        char message[32];
+        const int length = std::snprintf(message, sizeof(message), "%d:%.2f|", degree,
+                                         std::min(wall, 300.0) + (sample++ % 7) * 0.13);
+        out.append(message, size_t(length));
+        degree += step;
+        if (degree == 181 || degree == 0) {
+            step = -step;
+            degree += 2*step;
+        }
+    }
+
+    uint64_t samples() const { return sample; }
+
+private:
+    int degree = 1;
+    int step = 1;
+    uint64_t sample = 0;
+};
@@ -0,0 +1,52 @@
+/**
+ * @file sample_parser.cpp
+ * @brief Message validation for SampleParser.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "sample_parser.hpp"
+
+#include <charconv>
+#include <iostream>
+
+namespace {
+
+/**
+ * @brief Reads the leading integer of a field, like std::stoi would
+ *
+ * @details Leading whitespace is skipped and anything after the digits
+ * (the ".34" of "12.34") is ignored, but there must be digits.
+ *
+ * @param field The text to read
+ * @param value Set to the number read
+ */
+bool leadingInt(std::string_view field, int& value){
+    size_t first = 0;
+    while (first < field.size() && (field[first] == ' ' || field[first] == '\r' || field[first] == '\n' || field[first] == '\t')) {
+        first++;
+    }
+    if (first < field.size() && field[first] == '+') {first++;}
+    const char* begin = field.data() + first;
+    const char* end = field.data() + field.size();
+    return std::from_chars(begin, end, value).ec == std::errc();
+}
+
+}  // namespace
+
+bool parseMessage(std::string_view message, ParsedSample& sample){
+    // Break up info into specific data points
+    const size_t data_delimiter_pos = message.find(':');
+    if (data_delimiter_pos == std::string_view::npos){
+        std::cerr << "Invalid message format (breakpoints?): " << message << std::endl;
+        return false;
+    }
+
+    if (!leadingInt(message.substr(0, data_delimiter_pos), sample.degree) ||
+        !leadingInt(message.substr(data_delimiter_pos + 1), sample.distance_cm)){
+        std::cerr << "Invalid message format (numbers?): " << message << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file sample_parser.hpp
+ * @brief Splits the arduino's "degree:distance|" stream into samples.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+struct ParsedSample {
+    int degree = 0;
+    int distance_cm = 0;   // the arduino sends a float, the fraction is dropped
+};
+
+/**
+ * @brief Turns one "degree:distance" message into a sample
+ *
+ * @details Returns false (and prints why) for anything that isn't two
+ * numbers split by a ':' instead of throwing, so a garbled message off
+ * the serial line is skipped rather than ending the program.
+ *
+ * @param message The text between two '|' delimiters
+ * @param sample Filled in when the message is valid
+ */
+bool parseMessage(std::string_view message, ParsedSample& sample);
+
+/**
+ * @brief Buffers serial chunks and hands back complete samples
+ *
+ * @details Chunks can split a message anywhere, so whatever follows the
+ * last '|' is kept until the next chunk arrives.
+ */
+class SampleParser {
+public:
+    /**
+     * @brief Adds a chunk and calls on_sample for every complete sample
+     *
+     * @param bytes The chunk read off the serial port
+     * @param count Bytes in the chunk
+     * @param on_sample Called as on_sample(const ParsedSample&)
+     */
+    template <typename F>
+    void feed(const char* bytes, size_t count, F&& on_sample);
+
+    uint64_t samples() const { return sample_count; }
+    uint64_t invalidMessages() const { return invalid_count; }
+
+private:
+    std::string data;
+    uint64_t sample_count = 0;
+    uint64_t invalid_count = 0;
+};
+
+template <typename F>
+void SampleParser::feed(const char* bytes, size_t count, F&& on_sample){
+    data.append(bytes, count);
+
+    // Parse data for breakpoints in send info
+    size_t start = 0;
+    size_t measurement_delimiter_pos;
+    while ((measurement_delimiter_pos = data.find('|', start)) != std::string::npos){
+        const std::string_view message(data.data() + start, measurement_delimiter_pos - start);
+        start = measurement_delimiter_pos + 1;
+
+        ParsedSample sample;
+        if (parseMessage(message, sample)) {
+            sample_count++;
+            on_sample(sample);
+        } else {
+            invalid_count++;
+        }
+    }
+    data.erase(0, start);
+}
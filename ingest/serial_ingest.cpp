@@ -0,0 +1,168 @@
+/**
+ * @file serial_ingest.cpp
+ * @brief The ingest thread's read loop and its real-time setup.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "serial_ingest.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include "../session/session_log.hpp"
+#include "../util/latency_histogram.hpp"
+#include "../util/trace.hpp"
+
+namespace {
+
+/**
+ * @brief Sleeps until an absolute steady clock time, clock_nanosleep on
+ * Linux so a late timer isn't made later by working out a relative sleep
+ */
+void sleepUntil(uint64_t deadline_ns){
+#ifdef __linux__
+    const timespec deadline{time_t(deadline_ns / 1000000000), long(deadline_ns % 1000000000)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+#else
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline_ns)));
+#endif
+}
+
+/**
+ * @brief SCHED_FIFO and core pinning for a running thread, printing what
+ * failed
+ */
+bool applyRealtime(std::thread& thread, const IngestRealtime& realtime){
+#ifdef __linux__
+    if (realtime.cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(realtime.cpu, &cpus);
+        const int error = pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+        if (error != 0) {
+            std::cerr << "Error pinning ingest thread to CPU " << realtime.cpu << ": " << strerror(error) << std::endl;
+            return false;
+        }
+    }
+    if (realtime.fifo_priority > 0) {
+        sched_param param{};
+        param.sched_priority = realtime.fifo_priority;
+        const int error = pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param);
+        if (error != 0) {
+            std::cerr << "Error setting SCHED_FIFO priority " << realtime.fifo_priority << " for ingest thread: "
+                      << strerror(error) << (error == EPERM ? " (needs CAP_SYS_NICE or an rtprio limit)" : "")
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+#else
+    (void)thread;
+    if (realtime.cpu >= 0 || realtime.fifo_priority > 0) {
+        std::cerr << "Real-time ingest scheduling needs Linux" << std::endl;
+        return false;
+    }
+    return true;
+#endif
+}
+
+} // namespace
+
+bool lockAllMemory(){
+#ifdef __linux__
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        std::cerr << "Error locking memory: " << strerror(errno)
+                  << (errno == ENOMEM || errno == EPERM ? " (raise ulimit -l or give CAP_IPC_LOCK)" : "") << std::endl;
+        return false;
+    }
+    return true;
+#else
+    std::cerr << "Locking memory needs Linux" << std::endl;
+    return false;
+#endif
+}
+
+SerialIngest::SerialIngest(size_t queue_chunks) : queue(queue_chunks) {}
+
+SerialIngest::~SerialIngest(){
+    stop();
+}
+
+bool SerialIngest::start(int fd, uint64_t period_ns, const IngestRealtime& realtime){
+    this->period_ns = period_ns;
+    running.store(true, std::memory_order_relaxed);
+    thread = std::thread(&SerialIngest::run, this, fd);
+    // Applied from here so a failure can stop everything before main goes on
+    if (!applyRealtime(thread, realtime)) {
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void SerialIngest::stop(){
+    running.store(false, std::memory_order_relaxed);
+    if (thread.joinable()) {thread.join();}
+}
+
+void SerialIngest::run(int fd){
+    setTraceThreadName("ingest");
+    IngestChunk chunk;
+    uint64_t deadline_ns = monotonicNanoseconds() + period_ns;
+    while (running.load(std::memory_order_relaxed)) {
+        sleepUntil(deadline_ns);
+        const uint64_t woke_ns = monotonicNanoseconds();
+        recordStageLatency(PipelineStage::IngestWakeup, woke_ns - std::min(woke_ns, deadline_ns));
+        // Catching up on missed periods would just read an empty port
+        // several times, start again from now instead
+        if (woke_ns > deadline_ns + period_ns) {
+            late_wakeups.store(late_wakeups.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            deadline_ns = woke_ns;
+        }
+        deadline_ns += period_ns;
+
+        // Everything the port has, a burst can be more than one chunk
+        while (true) {
+            const uint64_t read_start_ns = monotonicNanoseconds();
+            const ssize_t bytes_read = read(fd, chunk.data, sizeof(chunk.data));
+            if (bytes_read <= 0) {
+                if (bytes_read < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                    read_errors.store(read_errors.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                }
+                break;
+            }
+            chunk.read_ns = monotonicNanoseconds();
+            chunk.bytes = uint32_t(bytes_read);
+            if (stageLatencyEnabled()) {recordStageLatency(PipelineStage::Read, chunk.read_ns - read_start_ns);}
+            traceComplete("read", read_start_ns, chunk.read_ns);
+            if (!queue.push(chunk)) {
+                dropped_chunks.store(dropped_chunks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+            if (size_t(bytes_read) < sizeof(chunk.data)) {break;}
+        }
+    }
+}
+
+void printIngestJitter(std::ostream& out, const SerialIngest& ingest){
+    const LatencySummary wakeups = mergeStageLatencies()[size_t(PipelineStage::IngestWakeup)];
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(1) << "Ingest wakeup latency (us, period " << ingest.periodNs() / 1e3
+        << "): p50 " << wakeups.percentile(0.5) / 1e3 << " p99 " << wakeups.percentile(0.99) / 1e3
+        << " p99.9 " << wakeups.percentile(0.999) / 1e3 << " max " << wakeups.max_ns / 1e3
+        << " over " << wakeups.count << " wakeups, " << ingest.lateWakeups() << " over a period late, "
+        << ingest.droppedChunks() << " chunks dropped" << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,112 @@
+/**
+ * @file serial_ingest.hpp
+ * @brief Reads the serial port on its own thread, optionally real-time,
+ * and hands the chunks to the main loop through a lock-free queue.
+ *
+ * @details On the main loop a read waits behind drawing, imshow and
+ * sweep-end mapping, so a chunk's timestamp is off by however long those
+ * took.  The ingest thread does nothing but read: it wakes on a fixed
+ * period at an absolute deadline, reads whatever the port has, stamps it
+ * and pushes it into an SpscRing the main loop drains.  How late each
+ * wakeup came (now minus the deadline) goes into the "ingest wakeup"
+ * latency histogram, which is the timing noise the host adds to every
+ * timestamp; a chunk is stamped at most one period plus that late.
+ *
+ * The thread can run SCHED_FIFO and pinned to one core so other work
+ * can't deschedule it, and lockAllMemory() keeps page faults out of it.
+ * These need Linux and, for SCHED_FIFO and large mlocks, CAP_SYS_NICE /
+ * CAP_IPC_LOCK or matching rtprio and memlock limits.
+ *
+ *     SerialIngest ingest;
+ *     ingest.start(fd, 1000000, IngestRealtime{80, 2});
+ *     IngestChunk chunk;
+ *     while (ingest.pop(chunk)) {handleChunk(chunk.data, chunk.bytes, chunk.read_ns);}
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <thread>
+
+#include "../util/spsc_ring.hpp"
+
+struct IngestChunk {
+    uint64_t read_ns = 0;   // when read() returned it
+    uint32_t bytes = 0;
+    char data[256];
+};
+
+struct IngestRealtime {
+    int fifo_priority = 0;  // SCHED_FIFO priority 1-99, 0 leaves the normal scheduler
+    int cpu = -1;           // core to pin the thread to, -1 for any
+};
+
+/**
+ * @brief Locks every current and future page of the process in RAM,
+ * prints why and returns false if it can't
+ */
+bool lockAllMemory();
+
+class SerialIngest {
+public:
+    /**
+     * @param queue_chunks Chunks the main loop may fall behind by before
+     * new ones are dropped
+     */
+    explicit SerialIngest(size_t queue_chunks = 1024);
+    ~SerialIngest();
+
+    SerialIngest(const SerialIngest&) = delete;
+    SerialIngest& operator=(const SerialIngest&) = delete;
+
+    /**
+     * @brief Starts reading a non-blocking fd, false (with the reason
+     * printed, and no thread left running) if the real-time settings
+     * couldn't be applied
+     *
+     * @param fd Port opened O_NDELAY, stays owned by the caller
+     * @param period_ns Time between reads
+     * @param realtime Scheduling for the thread
+     */
+    bool start(int fd, uint64_t period_ns, const IngestRealtime& realtime);
+
+    /**
+     * @brief Stops and joins the thread, chunks already queued can still
+     * be popped
+     */
+    void stop();
+
+    /**
+     * @brief Main loop side, false when nothing is waiting
+     */
+    bool pop(IngestChunk& chunk) { return queue.pop(chunk); }
+
+    uint64_t periodNs() const { return period_ns; }
+    uint64_t droppedChunks() const { return dropped_chunks.load(std::memory_order_relaxed); }
+    uint64_t readErrors() const { return read_errors.load(std::memory_order_relaxed); }
+    // Wakeups more than a whole period late, their missed reads are skipped
+    uint64_t lateWakeups() const { return late_wakeups.load(std::memory_order_relaxed); }
+
+private:
+    void run(int fd);
+
+    SpscRing<IngestChunk> queue;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    uint64_t period_ns = 0;
+    std::atomic<uint64_t> dropped_chunks{0};
+    std::atomic<uint64_t> read_errors{0};
+    std::atomic<uint64_t> late_wakeups{0};
+};
+
+/**
+ * @brief Prints the wakeup latency percentiles and the late, dropped
+ * counts of an ingest thread
+ */
+void printIngestJitter(std::ostream& out, const SerialIngest& ingest);
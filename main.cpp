@@ -8,174 +8,769 @@
  * @version 0.5.0
  */
 #include <opencv2/opencv.hpp>
+#include <csignal>
 #include <termios.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <deque>
+#include <algorithm>
+#include <cmath>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "ingest/arduino_emulator.hpp"
+#include "ingest/sample_parser.hpp"
+#include "ingest/serial_ingest.hpp"
+#include "mapping/compressed_grid.hpp"
+#include "mapping/coverage_map.hpp"
+#include "mapping/localizer.hpp"
+#include "mapping/occupancy_grid.hpp"
+#include "render/radar.hpp"
+#include "session/compact_log.hpp"
+#include "session/flight_recorder.hpp"
+#include "session/replay_clock.hpp"
+#include "session/session_reader.hpp"
+#include "session/snapshot.hpp"
+#include "session/session_recorder.hpp"
+#include "util/alloc_profile.hpp"
+#include "util/latency_histogram.hpp"
+#include "util/metrics.hpp"
+#include "util/soak_monitor.hpp"
+#include "util/thread_pool.hpp"
+#include "util/trace.hpp"
+
+volatile std::sig_atomic_t keep_running = 1;
+volatile std::sig_atomic_t dump_latencies = 0;
+volatile std::sig_atomic_t dump_trace = 0;
+
+// Mapping constants, the scanner sits in the middle of the grid
+const float max_range_cm = 50;
+const int map_cells = 400;
+const float map_resolution_cm = 1.0f;
 
-// Global Constants section
-const int width = 240;  // Go out five rings to measure 50 cm and 10 extra as padding
-const int height = 140;  // Go out radius of largest ring (50) and 20 more for top/bottom padding/text
-const cv::Size size(width, height);
-const int scale = 3;
-const cv::Point circle_center(width/2, height - 20);
-
-const cv::Scalar green(0, 180, 0);
-const cv::Scalar background(30, 30, 30);
-
-const int fontFace = cv::FONT_HERSHEY_PLAIN;
-const double fontScale = 0.5;
-const cv::Point angle_display(5, height-5);
-const cv::Point distance_display(width/2-20, height-5);
+/**
+ * @brief Command line settings, defaults match the original setup
+ */
+struct Options {
+    const char* port_name = "/dev/tty.usbmodem101";  // from arduino port?
+    bool localize = false;
+    size_t particles = 10000;
+    bool coverage = false;
+    uint16_t coverage_min_observations = 3;
+    std::string load_map;
+    std::string save_map;
+    double save_map_every_s = 30;
+    std::string record_path;
+    std::string compact_path;
+    bool compact_live = false;
+    int compact_block_ms = 0;   // 0 until parsed, then 5 with --compact-live or 500
+    std::string flight_path;
+    size_t flight_entries = size_t(1) << 18;
+    std::string snapshot_path;
+    double snapshot_every_s = 30;
+    FsyncPolicy fsync_policy;
+    std::string replay_path;
+    ReplaySpeed replay_speed;
+    double replay_from_s = 0;
+    bool headless = false;
+    bool latency = false;
+    std::string trace_path;
+    size_t trace_events = size_t(1) << 18;
+    std::string metrics_address;
+    bool perf_counters = false;
+    double soak_minutes = 0;
+    double soak_every_s = 60;
+    std::string soak_log;
+    double soak_memory_pct = 10;
+    double soak_latency_pct = 25;
+    bool ingest_thread = false;
+    uint64_t ingest_period_us = 1000;
+    IngestRealtime realtime;
+    bool lock_memory = false;
+};
 
-std::deque<std::pair<int, int>> line_deque;
-cv::Mat larger_frame = cv::Mat::zeros(size*scale, CV_8UC3);
+/**
+ * @brief Prints the command line flags main understands
+ *
+ * @param program argv[0]
+ */
+void printUsage(const char* program){
+    std::cerr << "Usage: " << program << " [--port PATH] [--localize [PARTICLES]] [--coverage [MIN_OBSERVATIONS]]"
+              << " [--load-map PATH] [--save-map PATH [--save-map-every SECONDS]] [--record PATH] [--compact PATH [--compact-live] [--compact-block-ms MS]]"
+              << " [--fsync never|always|MS]"
+              << " [--flight PATH [--flight-entries N]] [--snapshot PATH [--snapshot-every SECONDS]]"
+              << " [--replay PATH] [--speed real|N|max] [--from SECONDS] [--headless] [--latency]"
+              << " [--trace PATH [--trace-events N]] [--metrics PORT|SOCKET]"
+              << " [--perf-counters] [--soak MINUTES [--soak-every SECONDS] [--soak-log PATH]"
+              << " [--soak-memory-pct PCT] [--soak-latency-pct PCT]]"
+              << " [--ingest-thread [PERIOD_US]] [--rt-priority N] [--rt-cpu N] [--mlock]" << std::endl;
+}
 
 /**
- * @brief Draws lines and text at an angle
- * 
- * @details This function takes a frame and a length to draw from a starting
- * point at an angle, and then does so to the specified frame.
- * 
- * @param frame The cv::Mat to draw on
- * @param start The starting cv::Point the line will begin at
- * @param angle The degrees from 0-180 to have the line point
- * @param length The length of the line once drawn
- * @param color The color of the line
- * @param with_text To put the angle the line is at past the line when drawn
+ * @brief Reads a whole option value as a number
+ *
+ * @details Same std::from_chars reading as SampleParser, but the number
+ * has to be all of the text ("10x" or "abc" is refused, not read as 10
+ * or thrown about), and a floating value has to be finite.
+ *
+ * @param option The option, for the message
+ * @param text The value given for it
+ * @param value Set to the number read
  */
-void drawLineAtAngle(cv::Mat& frame, cv::Point start, int angle, int length, cv::Scalar color, const bool with_text) {
-    const double angle_radians = (angle * (M_PI / 180));
+template <typename T>
+bool parseNumber(const std::string& option, const char* text, T& value){
+    const char* end = text + std::strlen(text);
+    const auto [last, error] = std::from_chars(text, end, value);
+    bool valid = error == std::errc() && last == end;
+    if constexpr (std::is_floating_point_v<T>){valid = valid && std::isfinite(value);}
+    if (!valid){std::cerr << "Invalid number for " << option << ": " << text << std::endl;}
+    return valid;
+}
 
-    // Section for line
-    int end_x = start.x + cos(angle_radians) * length;
-    int end_y = start.y - sin(angle_radians) * length;
-    cv::line(frame, start, cv::Point(end_x, end_y), color);
+/**
+ * @brief Reads the command line into an Options
+ *
+ * @details Returns false on anything it doesn't recognize so main can
+ * print the usage and stop before touching the serial port.
+ *
+ * @param argc Argument count from main
+ * @param argv Arguments from main
+ * @param options Filled in with the parsed settings
+ */
+bool parseOptions(int argc, char** argv, Options& options){
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) {
+            options.port_name = argv[++i];
+        } else if (arg == "--localize") {
+            options.localize = true;
+            if (i + 1 < argc && argv[i+1][0] != '-') {
+                if (!parseNumber(arg, argv[++i], options.particles) || options.particles == 0) {return false;}
+            }
+        } else if (arg == "--coverage") {
+            options.coverage = true;
+            if (i + 1 < argc && argv[i+1][0] != '-') {
+                if (!parseNumber(arg, argv[++i], options.coverage_min_observations)) {return false;}
+            }
+        } else if (arg == "--load-map" && i + 1 < argc) {
+            options.load_map = argv[++i];
+        } else if (arg == "--save-map" && i + 1 < argc) {
+            options.save_map = argv[++i];
+        } else if (arg == "--save-map-every" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.save_map_every_s)) {return false;}
+        } else if (arg == "--record" && i + 1 < argc) {
+            options.record_path = argv[++i];
+        } else if (arg == "--compact" && i + 1 < argc) {
+            options.compact_path = argv[++i];
+        } else if (arg == "--compact-live") {
+            options.compact_live = true;
+        } else if (arg == "--compact-block-ms" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.compact_block_ms)) {return false;}
+            options.compact_block_ms = std::max(1, options.compact_block_ms);
+        } else if (arg == "--flight" && i + 1 < argc) {
+            options.flight_path = argv[++i];
+        } else if (arg == "--flight-entries" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.flight_entries)) {return false;}
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            options.snapshot_path = argv[++i];
+        } else if (arg == "--snapshot-every" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.snapshot_every_s)) {return false;}
+        } else if (arg == "--fsync" && i + 1 < argc) {
+            if (!parseFsyncPolicy(argv[++i], options.fsync_policy)) {return false;}
+        } else if (arg == "--replay" && i + 1 < argc) {
+            options.replay_path = argv[++i];
+        } else if (arg == "--speed" && i + 1 < argc) {
+            if (!parseReplaySpeed(argv[++i], options.replay_speed)) {return false;}
+        } else if (arg == "--from" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.replay_from_s)) {return false;}
+        } else if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--latency") {
+            options.latency = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            options.trace_path = argv[++i];
+        } else if (arg == "--trace-events" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.trace_events)) {return false;}
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            options.metrics_address = argv[++i];
+        } else if (arg == "--perf-counters") {
+            options.perf_counters = true;
+        } else if (arg == "--soak" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.soak_minutes)) {return false;}
+        } else if (arg == "--soak-every" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.soak_every_s)) {return false;}
+        } else if (arg == "--soak-log" && i + 1 < argc) {
+            options.soak_log = argv[++i];
+        } else if (arg == "--soak-memory-pct" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.soak_memory_pct)) {return false;}
+        } else if (arg == "--soak-latency-pct" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.soak_latency_pct)) {return false;}
+        } else if (arg == "--ingest-thread") {
+            options.ingest_thread = true;
+            if (i + 1 < argc && argv[i+1][0] != '-') {
+                if (!parseNumber(arg, argv[++i], options.ingest_period_us)) {return false;}
+                options.ingest_period_us = std::max<uint64_t>(1, options.ingest_period_us);
+            }
+        } else if (arg == "--rt-priority" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.realtime.fifo_priority)) {return false;}
+            options.realtime.fifo_priority = std::clamp(options.realtime.fifo_priority, 1, 99);
+            options.ingest_thread = true;
+        } else if (arg == "--rt-cpu" && i + 1 < argc) {
+            if (!parseNumber(arg, argv[++i], options.realtime.cpu)) {return false;}
+            options.ingest_thread = true;
+        } else if (arg == "--mlock") {
+            options.lock_memory = true;
+        } else {
+            return false;
+        }
+    }
+    // A block is what a live reader waits for, but every block costs a
+    // 32 byte header, so short ones only when something is following
+    if (options.compact_block_ms == 0){options.compact_block_ms = options.compact_live ? 5 : 500;}
+    return true;
+}
 
-    // Section for text
-    end_x = start.x + cos(angle_radians) * (length+3);
-    end_y = start.y - sin(angle_radians) * (length+3);
-    if (angle >= 90) {end_x -= 8;}
-    if (with_text){
-        cv::putText(frame, std::to_string(angle), cv::Point(end_x, end_y), fontFace, fontScale, green);
+/**
+ * @brief Start times for the logs this run writes, false if the log
+ * being replayed can't be opened
+ *
+ * @details A replay writes the replayed log's timestamps, so a log
+ * recorded from it takes that log's start times too, or its header would
+ * disagree with every record in it.
+ */
+bool recordingStart(const Options& options, SessionStart& start){
+    start = sessionStartNow();
+    if (options.replay_path.empty()){return true;}
+    SessionFileHeader header;
+    if (isCompactLog(options.replay_path)){
+        CompactLogReader reader;
+        if (!reader.open(options.replay_path)){return false;}
+        header = reader.header();
+    } else {
+        SessionReader reader;
+        if (!reader.open(options.replay_path)){return false;}
+        header = reader.header();
     }
+    start = SessionStart{header.start_steady_ns, header.start_unix_ns};
+    return true;
 }
 
 /**
- * @brief Calculates the point for a screen blip off detected distance
- * 
- * @details This function acts similarly to the above line drawing
- * function, except it doesn't draw on the frame, it just returns the
- * calculated point of where the circle should be.
- * 
- * @param angle The degrees from 0-180 the object was detected
- * @param length The distance at which something was detected
+ * @brief Lets Ctrl-C end the read loop so everything gets closed properly
  */
-cv::Point calculate_circle_point(const int angle, const int length){
-    const double angle_radians = (angle * (M_PI / 180));
-    const int end_x = circle_center.x + cos(angle_radians) * length;
-    const int end_y = circle_center.y - sin(angle_radians) * length;
-    return cv::Point(end_x, end_y);
+void stopRunning(int){
+    keep_running = 0;
 }
 
 /**
- * @brief Sets up the initial radar used throughout the code
- * 
- * @details Specifically, drawRadar takes a given frame and creates a
- * pre-built template for how the radar will look, this radar then
- * updated throughout the arduino data collection process.
- * 
- * @param frame The cv::Mat to draw on
+ * @brief Asks for a latency report, printed from the read loop (kill -USR1)
  */
-void drawRadar(cv::Mat& frame){
-    // Base frames
-    frame = cv::Mat::zeros(size, CV_8UC3);
-    frame.setTo(background);
-
-    // Circles
-    cv::circle(frame, circle_center, 3, green, -1);
-    for (int radius = 1; radius < 6; radius++){
-        cv::circle(frame, circle_center, radius*20, green);
-    }
-    
-    // Angle lines
-    for (int angle = 1; angle < 6; angle++) {
-        drawLineAtAngle(frame, circle_center, angle*30, 104, green, true);
-    }
-    
-    // Bottom info section
-    cv::line(frame, cv::Point(0, height-21), cv::Point(width, height-21), green);
-    cv::rectangle(frame, cv::Point(0, height-20), cv::Point(width, height), cv::Scalar(15, 15, 15), -1);
-    cv::putText(frame, "Degree: ", angle_display, fontFace, 0.8, green);
-    cv::putText(frame, "Distance: ", distance_display, fontFace, 0.8, green);
-
-    // Text for circles (ranges)
-    for (int radius = 1; radius < 6; radius++){
-        cv::putText(frame, std::to_string(radius*10), cv::Point(width/2+radius*20-5, height-17), fontFace, 0.5, green);
-    }
-
-    // upscale radar
-    cv::resize(frame, larger_frame, larger_frame.size(), 0, 0, cv::INTER_CUBIC);
-    cv::imshow("Radar", larger_frame);
-    cv::waitKey(1);
+void requestLatencyDump(int){
+    dump_latencies = 1;
 }
 
 /**
- * @brief Updates frame with new line and removes old ones.
- * 
- * @details This function draws on a frame the new line based off the
- * degree, and uses the distance to add in a red line for a detected
- * object.  After an amount of lines, the old ones are faded out. A
- * copy of the frame is used so as to simplify the drawing process and
- * start with a blank slate each time.
- * 
- * @param frame The cv::Mat to draw on, not a reference
- * @param degree The angle to draw a line at
- * @param distanceCM The distance at which something was detected
+ * @brief Asks for the trace so far to be written out (kill -USR2)
  */
-void updateRadar(cv::Mat& frame, const int degree, const int distanceCM){
-    drawRadar(frame);
-    line_deque.push_front(std::make_pair(degree, distanceCM));
-
-    if (line_deque.size() > 40){line_deque.pop_back();}
-    
-    // Draw lines and red blips (fade as get farther back)
-    int color_change = 0;
-    for (auto line : line_deque){
-        // line.first: angle | line.second: range detected
-        color_change += 5;
-        drawLineAtAngle(frame, circle_center, line.first, 100, cv::Scalar(0, 200-color_change, 0), false);
-        if (line.second < 50 and line.second > 2){
-            cv::circle(frame, calculate_circle_point(line.first, line.second*2), 3, cv::Scalar(0, 8, 255-color_change*1.4), -1);
-        }
-    }
-
-    // Add data to bottom square area
-    cv::putText(frame, std::to_string(degree), cv::Point(angle_display.x+55, angle_display.y), fontFace, 0.8, green);
-    if (distanceCM < 50){
-        cv::putText(frame, std::to_string(distanceCM)+" cm", cv::Point(distance_display.x+65, distance_display.y), fontFace, 0.8, green);
-    } else{
-        cv::putText(frame, "Nothing", cv::Point(distance_display.x+65, distance_display.y), fontFace, 0.8, green);
-    }
-
-    // Show new radar
-    cv::resize(frame, larger_frame, larger_frame.size(), 0, 0, cv::INTER_CUBIC);
-    cv::imshow("Radar", larger_frame);
-    cv::waitKey(1);
+void requestTraceDump(int){
+    dump_trace = 1;
 }
 
-int main(){
+int main(int argc, char** argv){
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    // Before any thread starts, they all check the flag without a lock
+    if (!options.trace_path.empty()){
+        enableTracing(options.trace_events);
+        setTraceThreadName("main");
+    }
+    // Soaks judge latency drift, so they need the histograms
+    if (options.soak_minutes > 0){options.latency = true;}
+    // Counters belong to the thread that opens them, the stages run here
+    if (options.perf_counters && !enablePerfCounters()){return 1;}
+    // Before the maps and threads, MCL_FUTURE covers those anyway
+    if (options.lock_memory && !lockAllMemory()){return 1;}
+
     // Map for data later used to build raycasting area
     std::map<int, int> arduino_measurements;
+    OccupancyGrid occupancy_grid(map_cells, map_cells, map_resolution_cm,
+                                 Vec2{-map_cells*map_resolution_cm/2, -map_cells*map_resolution_cm/2});
+    Pose2 scanner_pose;
+    if (!options.load_map.empty()){
+        CompressedGrid stored_map;
+        if (!stored_map.load(options.load_map)){return 1;}
+        occupancy_grid = stored_map.decompress();
+    }
+    CoverageMap coverage(occupancy_grid);
+    uint64_t session_start_ns = monotonicNanoseconds();
+    uint64_t sweep_count = 0;
+
+    // Pick up where the last run left off, if it left a snapshot
+    RuntimeState runtime_state{occupancy_grid, coverage, line_deque, arduino_measurements, scanner_pose, sweep_count};
+    bool restored = false;
+    if (!options.snapshot_path.empty() && access(options.snapshot_path.c_str(), F_OK) == 0){
+        const uint64_t restore_start_ns = monotonicNanoseconds();
+        restored = restoreSnapshot(options.snapshot_path, runtime_state);
+        if (restored){
+            std::cout << "Restored snapshot in " << (monotonicNanoseconds() - restore_start_ns) / 1e6
+                      << " ms (" << sweep_count << " sweeps)" << std::endl;
+        }
+    }
+    std::unique_ptr<SnapshotWriter> snapshots;
+    if (!options.snapshot_path.empty()){snapshots = std::make_unique<SnapshotWriter>(options.snapshot_path);}
+    uint64_t last_snapshot_ns = monotonicNanoseconds();
+    auto saveFinalSnapshot = [&](){
+        if (!snapshots){return;}
+        snapshots->wait();
+        const bool saved = writeSnapshotFile(options.snapshot_path.c_str(), runtime_state);
+        if (!saved){std::cerr << "Error writing snapshot: " << options.snapshot_path << std::endl;}
+        std::cout << "Snapshots: " << snapshots->stats().written + saved << " written, worst fork pause "
+                  << snapshots->stats().worst_fork_us << " us" << std::endl;
+    };
+
+    // Particle filter, the loaded map or else the map as of the first
+    // full sweep is the known map
+    ThreadPool pool;
+    LocalizerConfig localizer_config;
+    localizer_config.particles = options.particles;
+    MonteCarloLocalizer localizer(localizer_config, pool);
+    LikelihoodField likelihood_field;
+    SweepAssembler sweeps;
+    if (options.localize && (!options.load_map.empty() || restored)){
+        likelihood_field.build(occupancy_grid, LikelihoodModel(), &pool);
+        localizer.initialize(scanner_pose, 2.0f, 0.05f);
+    }
 
     // opencv for displaying radar frame
     cv::Mat radar;
     drawRadar(radar);
+    if (!options.headless){showRadar(radar);}
+
+    // Session log, every raw chunk and parsed sample with its timestamp
+    SessionStart recording_start;
+    if (!recordingStart(options, recording_start)){return 1;}
+    SessionRecorder recorder;
+    if (!options.record_path.empty() && !recorder.open(options.record_path, options.fsync_policy, recording_start)){
+        return 1;
+    }
+    CompactLogWriter compact_log(4096, std::chrono::milliseconds(options.compact_block_ms));
+    if (!options.compact_path.empty()
+        && !compact_log.open(options.compact_path, options.fsync_policy, recording_start)){
+        return 1;
+    }
+
+    // Last few minutes of samples and events, still readable after a crash
+    FlightRecorder flight;
+    if (!options.flight_path.empty()){
+        if (!flight.open(options.flight_path, options.flight_entries)){return 1;}
+        installFlightCrashHandlers(flight);
+        flight.recordEvent(monotonicNanoseconds(), FlightEvent::Start);
+    }
+
+    // Prometheus metrics, the loop only bumps atomics and the server thread
+    // reads them when scraped
+    MetricsRegistry metrics;
+    MetricCounter& samples_metric = metrics.counter("radar_samples_total", "Samples handled");
+    MetricCounter& bytes_metric = metrics.counter("radar_read_bytes_total", "Bytes read from the port or from replayed raw chunks");
+    MetricCounter& parse_errors_metric = metrics.counter("radar_parse_errors_total", "Messages the parser rejected");
+    MetricCounter& read_errors_metric = metrics.counter("radar_read_errors_total", "Failed serial port reads");
+    MetricCounter& ingest_dropped_metric = metrics.counter("radar_ingest_dropped_chunks_total", "Chunks the ingest thread dropped because the queue was full");
+    MetricCounter& ingest_late_metric = metrics.counter("radar_ingest_late_wakeups_total", "Ingest thread wakeups more than a period late");
+    MetricCounter& frame_ns_metric = metrics.counter("radar_frame_nanoseconds_total", "Time spent handling samples");
+    MetricGauge& last_frame_metric = metrics.gauge("radar_last_frame_seconds", "Time the latest sample took");
+    MetricCounter& sweeps_metric = metrics.counter("radar_sweeps_total", "Finished sweeps");
+    MetricGauge& map_cells_metric = metrics.gauge("radar_map_cells", "Cells in the occupancy grid");
+    MetricGauge& map_known_metric = metrics.gauge("radar_map_known_cells", "Grid cells seen at least once, as of the last sweep");
+    MetricCounter& localizer_updates_metric = metrics.counter("radar_localizer_updates_total", "Particle filter updates");
+    MetricGauge& particles_metric = metrics.gauge("radar_localizer_particles", "Particles being tracked");
+    MetricGauge& localizer_ms_metric = metrics.gauge("radar_localizer_last_update_seconds", "Time the latest update took");
+    MetricGauge& pose_x_metric = metrics.gauge("radar_pose_x_cm", "Estimated scanner x");
+    MetricGauge& pose_y_metric = metrics.gauge("radar_pose_y_cm", "Estimated scanner y");
+    MetricGauge& pose_theta_metric = metrics.gauge("radar_pose_theta_radians", "Estimated scanner heading");
+    map_cells_metric.set(double(occupancy_grid.width()) * occupancy_grid.height());
+    particles_metric.set(double(localizer.size()));
+    // Rate over the time since the previous scrape
+    metrics.collector([&samples_metric, last_samples = uint64_t(0), last_ns = monotonicNanoseconds()](std::string& out) mutable {
+        const uint64_t now_ns = monotonicNanoseconds();
+        const uint64_t samples = samples_metric.get();
+        appendMetricHeader(out, "radar_samples_per_second", "Sample rate since the previous scrape", "gauge");
+        appendMetric(out, "radar_samples_per_second", "", now_ns > last_ns ? (samples - last_samples) * 1e9 / (now_ns - last_ns) : 0);
+        last_samples = samples;
+        last_ns = now_ns;
+    });
+    // Writer backlogs, the queue between the loop and the disk
+    metrics.collector([&recorder, &compact_log](std::string& out){
+        const std::pair<const char*, WriterStats> writers[] = {
+            {"writer=\"session\"", recorder.stats()}, {"writer=\"compact\"", compact_log.stats()}};
+        appendMetricHeader(out, "radar_writer_pending_bytes", "Bytes queued for the log writer thread", "gauge");
+        for (const auto& [labels, stats] : writers){appendMetric(out, "radar_writer_pending_bytes", labels, double(stats.pending_bytes));}
+        appendMetricHeader(out, "radar_writer_written_bytes_total", "Bytes written to the log", "counter");
+        for (const auto& [labels, stats] : writers){appendMetric(out, "radar_writer_written_bytes_total", labels, double(stats.bytes_written));}
+        appendMetricHeader(out, "radar_writer_dropped_bytes_total", "Bytes refused because the backlog was full", "counter");
+        for (const auto& [labels, stats] : writers){appendMetric(out, "radar_writer_dropped_bytes_total", labels, double(stats.bytes_dropped));}
+    });
+    if (options.latency){
+        metrics.collector([](std::string& out){
+            const StageLatencies latencies = mergeStageLatencies();
+            appendMetricHeader(out, "radar_stage_latency_seconds", "Per-stage latency", "summary");
+            for (size_t stage = 0; stage < pipeline_stage_count; stage++){
+                const LatencySummary& summary = latencies[stage];
+                const std::string name = std::string("stage=\"") + pipelineStageName(PipelineStage(stage)) + "\"";
+                const std::pair<double, const char*> quantiles[] = {{0.5, "0.5"}, {0.99, "0.99"}, {0.999, "0.999"}};
+                for (const auto& [q, label] : quantiles){
+                    appendMetric(out, "radar_stage_latency_seconds", name + ",quantile=\"" + label + "\"",
+                                 summary.count ? summary.percentile(q) / 1e9 : NAN);
+                }
+                appendMetric(out, "radar_stage_latency_seconds_sum", name, summary.sum_ns / 1e9);
+                appendMetric(out, "radar_stage_latency_seconds_count", name, double(summary.count));
+            }
+        });
+    }
+    MetricsServer metrics_server;
+    if (!options.metrics_address.empty() && !metrics_server.start(options.metrics_address, metrics)){
+        return 1;
+    }
+
+    // Compressing and writing the map holds up the samples, so it's only
+    // done every --save-map-every seconds and once more on the way out
+    uint64_t last_map_save_ns = monotonicNanoseconds();
+    auto saveMap = [&](uint64_t timestamp_ns){
+        if (options.save_map.empty()){return;}
+        TRACE_SCOPE("save map");
+        last_map_save_ns = monotonicNanoseconds();
+        if (CompressedGrid::compress(occupancy_grid).save(options.save_map) && flight.isOpen()){
+            flight.recordEvent(timestamp_ns, FlightEvent::MapSaved);
+        }
+    };
+
+    // When the bytes behind the current sample came in, for sample-to-photon
+    // (or sample-to-frame headless)
+    uint64_t sample_arrived_ns = 0;
+
+    // Everything done with one sample, from drawing to mapping, timed by
+    // when its chunk was read so a replay maps exactly like the original
+    auto handleSample = [&](const ParsedSample& sample, uint64_t timestamp_ns){
+        StageTimer frame_timer(PipelineStage::Frame);
+        const uint64_t frame_start_ns = monotonicNanoseconds();
+        samples_metric.add();
+        const int degree = sample.degree;
+        const int distanceCM = sample.distance_cm;
+        if (flight.isOpen()){flight.recordSample(timestamp_ns, sample);}
+
+        // Update radar screen and deque
+        {
+            StageTimer render_timer(PipelineStage::Render);
+            updateRadarCached(radar, degree, distanceCM, options.coverage ? &coverage : nullptr);
+        }
+        if (!options.headless){
+            StageTimer present_timer(PipelineStage::Present);
+            showRadar(radar);
+        }
+        // Headless, nothing reaches the screen, so it's only as far as the
+        // drawn frame
+        if (options.latency){
+            recordStageLatency(options.headless ? PipelineStage::SampleToFrame : PipelineStage::SampleToPhoton,
+                               monotonicNanoseconds() - sample_arrived_ns);
+        }
+
+        // store in measurements if small enough
+        {
+            StageTimer map_timer(PipelineStage::MapUpdate);
+            TRACE_SCOPE("map update");
+            if (distanceCM < 50 && distanceCM > 1 && arduino_measurements.count(degree) == 0){
+                arduino_measurements[degree] = distanceCM;
+            }
+            if (distanceCM > 1){
+                TRACE_SCOPE("raycast");
+                const uint32_t now_ms = uint32_t((timestamp_ns - session_start_ns) / 1000000);
+                occupancy_grid.integrateRay(scanner_pose, degree, distanceCM, max_range_cm,
+                                            options.coverage ? &coverage : nullptr, now_ms);
+            }
+        }
+
+        const bool sweep_done = sweeps.push(RangeSample{float(degree), float(distanceCM)});
+        if (sweep_done){
+            sweep_count++;
+            sweeps_metric.set(sweep_count);
+            if (!options.metrics_address.empty()){
+                const int8_t* cells = occupancy_grid.data();
+                const size_t count = size_t(occupancy_grid.width()) * occupancy_grid.height();
+                map_known_metric.set(double(count - std::count(cells, cells + count, OccupancyGrid::unknown)));
+            }
+        }
+        if (sweep_done && recorder.isOpen()){recorder.markSweep();}
+        if (sweep_done && flight.isOpen()){flight.recordEvent(timestamp_ns, FlightEvent::Sweep, int32_t(sweep_count));}
+        if (sweep_done && !options.save_map.empty() &&
+            monotonicNanoseconds() - last_map_save_ns >= uint64_t(options.save_map_every_s * 1e9)){
+            saveMap(timestamp_ns);
+        }
+        if (sweep_done && snapshots){
+            // Forked, so only the fork itself holds up the samples
+            TRACE_SCOPE("snapshot");
+            snapshots->poll();
+            const uint64_t now_ns = monotonicNanoseconds();
+            if (now_ns - last_snapshot_ns >= uint64_t(options.snapshot_every_s * 1e9) && snapshots->start(runtime_state)){
+                last_snapshot_ns = now_ns;
+            }
+        }
+        if (sweep_done && options.coverage){
+            // Half disc in front of the scanner the sensor can actually reach
+            const double covered = coverage.coveredFraction(options.coverage_min_observations,
+                Vec2{scanner_pose.x - max_range_cm, scanner_pose.y},
+                Vec2{scanner_pose.x + max_range_cm, scanner_pose.y + max_range_cm},
+                Vec2{scanner_pose.x, scanner_pose.y}, max_range_cm);
+            std::cout << "Coverage: " << covered*100 << "% seen at least "
+                      << options.coverage_min_observations << " times" << std::endl;
+        }
+
+        // Track the scanner once per finished sweep
+        if (sweep_done && options.localize){
+            if (likelihood_field.empty()){
+                likelihood_field.build(occupancy_grid, LikelihoodModel(), &pool);
+                localizer.initialize(scanner_pose, 2.0f, 0.05f);
+            } else {
+                TRACE_SCOPE("localize");
+                localizer.predict();
+                localizer.update(sweeps.completed(), likelihood_field, max_range_cm);
+                scanner_pose = localizer.estimate();
+                const LocalizerTiming& timing = localizer.timing();
+                localizer_updates_metric.set(timing.updates);
+                localizer_ms_metric.set(timing.total_ms / 1e3);
+                pose_x_metric.set(scanner_pose.x);
+                pose_y_metric.set(scanner_pose.y);
+                pose_theta_metric.set(scanner_pose.theta);
+                std::cout << "Pose: " << scanner_pose.x << ", " << scanner_pose.y << " cm, "
+                          << scanner_pose.theta*180/M_PI << " deg | " << timing.total_ms
+                          << " ms (avg " << (timing.updates > 0 ? timing.total_ms_sum/timing.updates : 0.0)
+                          << ", worst " << timing.worst_total_ms << ")" << std::endl;
+            }
+        }
+
+        const uint64_t frame_ns = monotonicNanoseconds() - frame_start_ns;
+        frame_ns_metric.add(frame_ns);
+        last_frame_metric.set(frame_ns / 1e9);
+    };
+
+    std::signal(SIGINT, stopRunning);
+    std::signal(SIGTERM, stopRunning);
+
+    // Per-stage latency, reported on SIGUSR1 and at exit
+    setStageLatencyEnabled(options.latency);
+    std::signal(SIGUSR1, requestLatencyDump);
+
+    // Timeline trace, written on SIGUSR2 and at exit
+    std::signal(SIGUSR2, requestTraceDump);
+    auto saveTrace = [&](){
+        if (options.trace_path.empty()){return;}
+        if (writeChromeTrace(options.trace_path)){
+            std::cout << "Trace written to " << options.trace_path;
+            if (droppedTraceEvents() > 0){
+                std::cout << " (" << droppedTraceEvents() << " spans dropped, raise --trace-events)";
+            }
+            std::cout << std::endl;
+        }
+    };
+    // Soak runs keep feeding input for a fixed time, sampling memory,
+    // backlogs and latency to judge their drift at the end
+    std::unique_ptr<SoakMonitor> soak;
+    uint64_t soak_start_ns = 0;
+    uint64_t next_soak_sample_ns = 0;
+    if (options.soak_minutes > 0){
+        soak = std::make_unique<SoakMonitor>(options.soak_memory_pct, options.soak_latency_pct);
+        if (!options.soak_log.empty() && !soak->openLog(options.soak_log)){return 1;}
+        soak_start_ns = monotonicNanoseconds();
+        next_soak_sample_ns = soak_start_ns + uint64_t(options.soak_every_s * 1e9);
+    }
+    auto checkSoak = [&](){
+        const uint64_t now_ns = monotonicNanoseconds();
+        if (now_ns < next_soak_sample_ns){return;}
+        next_soak_sample_ns += uint64_t(options.soak_every_s * 1e9);
+        soak->record(std::cout, samples_metric.get(), recorder.stats().pending_bytes + compact_log.stats().pending_bytes);
+        if (now_ns - soak_start_ns >= uint64_t(options.soak_minutes * 60e9)){keep_running = 0;}
+    };
+    auto checkDumps = [&](){
+        if (soak){checkSoak();}
+        // The last block would otherwise wait for the next sample
+        if (compact_log.isOpen()){compact_log.flushIfDue(monotonicNanoseconds());}
+        if (dump_trace){
+            dump_trace = 0;
+            saveTrace();
+        }
+        if (!dump_latencies){return;}
+        dump_latencies = 0;
+        printStageLatencies(std::cout, mergeStageLatencies());
+        if (perfCountersEnabled()){printStagePerf(std::cout);}
+    };
+
+    // Every chunk, live or replayed, takes the same path through here
+    SampleParser parser;
+    uint64_t last_invalid = 0;
+    auto handleChunk = [&](const char* bytes, size_t count, uint64_t read_ns){
+        if (recorder.isOpen()){recorder.recordRaw(read_ns, bytes, count);}
+        bytes_metric.add(count);
+        // Parsing is timed as the whole feed less the time spent handling
+        // the samples it produced
+        const uint64_t parse_start_ns = options.latency ? monotonicNanoseconds() : 0;
+        const PerfCounts parse_start_counts = readPerfCounts();
+        uint64_t handler_ns = 0;
+        PerfCounts handler_counts;
+        TRACE_SCOPE("parse");
+        AllocStageScope parse_allocs(PipelineStage::Parse);
+        parser.feed(bytes, count, [&](const ParsedSample& sample){
+            const uint64_t handler_start_ns = options.latency ? monotonicNanoseconds() : 0;
+            const PerfCounts handler_start_counts = readPerfCounts();
+            if (recorder.isOpen()){recorder.recordSample(read_ns, sample);}
+            if (compact_log.isOpen()){compact_log.append(read_ns, sample);}
+            handleSample(sample, read_ns);
+            if (options.latency){handler_ns += monotonicNanoseconds() - handler_start_ns;}
+            if (options.perf_counters){handler_counts += readPerfCounts() - handler_start_counts;}
+        });
+        if (options.latency){
+            recordStageLatency(PipelineStage::Parse, monotonicNanoseconds() - parse_start_ns - handler_ns);
+        }
+        if (options.perf_counters){
+            recordStagePerf(PipelineStage::Parse, (readPerfCounts() - parse_start_counts) - handler_counts);
+        }
+        parse_errors_metric.set(parser.invalidMessages());
+        if (flight.isOpen() && parser.invalidMessages() != last_invalid){
+            last_invalid = parser.invalidMessages();
+            flight.recordEvent(read_ns, FlightEvent::InvalidMessage, int32_t(last_invalid));
+        }
+    };
+
+    // Replay a recorded session instead of reading the arduino, over and
+    // over when soaking, which emulates the arduino if there's no log
+    if (!options.replay_path.empty() || soak){
+        uint64_t replayed_samples = 0;
+        bool nothing_replayed = false;
+        const uint64_t replay_start_ns = monotonicNanoseconds();
+        if (flight.isOpen()){flight.recordEvent(replay_start_ns, FlightEvent::ReplayStart);}
+
+        // Each soak pass is moved on past the one before, so what's recorded
+        // during it keeps going forward in time instead of starting over
+        uint64_t pass_shift_ns = 0;
+        do {
+            const uint64_t samples_before_pass = replayed_samples;
+            uint64_t pass_first_ns = UINT64_MAX, pass_last_ns = 0;
+            auto shifted = [&](uint64_t timestamp_ns){
+                pass_first_ns = std::min(pass_first_ns, timestamp_ns);
+                pass_last_ns = std::max(pass_last_ns, timestamp_ns);
+                return timestamp_ns + pass_shift_ns;
+            };
+            ReplayClock clock(options.replay_speed);
+            if (options.replay_path.empty()){
+                ArduinoEmulator arduino;
+                std::string chunk;
+                uint64_t timestamp_ns = monotonicNanoseconds();
+                session_start_ns = timestamp_ns;
+                while (keep_running){
+                    // About what one read of the port brings in
+                    chunk.clear();
+                    for (int i = 0; i < 4; i++){arduino.next(chunk);}
+                    timestamp_ns += 4 * ArduinoEmulator::sample_interval_ns;
+                    clock.waitUntil(timestamp_ns);
+                    sample_arrived_ns = monotonicNanoseconds();
+                    handleChunk(chunk.data(), chunk.size(), timestamp_ns);
+                    checkDumps();
+                }
+                replayed_samples = parser.samples();
+            } else if (isCompactLog(options.replay_path)){
+                // Compact logs only hold samples, they skip the parser
+                CompactLogReader reader;
+                if (!reader.open(options.replay_path)){return 1;}
+                session_start_ns = reader.header().start_steady_ns;
+                const uint64_t from_ns = session_start_ns + uint64_t(options.replay_from_s * 1e9);
+                reader.seek(from_ns);
+
+                std::vector<CompactSample> block;
+                uint16_t sensor;
+                while (keep_running && reader.nextBlock(block, sensor)){
+                    for (const CompactSample& sample : block){
+                        if (!keep_running){break;}
+                        if (sample.timestamp_ns < from_ns){continue;}
+                        const uint64_t timestamp_ns = shifted(sample.timestamp_ns);
+                        clock.waitUntil(timestamp_ns);
+                        sample_arrived_ns = monotonicNanoseconds();
+                        const ParsedSample parsed{sample.degree, sample.distance_cm};
+                        if (recorder.isOpen()){recorder.recordSample(timestamp_ns, parsed, sensor);}
+                        if (compact_log.isOpen()){compact_log.append(timestamp_ns, parsed, sensor);}
+                        handleSample(parsed, timestamp_ns);
+                        replayed_samples++;
+                        checkDumps();
+                    }
+                }
+                if (reader.corruptBlocks() > 0){
+                    std::cerr << "Skipped " << reader.corruptBlocks() << " damaged blocks" << std::endl;
+                }
+            } else {
+                SessionReader reader;
+                if (!reader.open(options.replay_path)){return 1;}
+                session_start_ns = reader.header().start_steady_ns;
+                if (options.replay_from_s > 0){
+                    reader.seek(session_start_ns + uint64_t(options.replay_from_s * 1e9));
+                }
+
+                SessionRecordHeader record;
+                const char* payload;
+                while (keep_running && reader.next(record, payload)){
+                    // Samples are re-parsed from the raw chunks, the logged ones
+                    // are only there for tools that don't want to parse
+                    if (record.type != uint8_t(SessionRecordType::RawChunk)){continue;}
+                    const uint64_t timestamp_ns = shifted(record.timestamp_ns);
+                    clock.waitUntil(timestamp_ns);
+                    sample_arrived_ns = monotonicNanoseconds();
+                    handleChunk(payload, record.payload_bytes, timestamp_ns);
+                    checkDumps();
+                }
+                replayed_samples = parser.samples();
+                std::cout << parser.invalidMessages() << " invalid messages" << std::endl;
+            }
+            // The checks above only run per sample, a log with none would
+            // otherwise be replayed over and over without ever ending the soak
+            checkDumps();
+            if (replayed_samples == samples_before_pass){
+                if (soak){std::cerr << "Nothing to replay in " << options.replay_path << ", stopping the soak" << std::endl;}
+                nothing_replayed = true;
+                break;
+            }
+            // One sample interval after this pass's last record
+            if (pass_last_ns >= pass_first_ns){
+                pass_shift_ns += pass_last_ns - pass_first_ns + ArduinoEmulator::sample_interval_ns;
+            }
+        } while (soak && keep_running);
+
+        const double seconds = (monotonicNanoseconds() - replay_start_ns) / 1e9;
+        std::cout << "Replayed " << replayed_samples << " samples in " << seconds << " s";
+        if (options.replay_speed.unlimited() && seconds > 0){
+            std::cout << ", " << replayed_samples / seconds << " samples/s";
+        }
+        std::cout << std::endl;
+        if (options.latency){printStageLatencies(std::cout, mergeStageLatencies());}
+        if (options.perf_counters){printStagePerf(std::cout);}
+        if (alloc_profile_enabled){printAllocationProfile(std::cout);}
+
+        recorder.close();
+        compact_log.close();
+        saveMap(monotonicNanoseconds());
+        saveFinalSnapshot();
+        saveTrace();
+        if (flight.isOpen()){flight.recordEvent(monotonicNanoseconds(), FlightEvent::Shutdown);}
+        cv::destroyAllWindows();
+        if (soak && nothing_replayed){return 1;}
+        return !soak || soak->judge(std::cout) ? 0 : 2;
+    }
 
     // Set up port reading from arduino program
-    const char* port_name = "/dev/tty.usbmodem101";  // from arduino port?
+    const char* port_name = options.port_name;
     int serial_port = open(port_name, O_RDWR | O_NOCTTY | O_NDELAY);
 
     if (serial_port == -1) {
@@ -204,45 +799,65 @@ int main(){
     // Read in data section, meat of code to update drawings and set up
     // map for later raycast "level"
     char buffer[256];
-    std::string data = "";
 
-    while (true){
+    // Or on the ingest thread, which only reads, with the main loop taking
+    // its chunks off the queue
+    std::unique_ptr<SerialIngest> ingest;
+    if (options.ingest_thread){
+        ingest = std::make_unique<SerialIngest>();
+        if (!ingest->start(serial_port, options.ingest_period_us * 1000, options.realtime)){
+            close(serial_port);
+            return 1;
+        }
+    }
+
+    while (keep_running && ingest){
+        IngestChunk chunk;
+        bool handled = false;
+        while (ingest->pop(chunk)){
+            sample_arrived_ns = chunk.read_ns;
+            handleChunk(chunk.data, chunk.bytes, chunk.read_ns);
+            handled = true;
+        }
+        read_errors_metric.set(ingest->readErrors());
+        ingest_dropped_metric.set(ingest->droppedChunks());
+        ingest_late_metric.set(ingest->lateWakeups());
+        checkDumps();
+        // Nothing came in, wait about a read period for the next chunk
+        if (!handled){std::this_thread::sleep_for(std::chrono::microseconds(options.ingest_period_us));}
+    }
+
+    while (keep_running && !ingest){
         memset(buffer, 0, sizeof(buffer));
+        const uint64_t read_start_ns = monotonicNanoseconds();
         int bytes_read = read(serial_port, buffer, sizeof(buffer) - 1);
 
         if (bytes_read > 0){
-            data.append(buffer, bytes_read);
-            size_t measurement_delimiter_pos;
-
-            // Parse data for breakpoints in send info
-            while ((measurement_delimiter_pos = data.find("|")) != std::string::npos){
-                std::string message = data.substr(0, measurement_delimiter_pos);
-                data.erase(0, measurement_delimiter_pos + 1);
-
-                // Break up info into specific data points and store
-                size_t data_delimiter_pos = message.find(':');
-
-                if (data_delimiter_pos != std::string::npos){
-                    const int degree = std::stoi(message.substr(0, data_delimiter_pos));
-                    // Here, we take "float" string data and convert to
-                    // int to later simplify mapping and drawing
-                    const int distanceCM = std::stoi(message.substr(data_delimiter_pos + 1));
-
-                    // Update radar screen and deque
-                    updateRadar(radar, degree, distanceCM);
-
-                    // store in measurements if small enough
-                    if (distanceCM < 50 && distanceCM > 1 && arduino_measurements.count(degree) == 0){
-                        arduino_measurements[degree] = distanceCM;
-                    }
-                } else {
-                    std::cerr << "Invalid message format (breakpoints?): " << message << std::endl;
-                }
-            }
+            // Only reads that brought something in, the port is polled
+            sample_arrived_ns = monotonicNanoseconds();
+            if (options.latency){recordStageLatency(PipelineStage::Read, sample_arrived_ns - read_start_ns);}
+            traceComplete("read", read_start_ns, sample_arrived_ns);
+            handleChunk(buffer, bytes_read, sample_arrived_ns);
+        } else if (bytes_read < 0 && errno != EAGAIN && errno != EWOULDBLOCK){
+            read_errors_metric.add();
         }
+        checkDumps();
     }
 
     // Cleanup and close
+    if (ingest){
+        ingest->stop();
+        printIngestJitter(std::cout, *ingest);
+    }
+    if (options.latency){printStageLatencies(std::cout, mergeStageLatencies());}
+    if (options.perf_counters){printStagePerf(std::cout);}
+    if (alloc_profile_enabled){printAllocationProfile(std::cout);}
+    recorder.close();
+    compact_log.close();
+    saveMap(monotonicNanoseconds());
+    saveFinalSnapshot();
+    saveTrace();
+    if (flight.isOpen()){flight.recordEvent(monotonicNanoseconds(), FlightEvent::Shutdown);}
     close(serial_port);
     cv::destroyAllWindows();
 
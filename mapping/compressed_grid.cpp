@@ -0,0 +1,377 @@
+/**
+ * @file compressed_grid.cpp
+ * @brief Tile encoders, decoders and the map file format.
+ *
+ * @details File layout, all little-endian:
+ *   "USMG", u32 version, i32 width, i32 height, f32 resolution,
+ *   f32 origin x, f32 origin y, i32 tile size, u32 tile count,
+ *   u64 payload bytes, then per tile (u8 encoding, i8 uniform value,
+ *   u32 offset, u32 size), then the payload.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "compressed_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char file_magic[4] = {'U', 'S', 'M', 'G'};
+const uint32_t file_version = 1;
+const int quad_leaf = 4;   // quadtree stops splitting at 4x4 blocks
+// Largest map side a file may claim, 64 m at 1 mm cells, so tile counts
+// and cell indices stay well inside 32 bits
+const int32_t max_side_cells = 1 << 16;
+// Bytes before the tile directory, and per directory entry
+const uint64_t file_header_bytes = 44;
+const uint64_t tile_entry_bytes = 10;
+
+enum QuadNode : uint8_t {
+    quad_uniform = 0,
+    quad_split = 1,
+    quad_raw = 2,
+};
+
+bool isUniform(const int8_t* tile, int x, int y, int size){
+    const int8_t first = tile[y*CompressedGrid::tile_size + x];
+    for (int row = y; row < y + size; row++) {
+        const int8_t* cells = tile + row*CompressedGrid::tile_size + x;
+        for (int col = 0; col < size; col++) {
+            if (cells[col] != first) {return false;}
+        }
+    }
+    return true;
+}
+
+void encodeRle(const int8_t* tile, std::vector<uint8_t>& out){
+    size_t i = 0;
+    while (i < CompressedGrid::tile_cells) {
+        size_t run = 1;
+        while (run < 256 && i + run < CompressedGrid::tile_cells && tile[i + run] == tile[i]) {run++;}
+        out.push_back(uint8_t(run - 1));
+        out.push_back(uint8_t(tile[i]));
+        i += run;
+    }
+}
+
+/**
+ * @brief False if the pairs don't fill the tile exactly, what's written
+ * by then stays inside it
+ */
+bool decodeRle(const uint8_t* in, size_t size, int8_t* tile){
+    if (size % 2 != 0) {return false;}
+    size_t written = 0;
+    for (size_t i = 0; i < size; i += 2) {
+        const size_t run = size_t(in[i]) + 1;
+        if (run > CompressedGrid::tile_cells - written) {return false;}
+        std::memset(tile + written, in[i + 1], run);
+        written += run;
+    }
+    return written == CompressedGrid::tile_cells;
+}
+
+void encodeQuad(const int8_t* tile, int x, int y, int size, std::vector<uint8_t>& out){
+    if (isUniform(tile, x, y, size)) {
+        out.push_back(quad_uniform);
+        out.push_back(uint8_t(tile[y*CompressedGrid::tile_size + x]));
+        return;
+    }
+    if (size == quad_leaf) {
+        out.push_back(quad_raw);
+        for (int row = y; row < y + size; row++) {
+            const int8_t* cells = tile + row*CompressedGrid::tile_size + x;
+            out.insert(out.end(), cells, cells + size);
+        }
+        return;
+    }
+    out.push_back(quad_split);
+    const int half = size / 2;
+    encodeQuad(tile, x, y, half, out);
+    encodeQuad(tile, x + half, y, half, out);
+    encodeQuad(tile, x, y + half, half, out);
+    encodeQuad(tile, x + half, y + half, half, out);
+}
+
+/**
+ * @brief Decodes one node and its children, nullptr if the stream ends
+ * before end or holds a node the encoder never writes
+ */
+const uint8_t* decodeQuad(const uint8_t* in, const uint8_t* end, int x, int y, int size, int8_t* tile){
+    if (in == end) {return nullptr;}
+    const uint8_t node = *in++;
+    if (node == quad_uniform) {
+        if (in == end) {return nullptr;}
+        const int8_t value = int8_t(*in++);
+        for (int row = y; row < y + size; row++) {
+            std::memset(tile + row*CompressedGrid::tile_size + x, value, size);
+        }
+    } else if (node == quad_raw) {
+        if (size != quad_leaf || end - in < size*size) {return nullptr;}
+        for (int row = y; row < y + size; row++) {
+            std::memcpy(tile + row*CompressedGrid::tile_size + x, in, size);
+            in += size;
+        }
+    } else if (node == quad_split && size > quad_leaf) {
+        const int half = size / 2;
+        if (!(in = decodeQuad(in, end, x, y, half, tile))) {return nullptr;}
+        if (!(in = decodeQuad(in, end, x + half, y, half, tile))) {return nullptr;}
+        if (!(in = decodeQuad(in, end, x, y + half, half, tile))) {return nullptr;}
+        in = decodeQuad(in, end, x + half, y + half, half, tile);
+    } else {
+        return nullptr;
+    }
+    return in;
+}
+
+template <typename T>
+void writeValue(std::ofstream& file, const T& value){
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(std::ifstream& file, T& value){
+    return bool(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+}  // namespace
+
+CompressedGrid CompressedGrid::compress(const OccupancyGrid& grid, TileCompression mode){
+    CompressedGrid result;
+    result.grid_width = grid.width();
+    result.grid_height = grid.height();
+    result.resolution_cm = grid.resolution();
+    result.origin_cm = grid.origin();
+    result.tiles_x = (grid.width() + tile_size - 1) / tile_size;
+    result.tiles_y = (grid.height() + tile_size - 1) / tile_size;
+    result.tiles.reserve(size_t(result.tiles_x) * result.tiles_y);
+
+    std::vector<int8_t> tile(tile_cells);
+    std::vector<uint8_t> rle, quad;
+    for (int ty = 0; ty < result.tiles_y; ty++) {
+        for (int tx = 0; tx < result.tiles_x; tx++) {
+            // Copy the tile out, cells past the grid edge are unknown
+            std::fill(tile.begin(), tile.end(), OccupancyGrid::unknown);
+            const int x0 = tx*tile_size;
+            const int y0 = ty*tile_size;
+            const int columns = std::min(tile_size, grid.width() - x0);
+            for (int row = 0; row < tile_size && y0 + row < grid.height(); row++) {
+                std::memcpy(&tile[size_t(row)*tile_size], grid.data() + size_t(y0 + row)*grid.width() + x0, columns);
+            }
+
+            TileEntry entry{TileEncoding::Raw, 0, uint32_t(result.payload.size()), uint32_t(tile_cells)};
+            if (mode == TileCompression::Best && isUniform(tile.data(), 0, 0, tile_size)) {
+                entry = TileEntry{TileEncoding::Uniform, tile[0], 0, 0};
+                result.tiles.push_back(entry);
+                continue;
+            }
+            if (mode == TileCompression::Best) {
+                rle.clear();
+                quad.clear();
+                encodeRle(tile.data(), rle);
+                encodeQuad(tile.data(), 0, 0, tile_size, quad);
+                const std::vector<uint8_t>& smaller = rle.size() <= quad.size() ? rle : quad;
+                if (smaller.size() < tile_cells) {
+                    entry.encoding = &smaller == &rle ? TileEncoding::Rle : TileEncoding::Quadtree;
+                    entry.size = uint32_t(smaller.size());
+                    result.payload.insert(result.payload.end(), smaller.begin(), smaller.end());
+                    result.tiles.push_back(entry);
+                    continue;
+                }
+            }
+            const uint8_t* raw = reinterpret_cast<const uint8_t*>(tile.data());
+            result.payload.insert(result.payload.end(), raw, raw + tile_cells);
+            result.tiles.push_back(entry);
+        }
+    }
+    return result;
+}
+
+bool CompressedGrid::decodeTile(size_t index, int8_t* out) const {
+    const TileEntry& entry = tiles[index];
+    const uint8_t* in = payload.data() + entry.offset;
+    switch (entry.encoding) {
+        case TileEncoding::Uniform:
+            std::memset(out, entry.uniform_value, tile_cells);
+            return true;
+        case TileEncoding::Rle:
+            return decodeRle(in, entry.size, out);
+        case TileEncoding::Quadtree:
+            return decodeQuad(in, in + entry.size, 0, 0, tile_size, out) == in + entry.size;
+        case TileEncoding::Raw:
+            if (entry.size != tile_cells) {return false;}
+            std::memcpy(out, in, tile_cells);
+            return true;
+    }
+    return false;
+}
+
+void CompressedGrid::decodeDamagedAsUnknown(size_t index, int8_t* out) const {
+    if (decodeTile(index, out)) {return;}
+    std::memset(out, OccupancyGrid::unknown, tile_cells);
+    if (std::find(damaged.begin(), damaged.end(), index) == damaged.end()) {
+        std::cerr << "Map tile " << index << " is damaged, reading it as unknown" << std::endl;
+        damaged.push_back(index);
+    }
+}
+
+const int8_t* CompressedGrid::cachedTile(size_t index) const {
+    if (cache_tags.empty()) {
+        cache_tags.assign(cache_slots, -1);
+        cache_cells.resize(cache_slots * tile_cells);
+    }
+    // Both tile coordinates go into the slot, so any 3x3 block of tiles
+    // lands in 9 different slots whatever the map width (slot = index %
+    // slots put every tile under its neighbour in the same slot when the
+    // map was 16 tiles wide)
+    const size_t tile_x = index % size_t(tiles_x);
+    const size_t tile_y = index / size_t(tiles_x);
+    const size_t slot = (tile_x + tile_y*5) % cache_slots;
+    int8_t* cells = cache_cells.data() + slot*tile_cells;
+    if (cache_tags[slot] != int64_t(index)) {
+        decodeDamagedAsUnknown(index, cells);
+        cache_tags[slot] = int64_t(index);
+    }
+    return cells;
+}
+
+int8_t CompressedGrid::at(int cx, int cy) const {
+    const size_t index = size_t(cy / tile_size)*tiles_x + cx / tile_size;
+    const TileEntry& entry = tiles[index];
+    const size_t cell = size_t(cy % tile_size)*tile_size + cx % tile_size;
+    if (entry.encoding == TileEncoding::Uniform) {return entry.uniform_value;}
+    if (entry.encoding == TileEncoding::Raw) {return int8_t(payload[entry.offset + cell]);}
+    return cachedTile(index)[cell];
+}
+
+OccupancyGrid CompressedGrid::decompress() const {
+    OccupancyGrid grid(grid_width, grid_height, resolution_cm, origin_cm);
+    std::vector<int8_t> tile(tile_cells);
+    for (int ty = 0; ty < tiles_y; ty++) {
+        for (int tx = 0; tx < tiles_x; tx++) {
+            decodeDamagedAsUnknown(size_t(ty)*tiles_x + tx, tile.data());
+            const int x0 = tx*tile_size;
+            const int y0 = ty*tile_size;
+            const int columns = std::min(tile_size, grid_width - x0);
+            for (int row = 0; row < tile_size && y0 + row < grid_height; row++) {
+                std::memcpy(grid.data() + size_t(y0 + row)*grid_width + x0, &tile[size_t(row)*tile_size], columns);
+            }
+        }
+    }
+    grid.markModified();
+    return grid;
+}
+
+size_t CompressedGrid::compressedBytes() const {
+    return payload.size() + tiles.size() * (2 + 2*sizeof(uint32_t));
+}
+
+std::vector<size_t> CompressedGrid::encodingCounts() const {
+    std::vector<size_t> counts(4, 0);
+    for (const TileEntry& entry : tiles) {counts[size_t(entry.encoding)]++;}
+    return counts;
+}
+
+bool CompressedGrid::save(const std::string& path) const {
+    const std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Error opening map file for writing: " << temporary << std::endl;
+        return false;
+    }
+
+    file.write(file_magic, sizeof(file_magic));
+    writeValue(file, file_version);
+    writeValue(file, int32_t(grid_width));
+    writeValue(file, int32_t(grid_height));
+    writeValue(file, resolution_cm);
+    writeValue(file, origin_cm.x);
+    writeValue(file, origin_cm.y);
+    writeValue(file, int32_t(tile_size));
+    writeValue(file, uint32_t(tiles.size()));
+    writeValue(file, uint64_t(payload.size()));
+    for (const TileEntry& entry : tiles) {
+        writeValue(file, uint8_t(entry.encoding));
+        writeValue(file, entry.uniform_value);
+        writeValue(file, entry.offset);
+        writeValue(file, entry.size);
+    }
+    file.write(reinterpret_cast<const char*>(payload.data()), std::streamsize(payload.size()));
+    file.close();
+
+    if (!file || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error writing map file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool CompressedGrid::load(const std::string& path){
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    // Every size in the header is checked against this before anything
+    // is allocated from it
+    const uint64_t file_bytes = file ? uint64_t(std::max<std::streamoff>(file.tellg(), 0)) : 0;
+    file.seekg(0);
+    char magic[4];
+    uint32_t version = 0, tile_count = 0;
+    int32_t w = 0, h = 0, stored_tile_size = 0;
+    uint64_t payload_size = 0;
+    CompressedGrid loaded;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, file_magic, sizeof(magic)) != 0 ||
+        !readValue(file, version) || version != file_version ||
+        !readValue(file, w) || !readValue(file, h) || !readValue(file, loaded.resolution_cm) ||
+        !readValue(file, loaded.origin_cm.x) || !readValue(file, loaded.origin_cm.y) ||
+        !readValue(file, stored_tile_size) || stored_tile_size != tile_size ||
+        !readValue(file, tile_count) || !readValue(file, payload_size) ||
+        w <= 0 || h <= 0 || w > max_side_cells || h > max_side_cells ||
+        !std::isfinite(loaded.resolution_cm) || loaded.resolution_cm <= 0 ||
+        !std::isfinite(loaded.origin_cm.x) || !std::isfinite(loaded.origin_cm.y)) {
+        std::cerr << "Invalid map file header: " << path << std::endl;
+        return false;
+    }
+
+    loaded.grid_width = w;
+    loaded.grid_height = h;
+    loaded.tiles_x = (w + tile_size - 1) / tile_size;
+    loaded.tiles_y = (h + tile_size - 1) / tile_size;
+    if (tile_count != uint32_t(loaded.tiles_x) * uint32_t(loaded.tiles_y)) {
+        std::cerr << "Map file tile count doesn't match its size: " << path << std::endl;
+        return false;
+    }
+    const uint64_t directory_end = file_header_bytes + uint64_t(tile_count)*tile_entry_bytes;
+    if (directory_end > file_bytes || payload_size != file_bytes - directory_end) {
+        std::cerr << "Map file size doesn't match its header: " << path << std::endl;
+        return false;
+    }
+
+    loaded.tiles.resize(tile_count);
+    for (TileEntry& entry : loaded.tiles) {
+        uint8_t encoding = 0;
+        if (!readValue(file, encoding) || !readValue(file, entry.uniform_value) ||
+            !readValue(file, entry.offset) || !readValue(file, entry.size) || encoding > uint8_t(TileEncoding::Raw) ||
+            (encoding != uint8_t(TileEncoding::Uniform) && uint64_t(entry.offset) + entry.size > payload_size)) {
+            std::cerr << "Invalid map file tile directory: " << path << std::endl;
+            return false;
+        }
+        entry.encoding = TileEncoding(encoding);
+        // at() reads raw tiles straight from the payload, so their size
+        // has to be right before then
+        if (entry.encoding == TileEncoding::Raw && entry.size != tile_cells) {
+            std::cerr << "Invalid map file tile directory: " << path << std::endl;
+            return false;
+        }
+    }
+    loaded.payload.resize(payload_size);
+    if (!file.read(reinterpret_cast<char*>(loaded.payload.data()), std::streamsize(payload_size))) {
+        std::cerr << "Map file is truncated: " << path << std::endl;
+        return false;
+    }
+    *this = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file compressed_grid.hpp
+ * @brief Tile-compressed copy of an OccupancyGrid for cold storage and
+ * map files.
+ *
+ * @details The grid is cut into 64x64 tiles and each tile is stored with
+ * whichever encoding is smallest:
+ *   - Uniform: one value, for tiles that are all free or all unknown
+ *   - Rle: (run length - 1, value) byte pairs along the rows
+ *   - Quadtree: uniform quadrants collapse, mixed ones split down to 4x4
+ *   - Raw: the 4096 cells as-is, when nothing else helps
+ * Tiles are only decoded when a cell in them is read, into a small
+ * cache of recently used tiles.  A tile found damaged then reads as
+ * unknown, load() only checks what it can without decoding.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "occupancy_grid.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class TileEncoding : uint8_t {
+    Uniform = 0,
+    Rle = 1,
+    Quadtree = 2,
+    Raw = 3,
+};
+
+/**
+ * @brief Whether compress() should pick encodings or keep every tile raw
+ */
+enum class TileCompression {
+    Best,
+    RawOnly,
+};
+
+class CompressedGrid {
+public:
+    static constexpr int tile_size = 64;
+    static constexpr size_t tile_cells = size_t(tile_size) * tile_size;
+
+    CompressedGrid() = default;
+
+    /**
+     * @brief Compresses a whole grid
+     *
+     * @param grid The map to store
+     * @param mode Best picks per-tile encodings, RawOnly is the baseline
+     * the benchmarks compare against
+     */
+    static CompressedGrid compress(const OccupancyGrid& grid, TileCompression mode = TileCompression::Best);
+
+    /**
+     * @brief Decodes every tile back into a normal grid, damaged tiles as
+     * unknown
+     */
+    OccupancyGrid decompress() const;
+
+    /**
+     * @brief Reads one cell, decoding (and caching) its tile if needed
+     *
+     * @details Uniform tiles are answered straight from the directory
+     * and raw tiles straight from the payload, a damaged tile reads as
+     * unknown.  Not thread safe because of the tile cache.
+     *
+     * @param cx Cell column, must be in bounds
+     * @param cy Cell row, must be in bounds
+     */
+    int8_t at(int cx, int cy) const;
+
+    /**
+     * @brief Writes the compressed map to a file, false on failure
+     *
+     * @details Writes to PATH.tmp and renames it over PATH so a reader
+     * never sees half a file.
+     *
+     * @param path Where to put the map
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Reads a map written by save(), false on failure
+     *
+     * @param path The map file
+     */
+    bool load(const std::string& path);
+
+    int width() const { return grid_width; }
+    int height() const { return grid_height; }
+    float resolution() const { return resolution_cm; }
+    Vec2 origin() const { return origin_cm; }
+    size_t tileCount() const { return tiles.size(); }
+
+    /**
+     * @brief Tiles found damaged so far, by at() or decompress()
+     */
+    size_t damagedTiles() const { return damaged.size(); }
+
+    /**
+     * @brief Bytes the tiles take up, directory included
+     */
+    size_t compressedBytes() const;
+
+    /**
+     * @brief How many tiles ended up with each encoding, by enum value
+     */
+    std::vector<size_t> encodingCounts() const;
+
+private:
+    struct TileEntry {
+        TileEncoding encoding;
+        int8_t uniform_value;   // the value for Uniform tiles
+        uint32_t offset;        // into payload, unused for Uniform
+        uint32_t size;
+    };
+
+    /**
+     * @brief False if the tile's stream is malformed, leaving out part
+     * written
+     */
+    bool decodeTile(size_t tile, int8_t* out) const;
+    /**
+     * @brief decodeTile, with a damaged tile all unknown and reported the
+     * first time it turns up
+     */
+    void decodeDamagedAsUnknown(size_t tile, int8_t* out) const;
+    const int8_t* cachedTile(size_t tile) const;
+
+    int grid_width = 0;
+    int grid_height = 0;
+    float resolution_cm = 1;
+    Vec2 origin_cm;
+    int tiles_x = 0;
+    int tiles_y = 0;
+    std::vector<TileEntry> tiles;
+    std::vector<uint8_t> payload;
+
+    // Direct-mapped cache of decoded tiles, the slot mixes both tile
+    // coordinates so neighbouring tiles don't evict each other
+    static constexpr size_t cache_slots = 16;
+    mutable std::vector<int8_t> cache_cells;
+    mutable std::vector<int64_t> cache_tags;
+    mutable std::vector<size_t> damaged;
+};
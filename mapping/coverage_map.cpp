@@ -0,0 +1,55 @@
+/**
+ * @file coverage_map.cpp
+ * @brief Area coverage queries for CoverageMap.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "coverage_map.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+CoverageMap::CoverageMap(const OccupancyGrid& grid)
+    : map_width(grid.width()), map_height(grid.height()), resolution_cm(grid.resolution()),
+      origin_cm(grid.origin()), observation_count(size_t(map_width)*map_height, 0),
+      best_incidence(observation_count.size(), never_hit), last_seen(observation_count.size(), 0) {}
+
+double CoverageMap::coveredFraction(uint16_t min_observations, Vec2 min_cm, Vec2 max_cm) const {
+    return coveredFraction(min_observations, min_cm, max_cm, min_cm, INFINITY);
+}
+
+double CoverageMap::coveredFraction(uint16_t min_observations, Vec2 min_cm, Vec2 max_cm,
+                                    Vec2 center_cm, float radius_cm) const {
+    const int x0 = std::max(0, int(std::floor((min_cm.x - origin_cm.x) / resolution_cm)));
+    const int y0 = std::max(0, int(std::floor((min_cm.y - origin_cm.y) / resolution_cm)));
+    const int x1 = std::min(map_width, int(std::ceil((max_cm.x - origin_cm.x) / resolution_cm)));
+    const int y1 = std::min(map_height, int(std::ceil((max_cm.y - origin_cm.y) / resolution_cm)));
+    if (x1 <= x0 || y1 <= y0) {return 0;}
+
+    // Cells count by their centres, a row at a time: the columns whose
+    // centre is inside the circle at that row's height
+    size_t covered = 0;
+    size_t cells = 0;
+    for (int y = y0; y < y1; y++) {
+        const float dy = origin_cm.y + (y + 0.5f)*resolution_cm - center_cm.y;
+        if (dy*dy > radius_cm*radius_cm) {continue;}
+        const float half_width = std::sqrt(radius_cm*radius_cm - dy*dy);
+        const float from = (center_cm.x - half_width - origin_cm.x) / resolution_cm - 0.5f;
+        const float to = (center_cm.x + half_width - origin_cm.x) / resolution_cm - 0.5f;
+        const int row_x0 = std::isinf(from) ? x0 : std::max(x0, int(std::ceil(from)));
+        const int row_x1 = std::isinf(to) ? x1 : std::min(x1, int(std::floor(to)) + 1);
+        const uint16_t* row = observation_count.data() + index(0, y);
+        for (int x = row_x0; x < row_x1; x++) {
+            covered += row[x] >= min_observations;
+        }
+        cells += size_t(std::max(0, row_x1 - row_x0));
+    }
+    return cells > 0 ? double(covered) / cells : 0;
+}
+
+double CoverageMap::coveredFraction(uint16_t min_observations) const {
+    const Vec2 far_corner{origin_cm.x + map_width*resolution_cm, origin_cm.y + map_height*resolution_cm};
+    return coveredFraction(min_observations, origin_cm, far_corner);
+}
@@ -0,0 +1,112 @@
+/**
+ * @file coverage_map.hpp
+ * @brief Per-cell record of how often and how well each part of the map
+ * has been observed.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "occupancy_grid.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Coverage layer lined up cell for cell with an OccupancyGrid
+ *
+ * @details OccupancyGrid::integrateRay fills this in while it walks the
+ * beam, so keeping coverage costs no extra traversal.  Every cell a beam
+ * passes through or ends in counts as one observation; cells a beam
+ * ends in also remember the best (closest to head-on) incidence angle
+ * they were hit at, since glancing ultrasonic hits are the unreliable
+ * ones.
+ */
+class CoverageMap {
+public:
+    static constexpr uint8_t never_hit = OccupancyGrid::unknown_incidence;
+
+    /**
+     * @brief Creates an empty layer with the same shape as the grid
+     */
+    explicit CoverageMap(const OccupancyGrid& grid);
+
+    int width() const { return map_width; }
+    int height() const { return map_height; }
+    float resolution() const { return resolution_cm; }
+    Vec2 origin() const { return origin_cm; }
+
+    uint16_t observations(int cx, int cy) const { return observation_count[index(cx, cy)]; }
+    uint8_t bestIncidenceDeg(int cx, int cy) const { return best_incidence[index(cx, cy)]; }
+    uint32_t lastSeenMs(int cx, int cy) const { return last_seen[index(cx, cy)]; }
+
+    // Whole layers, row-major like the grid, for saving and restoring
+    const uint16_t* observationData() const { return observation_count.data(); }
+    uint16_t* observationData() { return observation_count.data(); }
+    const uint8_t* incidenceData() const { return best_incidence.data(); }
+    uint8_t* incidenceData() { return best_incidence.data(); }
+    const uint32_t* lastSeenData() const { return last_seen.data(); }
+    uint32_t* lastSeenData() { return last_seen.data(); }
+
+    /**
+     * @brief Counts a beam passing through a cell
+     */
+    void observe(size_t cell, uint32_t time_ms){
+        if (observation_count[cell] != UINT16_MAX) {observation_count[cell]++;}
+        last_seen[cell] = time_ms;
+    }
+
+    /**
+     * @brief Counts a beam ending in a cell and keeps the best angle
+     *
+     * @param cell Row-major cell index
+     * @param incidence_deg 0 for head-on up to 90 for grazing, or never_hit
+     * when the angle couldn't be worked out
+     * @param time_ms When the sample was taken
+     */
+    void observeHit(size_t cell, uint8_t incidence_deg, uint32_t time_ms){
+        observe(cell, time_ms);
+        if (best_incidence[cell] == never_hit || incidence_deg < best_incidence[cell]) {
+            best_incidence[cell] = incidence_deg;
+        }
+    }
+
+    /**
+     * @brief Fraction (0-1) of a world rectangle seen at least N times
+     *
+     * @param min_observations Observations a cell needs to count
+     * @param min_cm Lower-left corner of the region
+     * @param max_cm Upper-right corner of the region
+     */
+    double coveredFraction(uint16_t min_observations, Vec2 min_cm, Vec2 max_cm) const;
+
+    /**
+     * @brief Fraction (0-1) of the cells in a world rectangle that are
+     * also within radius_cm of a point, seen at least N times
+     *
+     * @details A cell counts as inside when its centre is.  The rectangle
+     * above the scanner cut by a circle of the sensor's range is the half
+     * disc a sweep can actually reach, which a plain rectangle overstates
+     * by 4/pi.
+     */
+    double coveredFraction(uint16_t min_observations, Vec2 min_cm, Vec2 max_cm,
+                           Vec2 center_cm, float radius_cm) const;
+
+    /**
+     * @brief Same as above over the whole map
+     */
+    double coveredFraction(uint16_t min_observations) const;
+
+private:
+    size_t index(int cx, int cy) const { return size_t(cy)*map_width + cx; }
+
+    int map_width;
+    int map_height;
+    float resolution_cm;
+    Vec2 origin_cm;
+    std::vector<uint16_t> observation_count;
+    std::vector<uint8_t> best_incidence;
+    std::vector<uint32_t> last_seen;
+};
@@ -0,0 +1,121 @@
+/**
+ * @file distance_field.cpp
+ * @brief Felzenszwalb-Huttenlocher squared distance transform.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "distance_field.hpp"
+#include "../util/thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const float far_away = 1e20f;
+
+/**
+ * @brief 1D squared distance transform of a sampled function
+ *
+ * @details Computes the lower envelope of the parabolas rooted at every
+ * sample, written out in full since it's the inner loop of the build.
+ *
+ * @param f Input samples, 0 on obstacles and far_away elsewhere
+ * @param n Sample count
+ * @param d Output squared distances
+ * @param root Output, the sample each distance was measured to
+ * @param v Scratch, n ints, parabola roots
+ * @param z Scratch, n+1 floats, envelope boundaries
+ */
+void transform1d(const float* f, int n, float* d, int* root, int* v, float* z){
+    int k = 0;
+    v[0] = 0;
+    z[0] = -std::numeric_limits<float>::infinity();
+    z[1] = std::numeric_limits<float>::infinity();
+    for (int q = 1; q < n; q++) {
+        float s = ((f[q] + float(q)*q) - (f[v[k]] + float(v[k])*v[k])) / float(2*q - 2*v[k]);
+        while (s <= z[k]) {
+            k--;
+            s = ((f[q] + float(q)*q) - (f[v[k]] + float(v[k])*v[k])) / float(2*q - 2*v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k+1] = std::numeric_limits<float>::infinity();
+    }
+
+    k = 0;
+    for (int q = 0; q < n; q++) {
+        while (z[k+1] < q) {k++;}
+        const float offset = float(q - v[k]);
+        d[q] = offset*offset + f[v[k]];
+        root[q] = v[k];
+    }
+}
+
+}  // namespace
+
+void DistanceField::build(const OccupancyGrid& grid, ThreadPool* pool){
+    field_width = grid.width();
+    field_height = grid.height();
+    source_revision = grid.revision();
+    distances.resize(size_t(field_width)*field_height);
+    nearest.resize(distances.size());
+
+    const int w = field_width;
+    const int h = field_height;
+    const float resolution = grid.resolution();
+    const int8_t* cells = grid.data();
+    float* out = distances.data();
+    int32_t* closest = nearest.data();
+
+    // Columns, squared distance in cells to the nearest obstacle in the
+    // column, with that obstacle's row parked in the nearest array
+    auto columns = [&](size_t begin, size_t end) {
+        std::vector<float> f(h), d(h), z(h + 1);
+        std::vector<int> root(h), v(h);
+        for (size_t x = begin; x < end; x++) {
+            for (int y = 0; y < h; y++) {
+                f[y] = cells[size_t(y)*w + x] > OccupancyGrid::occupied_threshold ? 0.0f : far_away;
+            }
+            transform1d(f.data(), h, d.data(), root.data(), v.data(), z.data());
+            for (int y = 0; y < h; y++) {
+                out[size_t(y)*w + x] = d[y];
+                closest[size_t(y)*w + x] = root[y];
+            }
+        }
+    };
+
+    // Rows, combines the column results into the full 2D distance in cm,
+    // the winning column plus its stored row gives the nearest cell
+    auto rows = [&](size_t begin, size_t end) {
+        std::vector<float> d(w), z(w + 1);
+        std::vector<int> root(w), v(w), column_rows(w);
+        for (size_t y = begin; y < end; y++) {
+            float* row = out + y*w;
+            int32_t* row_closest = closest + y*w;
+            std::copy(row_closest, row_closest + w, column_rows.begin());
+            transform1d(row, w, d.data(), root.data(), v.data(), z.data());
+            for (int x = 0; x < w; x++) {
+                if (d[x] >= far_away) {
+                    row[x] = no_obstacle;
+                    row_closest[x] = -1;
+                } else {
+                    row[x] = std::sqrt(d[x]) * resolution;
+                    row_closest[x] = int32_t(column_rows[root[x]]*w + root[x]);
+                }
+            }
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(0, w, 64, columns);
+        pool->parallelFor(0, h, 64, rows);
+    } else {
+        columns(0, w);
+        rows(0, h);
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * @file distance_field.hpp
+ * @brief Euclidean distance from every cell to the nearest occupied cell.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "occupancy_grid.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @brief Exact distance transform of an OccupancyGrid
+ *
+ * @details Uses the separable Felzenszwalb-Huttenlocher transform, one
+ * 1D pass down every column and then one along every row, so building
+ * is linear in the number of cells.  Distances are stored in cm, and
+ * the cell index of the obstacle each distance was measured to is kept
+ * alongside so nearest-obstacle lookups don't need a search.
+ */
+class DistanceField {
+public:
+    /**
+     * @brief Distance reported for cells when the grid has no obstacles
+     */
+    static constexpr float no_obstacle = 1e9f;
+
+    DistanceField() = default;
+
+    /**
+     * @brief Recomputes the transform from the grid's occupied cells
+     *
+     * @param grid The map to transform
+     * @param pool Optional pool to split the column and row passes over
+     */
+    void build(const OccupancyGrid& grid, ThreadPool* pool = nullptr);
+
+    int width() const { return field_width; }
+    int height() const { return field_height; }
+    bool empty() const { return distances.empty(); }
+
+    /**
+     * @brief Revision of the grid this field was last built from
+     */
+    uint64_t sourceRevision() const { return source_revision; }
+
+    float distanceCm(int cx, int cy) const { return distances[size_t(cy)*field_width + cx]; }
+    const float* data() const { return distances.data(); }
+
+    /**
+     * @brief Row-major index of the closest occupied cell, -1 if none
+     */
+    int32_t nearestCell(int cx, int cy) const { return nearest[size_t(cy)*field_width + cx]; }
+
+private:
+    int field_width = 0;
+    int field_height = 0;
+    uint64_t source_revision = 0;
+    std::vector<float> distances;
+    std::vector<int32_t> nearest;
+};
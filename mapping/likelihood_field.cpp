@@ -0,0 +1,32 @@
+/**
+ * @file likelihood_field.cpp
+ * @brief Converts a distance transform into per-cell log-likelihoods.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "likelihood_field.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void LikelihoodField::build(const OccupancyGrid& grid, const LikelihoodModel& model, ThreadPool* pool){
+    distance_field.build(grid, pool);
+    resolution_cm = grid.resolution();
+    origin_cm = grid.origin();
+
+    const float random_part = model.z_random / model.max_range_cm;
+    const float inverse_variance = 1.0f / (2.0f * model.sigma_hit_cm * model.sigma_hit_cm);
+    // Past a few sigma the gaussian is nothing, clamping keeps exp() sane
+    const float far_cm = 4.0f * model.sigma_hit_cm;
+
+    const size_t count = size_t(distance_field.width()) * distance_field.height();
+    log_likelihood.resize(count);
+    const float* distances = distance_field.data();
+    for (size_t i = 0; i < count; i++) {
+        const float d = std::min(distances[i], far_cm);
+        log_likelihood[i] = std::log(model.z_hit * std::exp(-d*d*inverse_variance) + random_part);
+    }
+    outside_value = std::log(random_part);
+}
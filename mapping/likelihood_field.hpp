@@ -0,0 +1,60 @@
+/**
+ * @file likelihood_field.hpp
+ * @brief Precomputed sensor model for scoring scans against a map.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "distance_field.hpp"
+
+#include <vector>
+
+struct LikelihoodModel {
+    float sigma_hit_cm = 2.0f;    // spread of a reading around the true wall
+    float z_hit = 0.9f;           // weight of the gaussian part
+    float z_random = 0.1f;        // weight of the uniform "random reading" part
+    float max_range_cm = 50.0f;   // sensor max, used to size the uniform part
+};
+
+/**
+ * @brief Log-likelihood of a beam ending in each cell
+ *
+ * @details The likelihood-field model scores a reading by how close its
+ * endpoint lands to an obstacle:
+ *     p = z_hit * exp(-d^2 / 2 sigma^2) + z_random / max_range
+ * The log is stored so a scan's score is a plain sum, and endpoints off
+ * the map score as a random reading.
+ */
+class LikelihoodField {
+public:
+    LikelihoodField() = default;
+
+    /**
+     * @brief Builds the field for a grid, reusing the distance transform
+     *
+     * @param grid The known map
+     * @param model Sensor noise parameters
+     * @param pool Optional pool for the distance transform
+     */
+    void build(const OccupancyGrid& grid, const LikelihoodModel& model, ThreadPool* pool = nullptr);
+
+    int width() const { return distance_field.width(); }
+    int height() const { return distance_field.height(); }
+    float resolution() const { return resolution_cm; }
+    Vec2 origin() const { return origin_cm; }
+    bool empty() const { return log_likelihood.empty(); }
+
+    const float* data() const { return log_likelihood.data(); }
+    float outsideValue() const { return outside_value; }
+    const DistanceField& distances() const { return distance_field; }
+
+private:
+    DistanceField distance_field;
+    std::vector<float> log_likelihood;
+    float outside_value = 0;
+    float resolution_cm = 1;
+    Vec2 origin_cm;
+};
@@ -0,0 +1,242 @@
+/**
+ * @file localizer.cpp
+ * @brief Prediction, likelihood-field weighting and low-variance
+ * resampling for MonteCarloLocalizer.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "localizer.hpp"
+#include "../util/thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start){
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief splitmix64, small and fast enough to seed one per batch
+ */
+struct SplitMix64 {
+    uint64_t state;
+
+    uint64_t next(){
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in (0, 1]
+    float uniform(){
+        return float((next() >> 40) + 1) * (1.0f / 16777216.0f);
+    }
+
+    // Standard normal through Box-Muller, second value thrown away
+    float gaussian(){
+        const float u1 = uniform();
+        const float u2 = uniform();
+        return std::sqrt(-2.0f * std::log(u1)) * std::cos(float(2*M_PI) * u2);
+    }
+};
+
+SplitMix64 batchRandom(uint64_t seed, uint64_t generation, size_t batch){
+    SplitMix64 mixer{seed ^ (generation * 0x9e3779b97f4a7c15ULL) ^ (uint64_t(batch) << 32)};
+    return SplitMix64{mixer.next()};
+}
+
+/**
+ * @brief The likelihood field as plain values, so the weighting loop
+ * reads nothing through a reference it can't prove unchanged
+ */
+struct FieldLookup {
+    const float* cells;
+    int width;
+    float inverse_resolution;
+    float origin_x, origin_y;
+    float width_f, height_f;    // grid size, the bounds test
+    float max_x, max_y;         // last cell, the clamp
+    float outside;
+};
+
+/**
+ * @brief Adds one beam's log-likelihood to every particle in [begin, end)
+ *
+ * @details No branches so it vectorizes, with the cell lookups as a
+ * gather: the cell position is clamped into the grid (NaN included),
+ * where truncating is floor since it's no longer negative, the lookup
+ * always happens and a select swaps in the outside value for endpoints
+ * off the map.  gcc's -O2 cost model still leaves it scalar, hence the
+ * omp simd, which -fopenmp-simd honours without pulling in OpenMP.
+ */
+void addBeamLikelihood(const FieldLookup& grid, const float* __restrict px, const float* __restrict py,
+                       const float* __restrict pc, const float* __restrict ps, float* __restrict lw,
+                       size_t begin, size_t end, float bx, float by){
+    const FieldLookup g = grid;
+#pragma omp simd
+    for (size_t i = begin; i < end; i++) {
+        const float ex = px[i] + pc[i]*bx - ps[i]*by;
+        const float ey = py[i] + ps[i]*bx + pc[i]*by;
+        const float fx = (ex - g.origin_x) * g.inverse_resolution;
+        const float fy = (ey - g.origin_y) * g.inverse_resolution;
+        const bool inside = (fx >= 0.0f) & (fx < g.width_f) & (fy >= 0.0f) & (fy < g.height_f);
+        const int gx = int(std::min(g.max_x, std::max(0.0f, fx)));
+        const int gy = int(std::min(g.max_y, std::max(0.0f, fy)));
+        const float cell = g.cells[gy*g.width + gx];
+        lw[i] += inside ? cell : g.outside;
+    }
+}
+
+}  // namespace
+
+MonteCarloLocalizer::MonteCarloLocalizer(const LocalizerConfig& config, ThreadPool& pool)
+    : config(config), pool(pool) {
+    const size_t n = config.particles;
+    xs.resize(n); ys.resize(n); thetas.resize(n); weights.assign(n, 1.0f / n);
+    cos_theta.resize(n); sin_theta.resize(n); log_weights.resize(n);
+    next_xs.resize(n); next_ys.resize(n); next_thetas.resize(n);
+}
+
+void MonteCarloLocalizer::initialize(const Pose2& pose, float spread_xy_cm, float spread_theta){
+    const size_t n = xs.size();
+    pool.parallelFor(0, n, config.batch_size, [&](size_t begin, size_t end) {
+        SplitMix64 random = batchRandom(config.seed, generation, begin / config.batch_size);
+        for (size_t i = begin; i < end; i++) {
+            xs[i] = pose.x + random.gaussian() * spread_xy_cm;
+            ys[i] = pose.y + random.gaussian() * spread_xy_cm;
+            thetas[i] = pose.theta + random.gaussian() * spread_theta;
+        }
+    });
+    std::fill(weights.begin(), weights.end(), 1.0f / n);
+    generation++;
+    mean_pose = pose;
+    effective_sample_size = double(n);
+}
+
+void MonteCarloLocalizer::predict(const Pose2& delta){
+    const auto start = Clock::now();
+    pool.parallelFor(0, xs.size(), config.batch_size, [&](size_t begin, size_t end) {
+        SplitMix64 random = batchRandom(config.seed, generation, begin / config.batch_size);
+        for (size_t i = begin; i < end; i++) {
+            const float c = std::cos(thetas[i]);
+            const float s = std::sin(thetas[i]);
+            xs[i] += c*delta.x - s*delta.y + random.gaussian() * config.motion_sigma_xy_cm;
+            ys[i] += s*delta.x + c*delta.y + random.gaussian() * config.motion_sigma_xy_cm;
+            thetas[i] += delta.theta + random.gaussian() * config.motion_sigma_theta;
+        }
+    });
+    generation++;
+    step_timing.predict_ms = millisecondsSince(start);
+}
+
+void MonteCarloLocalizer::update(const Scan& scan, const LikelihoodField& field, float max_range_cm){
+    const auto start = Clock::now();
+    const size_t n = xs.size();
+
+    // Beam endpoints in the scanner frame, only real hits say anything
+    beam_x.clear();
+    beam_y.clear();
+    const size_t stride = std::max<size_t>(config.beam_stride, 1);
+    for (size_t i = 0; i < scan.samples.size(); i += stride) {
+        const RangeSample& sample = scan.samples[i];
+        if (sample.range_cm <= 0 || sample.range_cm >= max_range_cm) {continue;}
+        const float angle = degreesToRadians(sample.angle_deg);
+        beam_x.push_back(std::cos(angle) * sample.range_cm);
+        beam_y.push_back(std::sin(angle) * sample.range_cm);
+    }
+    if (n == 0 || beam_x.empty() || field.empty()) {
+        step_timing.weight_ms = step_timing.resample_ms = 0;
+        return;
+    }
+
+    // Weighting, each batch runs beam by beam over contiguous particles
+    const FieldLookup grid{field.data(), field.width(), 1.0f / field.resolution(), field.origin().x,
+                           field.origin().y, float(field.width()), float(field.height()),
+                           float(field.width() - 1), float(field.height() - 1), field.outsideValue()};
+    const size_t beams = beam_x.size();
+
+    pool.parallelFor(0, n, config.batch_size, [&](size_t begin, size_t end) {
+        const float* __restrict px = xs.data();
+        const float* __restrict py = ys.data();
+        float* __restrict pc = cos_theta.data();
+        float* __restrict ps = sin_theta.data();
+        float* __restrict lw = log_weights.data();
+        for (size_t i = begin; i < end; i++) {
+            pc[i] = std::cos(thetas[i]);
+            ps[i] = std::sin(thetas[i]);
+            lw[i] = std::log(weights[i]);
+        }
+        for (size_t b = 0; b < beams; b++) {
+            addBeamLikelihood(grid, px, py, pc, ps, lw, begin, end, beam_x[b], beam_y[b]);
+        }
+    });
+
+    // Normalize in log space first so exp() doesn't underflow everything
+    const float best = *std::max_element(log_weights.begin(), log_weights.end());
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        weights[i] = std::exp(log_weights[i] - best);
+        sum += weights[i];
+    }
+    double squares = 0;
+    const float inverse_sum = float(1.0 / sum);
+    for (size_t i = 0; i < n; i++) {
+        weights[i] *= inverse_sum;
+        squares += double(weights[i]) * weights[i];
+    }
+    effective_sample_size = 1.0 / squares;
+    computeEstimate();
+    step_timing.weight_ms = millisecondsSince(start);
+
+    const auto resample_start = Clock::now();
+    if (effective_sample_size < config.resample_threshold * n) {resample();}
+    step_timing.resample_ms = millisecondsSince(resample_start);
+
+    step_timing.total_ms = step_timing.predict_ms + step_timing.weight_ms + step_timing.resample_ms;
+    step_timing.total_ms_sum += step_timing.total_ms;
+    step_timing.worst_total_ms = std::max(step_timing.worst_total_ms, step_timing.total_ms);
+    step_timing.updates++;
+}
+
+void MonteCarloLocalizer::computeEstimate(){
+    double x = 0, y = 0, c = 0, s = 0;
+    for (size_t i = 0; i < xs.size(); i++) {
+        x += double(weights[i]) * xs[i];
+        y += double(weights[i]) * ys[i];
+        c += double(weights[i]) * cos_theta[i];
+        s += double(weights[i]) * sin_theta[i];
+    }
+    mean_pose = Pose2{float(x), float(y), float(std::atan2(s, c))};
+}
+
+void MonteCarloLocalizer::resample(){
+    // Low-variance sampler: one random offset, N evenly spaced pointers
+    const size_t n = xs.size();
+    SplitMix64 random = batchRandom(config.seed, generation, ~size_t(0));
+    const double step = 1.0 / n;
+    const double offset = random.uniform() * step;
+    double cumulative = weights[0];
+    size_t source = 0;
+    for (size_t m = 0; m < n; m++) {
+        const double pointer = offset + m*step;
+        while (pointer > cumulative && source + 1 < n) {
+            source++;
+            cumulative += weights[source];
+        }
+        next_xs[m] = xs[source];
+        next_ys[m] = ys[source];
+        next_thetas[m] = thetas[source];
+    }
+    xs.swap(next_xs);
+    ys.swap(next_ys);
+    thetas.swap(next_thetas);
+    std::fill(weights.begin(), weights.end(), float(step));
+}
@@ -0,0 +1,110 @@
+/**
+ * @file localizer.hpp
+ * @brief Monte Carlo (particle filter) localization of the scanner.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "likelihood_field.hpp"
+#include "scan.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+struct LocalizerConfig {
+    size_t particles = 10000;          // must not be 0
+    float motion_sigma_xy_cm = 1.0f;   // random walk per sweep when there's no odometry
+    float motion_sigma_theta = 0.02f;  // radians
+    size_t beam_stride = 2;            // use every Nth sample of the sweep
+    float resample_threshold = 0.5f;   // resample when N_eff / N drops below this
+    size_t batch_size = 1024;          // particles per parallel batch
+    uint64_t seed = 1;
+};
+
+/**
+ * @brief Milliseconds spent in each step, last update and running total
+ */
+struct LocalizerTiming {
+    double predict_ms = 0;
+    double weight_ms = 0;
+    double resample_ms = 0;
+    double total_ms = 0;
+    double total_ms_sum = 0;
+    double worst_total_ms = 0;
+    uint64_t updates = 0;
+};
+
+/**
+ * @brief Tracks a moving scanner within a known map
+ *
+ * @details Particles are kept as separate x/y/theta/weight arrays so the
+ * weighting loop runs over contiguous floats.  It has no branches and is
+ * marked #pragma omp simd (the Makefile passes -fopenmp-simd), so every
+ * build vectorizes it, the likelihood field lookups becoming gathers.
+ * bench/bench_localizer.cpp times a whole step against a sweep.
+ * Batches of particles are weighted in parallel on the pool, then
+ * low-variance (systematic) resampling draws the next generation when
+ * the effective sample size gets too small.
+ */
+class MonteCarloLocalizer {
+public:
+    MonteCarloLocalizer(const LocalizerConfig& config, ThreadPool& pool);
+
+    /**
+     * @brief Spreads the particles around a starting guess
+     *
+     * @param pose Where the scanner probably is
+     * @param spread_xy_cm Standard deviation of the position guess
+     * @param spread_theta Standard deviation of the heading guess
+     */
+    void initialize(const Pose2& pose, float spread_xy_cm, float spread_theta);
+
+    /**
+     * @brief Moves every particle by an odometry step plus motion noise
+     *
+     * @param delta Motion in the scanner's own frame since the last call
+     */
+    void predict(const Pose2& delta = Pose2());
+
+    /**
+     * @brief Weights the particles against one sweep and resamples
+     *
+     * @param scan The finished sweep
+     * @param field Likelihood field of the known map
+     * @param max_range_cm Readings at or past this are skipped
+     */
+    void update(const Scan& scan, const LikelihoodField& field, float max_range_cm);
+
+    /**
+     * @brief Weighted mean of the particles (circular mean for heading)
+     */
+    Pose2 estimate() const { return mean_pose; }
+
+    double effectiveSampleSize() const { return effective_sample_size; }
+    const LocalizerTiming& timing() const { return step_timing; }
+    size_t size() const { return xs.size(); }
+
+private:
+    void computeEstimate();
+    void resample();
+
+    LocalizerConfig config;
+    ThreadPool& pool;
+    uint64_t generation = 0;
+
+    // Particle state, one entry per particle
+    std::vector<float> xs, ys, thetas, weights;
+    // Scratch reused between updates
+    std::vector<float> cos_theta, sin_theta, log_weights;
+    std::vector<float> next_xs, next_ys, next_thetas;
+    std::vector<float> beam_x, beam_y;
+
+    Pose2 mean_pose;
+    double effective_sample_size = 0;
+    LocalizerTiming step_timing;
+};
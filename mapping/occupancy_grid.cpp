@@ -0,0 +1,101 @@
+/**
+ * @file occupancy_grid.cpp
+ * @brief Cell addressing and ray integration for OccupancyGrid.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "occupancy_grid.hpp"
+#include "coverage_map.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+OccupancyGrid::OccupancyGrid(int width, int height, float resolution_cm, Vec2 origin_cm)
+    : grid_width(width), grid_height(height), resolution_cm(resolution_cm),
+      inverse_resolution(1.0f / resolution_cm), origin_cm(origin_cm),
+      cells(size_t(width)*height, unknown) {}
+
+bool OccupancyGrid::worldToCell(float x, float y, int& cx, int& cy) const {
+    cx = int(std::floor((x - origin_cm.x) * inverse_resolution));
+    cy = int(std::floor((y - origin_cm.y) * inverse_resolution));
+    return inBounds(cx, cy);
+}
+
+Vec2 OccupancyGrid::cellCenter(int cx, int cy) const {
+    return Vec2{origin_cm.x + (cx + 0.5f)*resolution_cm, origin_cm.y + (cy + 0.5f)*resolution_cm};
+}
+
+uint8_t OccupancyGrid::incidenceDeg(int cx, int cy, float beam_angle_rad) const {
+    // Fit a line through the occupied cells around the hit, the wall
+    // runs along the direction the cells spread out in the most
+    float sum_x = 0, sum_y = 0, sum_xx = 0, sum_yy = 0, sum_xy = 0;
+    int count = 0;
+    for (int y = cy - 2; y <= cy + 2; y++) {
+        for (int x = cx - 2; x <= cx + 2; x++) {
+            if (!inBounds(x, y) || !isOccupied(x, y)) {continue;}
+            const float fx = float(x - cx), fy = float(y - cy);
+            sum_x += fx; sum_y += fy;
+            sum_xx += fx*fx; sum_yy += fy*fy; sum_xy += fx*fy;
+            count++;
+        }
+    }
+    // Not enough wall seen yet to have a direction
+    if (count < 3) {return unknown_incidence;}
+    const float xx = sum_xx/count - (sum_x/count)*(sum_x/count);
+    const float yy = sum_yy/count - (sum_y/count)*(sum_y/count);
+    const float xy = sum_xy/count - (sum_x/count)*(sum_y/count);
+    const float wall_angle = 0.5f * std::atan2(2*xy, xx - yy);
+    // Incidence is measured from the normal, so it's 90 minus the beam/wall angle
+    const float along_wall = std::fabs(std::cos(beam_angle_rad - wall_angle));
+    return uint8_t(std::lround(std::asin(std::min(along_wall, 1.0f)) * float(180 / M_PI)));
+}
+
+void OccupancyGrid::integrateRay(const Pose2& sensor, float angle_deg, float range_cm, float max_range_cm,
+                                 CoverageMap* coverage, uint32_t time_ms){
+    const bool hit = range_cm < max_range_cm;
+    const float length = std::min(range_cm, max_range_cm);
+    const float angle = sensor.theta + degreesToRadians(angle_deg);
+    const float end_x = sensor.x + std::cos(angle) * length;
+    const float end_y = sensor.y + std::sin(angle) * length;
+
+    // Both ends in cell space, the line itself may leave the grid
+    int x0 = int(std::floor((sensor.x - origin_cm.x) * inverse_resolution));
+    int y0 = int(std::floor((sensor.y - origin_cm.y) * inverse_resolution));
+    const int x1 = int(std::floor((end_x - origin_cm.x) * inverse_resolution));
+    const int y1 = int(std::floor((end_y - origin_cm.y) * inverse_resolution));
+
+    // Bresenham walk, every cell before the end is seen as free
+    const int dx = std::abs(x1 - x0);
+    const int dy = -std::abs(y1 - y0);
+    const int step_x = x0 < x1 ? 1 : -1;
+    const int step_y = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+    while (x0 != x1 || y0 != y1) {
+        if (inBounds(x0, y0)) {
+            const size_t index = size_t(y0)*grid_width + x0;
+            int8_t& cell = cells[index];
+            cell = int8_t(std::max(int(cell) - miss_decrement, -int(max_log_odds)));
+            if (coverage) {coverage->observe(index, time_ms);}
+        }
+        const int doubled = 2*error;
+        if (doubled >= dy) {error += dy; x0 += step_x;}
+        if (doubled <= dx) {error += dx; y0 += step_y;}
+    }
+
+    // End cell, either the obstacle or one more free cell at max range
+    if (inBounds(x1, y1)) {
+        const size_t index = size_t(y1)*grid_width + x1;
+        int8_t& cell = cells[index];
+        if (hit) {
+            cell = int8_t(std::min(int(cell) + hit_increment, int(max_log_odds)));
+            if (coverage) {coverage->observeHit(index, incidenceDeg(x1, y1, angle), time_ms);}
+        } else {
+            cell = int8_t(std::max(int(cell) - miss_decrement, -int(max_log_odds)));
+            if (coverage) {coverage->observe(index, time_ms);}
+        }
+    }
+    update_revision++;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file occupancy_grid.hpp
+ * @brief Log-odds occupancy grid built from the ultrasonic samples.
+ *
+ * @details This is the "matrix representing the points around a central
+ * location" that the raycasting view explores.  Each cell holds a
+ * clamped 8 bit log-odds value: 0 is unknown, positive is occupied and
+ * negative is free.  Cells are stored row-major with row 0 at the
+ * bottom (lowest y) of the world.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "scan.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class CoverageMap;
+
+class OccupancyGrid {
+public:
+    static constexpr int8_t unknown = 0;
+    static constexpr int8_t hit_increment = 24;
+    static constexpr int8_t miss_decrement = 6;
+    static constexpr int8_t max_log_odds = 120;
+    static constexpr int8_t occupied_threshold = 20;
+    static constexpr int8_t free_threshold = -10;
+    static constexpr uint8_t unknown_incidence = 255;
+
+    /**
+     * @brief Creates an all-unknown grid
+     *
+     * @param width Cells along x
+     * @param height Cells along y
+     * @param resolution_cm Edge length of one cell
+     * @param origin_cm World position of the lower-left corner of cell (0, 0)
+     */
+    OccupancyGrid(int width, int height, float resolution_cm, Vec2 origin_cm);
+
+    int width() const { return grid_width; }
+    int height() const { return grid_height; }
+    float resolution() const { return resolution_cm; }
+    Vec2 origin() const { return origin_cm; }
+
+    bool inBounds(int cx, int cy) const {
+        return cx >= 0 && cy >= 0 && cx < grid_width && cy < grid_height;
+    }
+
+    /**
+     * @brief Converts a world point in cm to a cell, false if off the grid
+     */
+    bool worldToCell(float x, float y, int& cx, int& cy) const;
+
+    /**
+     * @brief World position in cm of the middle of a cell
+     */
+    Vec2 cellCenter(int cx, int cy) const;
+
+    int8_t at(int cx, int cy) const { return cells[size_t(cy)*grid_width + cx]; }
+    bool isOccupied(int cx, int cy) const { return at(cx, cy) > occupied_threshold; }
+    bool isFree(int cx, int cy) const { return at(cx, cy) < free_threshold; }
+
+    const int8_t* data() const { return cells.data(); }
+    int8_t* data() { return cells.data(); }
+
+    /**
+     * @brief Counter bumped by every update, lets derived data
+     * (distance fields etc.) tell when they are stale
+     */
+    uint64_t revision() const { return update_revision; }
+    void markModified() { update_revision++; }
+
+    /**
+     * @brief Marks the cells along one ultrasonic reading
+     *
+     * @details Walks a Bresenham line from the sensor towards the
+     * reading, lowering every cell it passes through.  The final cell is
+     * raised as a hit unless the reading is at or past max range, in
+     * which case the whole beam up to max range is treated as free.
+     * When a coverage layer is passed it is updated in the same walk.
+     *
+     * @param sensor Pose of the scanner when the sample was taken
+     * @param angle_deg The servo degree the arduino reported
+     * @param range_cm The distance the arduino reported
+     * @param max_range_cm Readings at or past this are "nothing"
+     * @param coverage Optional coverage layer shaped like this grid
+     * @param time_ms Sample time stored as the cells' last-seen time
+     */
+    void integrateRay(const Pose2& sensor, float angle_deg, float range_cm, float max_range_cm,
+                      CoverageMap* coverage = nullptr, uint32_t time_ms = 0);
+
+    /**
+     * @brief Angle in degrees (0 head-on, 90 grazing) between a beam and
+     * the surface at a cell, with the surface direction estimated from a
+     * line fit through the occupied cells around it, unknown_incidence
+     * when too little of the surface has been seen to tell
+     *
+     * @param cx Cell the beam ended in
+     * @param cy Cell the beam ended in
+     * @param beam_angle_rad World direction the beam travelled in
+     */
+    uint8_t incidenceDeg(int cx, int cy, float beam_angle_rad) const;
+
+private:
+    int grid_width;
+    int grid_height;
+    float resolution_cm;
+    float inverse_resolution;
+    Vec2 origin_cm;
+    std::vector<int8_t> cells;
+    uint64_t update_revision = 0;
+};
@@ -0,0 +1,238 @@
+/**
+ * @file path_planner.cpp
+ * @brief Jump point search, see Harabor and Grastien, "Online Graph
+ * Pruning for Pathfinding on Grid Maps", using the no-corner-cutting
+ * pruning rules.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "path_planner.hpp"
+#include "../util/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+const float diagonal_cost = float(M_SQRT2);
+
+/**
+ * @brief Exact 8-connected distance in cells when nothing is in the way
+ */
+float octile(int dx, int dy){
+    dx = std::abs(dx);
+    dy = std::abs(dy);
+    return float(std::max(dx, dy) - std::min(dx, dy)) + diagonal_cost * std::min(dx, dy);
+}
+
+int sign(int value){
+    return (value > 0) - (value < 0);
+}
+
+}  // namespace
+
+PathPlanner::PathPlanner(const OccupancyGrid& grid, PlannerConfig config)
+    : grid(grid), config(config), width(grid.width()), height(grid.height()) {
+    const size_t cells = size_t(width) * height;
+    walkable_mask.resize(cells);
+    cost.resize(cells);
+    parent.resize(cells);
+    seen_stamp.assign(cells, 0);
+    closed_stamp.assign(cells, 0);
+    open.reserve(4096);
+    neighbours.reserve(8);
+}
+
+void PathPlanner::refreshWalkable(){
+    if (walkable_revision == grid.revision()) {return;}
+    const int8_t* cells = grid.data();
+    const int8_t limit = config.unknown_is_free ? OccupancyGrid::occupied_threshold : OccupancyGrid::free_threshold;
+    for (size_t i = 0; i < walkable_mask.size(); i++) {
+        walkable_mask[i] = config.unknown_is_free ? cells[i] <= limit : cells[i] < limit;
+    }
+    walkable_revision = grid.revision();
+}
+
+int32_t PathPlanner::jumpStraight(int x, int y, int dx, int dy) const {
+    while (true) {
+        if (!walkable(x, y)) {return -1;}
+        const int32_t cell = y*width + x;
+        if (cell == goal_cell) {return cell;}
+        // Forced neighbour: a wall beside us just ended, a new way opens up
+        if (dx != 0) {
+            if ((walkable(x, y - 1) && !walkable(x - dx, y - 1)) ||
+                (walkable(x, y + 1) && !walkable(x - dx, y + 1))) {return cell;}
+        } else {
+            if ((walkable(x - 1, y) && !walkable(x - 1, y - dy)) ||
+                (walkable(x + 1, y) && !walkable(x + 1, y - dy))) {return cell;}
+        }
+        x += dx;
+        y += dy;
+    }
+}
+
+int32_t PathPlanner::jumpDiagonal(int x, int y, int dx, int dy) const {
+    while (true) {
+        if (!walkable(x, y)) {return -1;}
+        const int32_t cell = y*width + x;
+        if (cell == goal_cell) {return cell;}
+        if (jumpStraight(x + dx, y, dx, 0) >= 0 || jumpStraight(x, y + dy, 0, dy) >= 0) {return cell;}
+        if (!walkable(x + dx, y) || !walkable(x, y + dy)) {return -1;}
+        x += dx;
+        y += dy;
+    }
+}
+
+void PathPlanner::pushOpen(float f, int32_t cell){
+    open.push_back(OpenEntry{f, cell});
+    std::push_heap(open.begin(), open.end(), [](const OpenEntry& a, const OpenEntry& b) { return a.f > b.f; });
+}
+
+PathPlanner::OpenEntry PathPlanner::popOpen(){
+    std::pop_heap(open.begin(), open.end(), [](const OpenEntry& a, const OpenEntry& b) { return a.f > b.f; });
+    const OpenEntry entry = open.back();
+    open.pop_back();
+    return entry;
+}
+
+void PathPlanner::addSuccessor(int32_t from, int32_t to){
+    if (closed_stamp[to] == stamp) {return;}
+    const int fx = from % width, fy = from / width;
+    const int tx = to % width, ty = to / width;
+    const float g = cost[from] + octile(tx - fx, ty - fy);
+    if (seen_stamp[to] == stamp && g >= cost[to]) {return;}
+    seen_stamp[to] = stamp;
+    cost[to] = g;
+    parent[to] = from;
+    pushOpen(g + octile(goal_cell % width - tx, goal_cell / width - ty), to);
+}
+
+PlanResult PathPlanner::plan(Vec2 start, Vec2 goal){
+    const auto started = std::chrono::steady_clock::now();
+    PlanResult result;
+    refreshWalkable();
+
+    int sx, sy, gx, gy;
+    if (!grid.worldToCell(start.x, start.y, sx, sy) || !grid.worldToCell(goal.x, goal.y, gx, gy) ||
+        !walkable(sx, sy) || !walkable(gx, gy)) {
+        return result;
+    }
+
+    // New query, stale stamps from earlier ones simply stop matching
+    if (++stamp == 0) {
+        std::fill(seen_stamp.begin(), seen_stamp.end(), 0);
+        std::fill(closed_stamp.begin(), closed_stamp.end(), 0);
+        stamp = 1;
+    }
+    open.clear();
+    goal_cell = gy*width + gx;
+    const int32_t start_cell = sy*width + sx;
+    cost[start_cell] = 0;
+    parent[start_cell] = -1;
+    seen_stamp[start_cell] = stamp;
+    pushOpen(octile(gx - sx, gy - sy), start_cell);
+
+    while (!open.empty()) {
+        const OpenEntry entry = popOpen();
+        const int32_t cell = entry.cell;
+        if (closed_stamp[cell] == stamp) {continue;}
+        closed_stamp[cell] = stamp;
+        result.expanded++;
+        if (cell == goal_cell) {
+            result.found = true;
+            break;
+        }
+
+        const int x = cell % width;
+        const int y = cell / width;
+
+        // Pruned neighbours, only directions the arrival move can't already cover
+        neighbours.clear();
+        if (parent[cell] < 0) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    if ((dx == 0 && dy == 0) || !walkable(x + dx, y + dy)) {continue;}
+                    if (dx != 0 && dy != 0 && (!walkable(x + dx, y) || !walkable(x, y + dy))) {continue;}
+                    neighbours.push_back((y + dy)*width + x + dx);
+                }
+            }
+        } else {
+            const int dx = sign(x - parent[cell] % width);
+            const int dy = sign(y - parent[cell] / width);
+            if (dx != 0 && dy != 0) {
+                const bool next_y = walkable(x, y + dy);
+                const bool next_x = walkable(x + dx, y);
+                if (next_y) {neighbours.push_back((y + dy)*width + x);}
+                if (next_x) {neighbours.push_back(y*width + x + dx);}
+                if (next_y && next_x) {neighbours.push_back((y + dy)*width + x + dx);}
+            } else if (dx != 0) {
+                const bool next = walkable(x + dx, y);
+                const bool up = walkable(x, y + 1);
+                const bool down = walkable(x, y - 1);
+                if (next) {
+                    neighbours.push_back(y*width + x + dx);
+                    if (up) {neighbours.push_back((y + 1)*width + x + dx);}
+                    if (down) {neighbours.push_back((y - 1)*width + x + dx);}
+                }
+                if (up) {neighbours.push_back((y + 1)*width + x);}
+                if (down) {neighbours.push_back((y - 1)*width + x);}
+            } else {
+                const bool next = walkable(x, y + dy);
+                const bool right = walkable(x + 1, y);
+                const bool left = walkable(x - 1, y);
+                if (next) {
+                    neighbours.push_back((y + dy)*width + x);
+                    if (right) {neighbours.push_back((y + dy)*width + x + 1);}
+                    if (left) {neighbours.push_back((y + dy)*width + x - 1);}
+                }
+                if (right) {neighbours.push_back(y*width + x + 1);}
+                if (left) {neighbours.push_back(y*width + x - 1);}
+            }
+        }
+
+        // Jump from each neighbour to the next point worth stopping at
+        for (const int32_t neighbour : neighbours) {
+            const int dx = neighbour % width - x;
+            const int dy = neighbour / width - y;
+            const int32_t jump = (dx != 0 && dy != 0)
+                ? jumpDiagonal(x + dx, y + dy, dx, dy)
+                : jumpStraight(x + dx, y + dy, dx, dy);
+            if (jump >= 0) {addSuccessor(cell, jump);}
+        }
+    }
+
+    if (result.found) {
+        for (int32_t cell = goal_cell; cell >= 0; cell = parent[cell]) {
+            result.path.push_back(grid.cellCenter(cell % width, cell / width));
+        }
+        std::reverse(result.path.begin(), result.path.end());
+        result.length_cm = cost[goal_cell] * grid.resolution();
+    }
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+BatchPathPlanner::BatchPathPlanner(const OccupancyGrid& grid, ThreadPool& pool, PlannerConfig config)
+    : pool(pool) {
+    for (size_t i = 0; i < pool.size() + 1; i++) {
+        planners.push_back(std::make_unique<PathPlanner>(grid, config));
+    }
+}
+
+BatchPathPlanner::~BatchPathPlanner() = default;
+
+void BatchPathPlanner::plan(const std::vector<PlanRequest>& requests, std::vector<PlanResult>& results){
+    results.assign(requests.size(), PlanResult());
+    std::atomic<size_t> next_request(0);
+    pool.parallelFor(0, planners.size(), 1, [&](size_t begin, size_t) {
+        PathPlanner& planner = *planners[begin];
+        for (size_t i = next_request++; i < requests.size(); i = next_request++) {
+            results[i] = planner.plan(requests[i].start, requests[i].goal);
+        }
+    });
+}
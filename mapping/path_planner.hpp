@@ -0,0 +1,108 @@
+/**
+ * @file path_planner.hpp
+ * @brief A* with jump point search over the occupancy grid.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "occupancy_grid.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class ThreadPool;
+
+struct PlannerConfig {
+    bool unknown_is_free = true;   // plan through cells nothing has been seen in yet
+};
+
+struct PlanRequest {
+    Vec2 start;   // world cm
+    Vec2 goal;
+};
+
+struct PlanResult {
+    bool found = false;
+    std::vector<Vec2> path;   // cell centers of the jump points, start to goal
+    float length_cm = 0;
+    size_t expanded = 0;      // nodes popped off the open list
+    double milliseconds = 0;
+};
+
+/**
+ * @brief Single-threaded JPS planner with its own reusable buffers
+ *
+ * @details Moves are 8-connected without cutting corners, a diagonal
+ * step needs both cells beside it free.  All per-cell state (cost,
+ * parent, open/closed) lives in arrays sized to the grid that are
+ * allocated once; a generation stamp marks which entries belong to the
+ * current query, so nothing is cleared between plans.  The walkable
+ * mask is rebuilt only when the grid's revision changes.
+ */
+class PathPlanner {
+public:
+    explicit PathPlanner(const OccupancyGrid& grid, PlannerConfig config = PlannerConfig());
+
+    /**
+     * @brief Plans a path between two world points
+     *
+     * @param start World position in cm to leave from
+     * @param goal World position in cm to reach
+     */
+    PlanResult plan(Vec2 start, Vec2 goal);
+
+private:
+    struct OpenEntry {
+        float f;
+        int32_t cell;
+    };
+
+    void refreshWalkable();
+    bool walkable(int x, int y) const {
+        return unsigned(x) < unsigned(width) && unsigned(y) < unsigned(height) && walkable_mask[size_t(y)*width + x];
+    }
+    int32_t jumpStraight(int x, int y, int dx, int dy) const;
+    int32_t jumpDiagonal(int x, int y, int dx, int dy) const;
+    void addSuccessor(int32_t from, int32_t to);
+    void pushOpen(float f, int32_t cell);
+    OpenEntry popOpen();
+
+    const OccupancyGrid& grid;
+    PlannerConfig config;
+    int width;
+    int height;
+    uint64_t walkable_revision = ~uint64_t(0);
+
+    std::vector<uint8_t> walkable_mask;
+    std::vector<float> cost;
+    std::vector<int32_t> parent;
+    std::vector<uint32_t> seen_stamp;
+    std::vector<uint32_t> closed_stamp;
+    std::vector<OpenEntry> open;
+    std::vector<int32_t> neighbours;
+    uint32_t stamp = 0;
+    int32_t goal_cell = -1;
+};
+
+/**
+ * @brief Plans many requests at once, one PathPlanner per thread
+ *
+ * @details The planners (and their buffers) are kept between batches.
+ * Threads pull requests off a shared counter so a few long plans don't
+ * leave the other threads idle.
+ */
+class BatchPathPlanner {
+public:
+    BatchPathPlanner(const OccupancyGrid& grid, ThreadPool& pool, PlannerConfig config = PlannerConfig());
+    ~BatchPathPlanner();
+
+    void plan(const std::vector<PlanRequest>& requests, std::vector<PlanResult>& results);
+
+private:
+    ThreadPool& pool;
+    std::vector<std::unique_ptr<PathPlanner>> planners;
+};
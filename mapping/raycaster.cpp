@@ -0,0 +1,61 @@
+/**
+ * @file raycaster.cpp
+ * @brief Distance-field stepping with a cell-by-cell finish.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "raycaster.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+Raycaster::Raycaster(const OccupancyGrid& grid, const DistanceField& field)
+    : grid(grid), field(field) {}
+
+RayHit Raycaster::cast(Vec2 start, float angle_rad, float max_range_cm) const {
+    RayHit result;
+    const float resolution = grid.resolution();
+    const float inverse_resolution = 1.0f / resolution;
+    const Vec2 origin = grid.origin();
+    const float dx = std::cos(angle_rad);
+    const float dy = std::sin(angle_rad);
+    // A point anywhere in a cell can be this much closer to a wall than the cell center
+    const float cell_slack = 1.5f * resolution;
+
+    float t = 0;
+    while (t < max_range_cm) {
+        const float x = start.x + dx*t;
+        const float y = start.y + dy*t;
+        const int cx = int(std::floor((x - origin.x) * inverse_resolution));
+        const int cy = int(std::floor((y - origin.y) * inverse_resolution));
+        if (!grid.inBounds(cx, cy)) {break;}
+
+        if (grid.isOccupied(cx, cy)) {
+            result.hit = true;
+            result.range_cm = t;
+            result.cell_x = cx;
+            result.cell_y = cy;
+            return result;
+        }
+
+        // Open space, jump by the clearance
+        const float clearance = field.distanceCm(cx, cy) - cell_slack;
+        if (clearance > resolution) {
+            t += clearance;
+            continue;
+        }
+
+        // Near a wall, step to the next cell boundary the ray crosses
+        const float next_x = origin.x + (cx + (dx > 0)) * resolution;
+        const float next_y = origin.y + (cy + (dy > 0)) * resolution;
+        const float to_x = dx != 0 ? (next_x - x) / dx : std::numeric_limits<float>::infinity();
+        const float to_y = dy != 0 ? (next_y - y) / dy : std::numeric_limits<float>::infinity();
+        t += std::max(std::min(to_x, to_y), 0.0f) + resolution * 1e-3f;
+    }
+
+    result.range_cm = std::min(t, max_range_cm);
+    return result;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file raycaster.hpp
+ * @brief Casts rays through the occupancy grid for the raycast view.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "distance_field.hpp"
+#include "occupancy_grid.hpp"
+
+/**
+ * @brief What a single ray ran into
+ */
+struct RayHit {
+    bool hit = false;     // false when max range or the map edge came first
+    float range_cm = 0;   // distance travelled along the ray
+    int cell_x = -1;      // the occupied cell, when hit
+    int cell_y = -1;
+};
+
+/**
+ * @brief Ray marching accelerated by the distance field
+ *
+ * @details In open space the ray jumps forward by the distance to the
+ * nearest obstacle (nothing can be closer, so nothing is skipped), and
+ * only walks cell by cell once it gets near a wall.  The grid and field
+ * must stay alive and unchanged while the raycaster is in use.
+ */
+class Raycaster {
+public:
+    Raycaster(const OccupancyGrid& grid, const DistanceField& field);
+
+    /**
+     * @brief Finds the first occupied cell along a ray
+     *
+     * @param start World position in cm the ray starts from
+     * @param angle_rad World direction of the ray
+     * @param max_range_cm How far to look before giving up
+     */
+    RayHit cast(Vec2 start, float angle_rad, float max_range_cm) const;
+
+private:
+    const OccupancyGrid& grid;
+    const DistanceField& field;
+};
@@ -0,0 +1,81 @@
+/**
+ * @file scan.hpp
+ * @brief Poses, single range samples and whole servo sweeps.
+ *
+ * @details The arduino reports a degree from 1-181 and a distance in
+ * cm.  Here degree 90 points straight ahead of the scanner, so a
+ * sample at degree d from a scanner at pose (x, y, theta) travels
+ * along world angle theta + d (in radians).
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+struct Vec2 {
+    float x = 0;
+    float y = 0;
+};
+
+struct Pose2 {
+    float x = 0;      // cm
+    float y = 0;      // cm
+    float theta = 0;  // radians, added to the servo angle
+};
+
+struct RangeSample {
+    float angle_deg = 0;
+    float range_cm = 0;
+};
+
+struct Scan {
+    std::vector<RangeSample> samples;
+};
+
+/**
+ * @brief Groups the sample stream into sweeps
+ *
+ * @details The servo goes 1 -> 181 -> 1 over and over, so a sweep ends
+ * whenever the direction the degree is moving in flips.
+ */
+class SweepAssembler {
+public:
+    /**
+     * @brief Adds a sample, returns true once a sweep has been closed
+     *
+     * @details When true is returned the finished sweep is in
+     * completed() and the sample passed in starts the next one.
+     *
+     * @param sample The newest sample off the serial line
+     */
+    bool push(const RangeSample& sample){
+        bool finished = false;
+        if (!current.samples.empty()) {
+            const float delta = sample.angle_deg - current.samples.back().angle_deg;
+            const int step_direction = (delta > 0) - (delta < 0);
+            if (step_direction != 0 && direction != 0 && step_direction != direction) {
+                last.samples.swap(current.samples);
+                current.samples.clear();
+                finished = true;
+            }
+            if (step_direction != 0) {direction = step_direction;}
+        }
+        current.samples.push_back(sample);
+        return finished;
+    }
+
+    const Scan& completed() const { return last; }
+
+private:
+    Scan current;
+    Scan last;
+    int direction = 0;
+};
+
+inline float degreesToRadians(float degrees){
+    return degrees * float(M_PI / 180);
+}
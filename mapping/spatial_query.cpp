@@ -0,0 +1,90 @@
+/**
+ * @file spatial_query.cpp
+ * @brief Parallel batch loops for SpatialQueryEngine.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "spatial_query.hpp"
+#include "../util/thread_pool.hpp"
+
+#include <cmath>
+
+std::shared_ptr<const MapSnapshot> makeMapSnapshot(const OccupancyGrid& grid, ThreadPool* pool){
+    auto snapshot = std::make_shared<MapSnapshot>(grid);
+    snapshot->field.build(snapshot->grid, pool);
+    return snapshot;
+}
+
+SpatialQueryEngine::SpatialQueryEngine(ThreadPool& pool, size_t batch_grain)
+    : pool(pool), grain(batch_grain) {}
+
+void SpatialQueryEngine::setSnapshot(std::shared_ptr<const MapSnapshot> snapshot){
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    current = std::move(snapshot);
+}
+
+std::shared_ptr<const MapSnapshot> SpatialQueryEngine::snapshot() const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    return current;
+}
+
+void SpatialQueryEngine::nearestObstacle(const std::vector<Vec2>& points, std::vector<NearestObstacle>& results) const {
+    results.assign(points.size(), NearestObstacle());
+    const auto map = snapshot();
+    if (!map) {return;}
+    const OccupancyGrid& grid = map->grid;
+    const DistanceField& field = map->field;
+
+    pool.parallelFor(0, points.size(), grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            int cx, cy;
+            if (!grid.worldToCell(points[i].x, points[i].y, cx, cy)) {continue;}
+            const int32_t cell = field.nearestCell(cx, cy);
+            if (cell < 0) {continue;}
+            NearestObstacle& result = results[i];
+            result.found = true;
+            result.position = grid.cellCenter(cell % grid.width(), cell / grid.width());
+            result.distance_cm = std::hypot(result.position.x - points[i].x, result.position.y - points[i].y);
+        }
+    });
+}
+
+void SpatialQueryEngine::segmentFree(const std::vector<Segment>& segments, std::vector<uint8_t>& results) const {
+    results.assign(segments.size(), 0);
+    const auto map = snapshot();
+    if (!map) {return;}
+    const Raycaster raycaster(map->grid, map->field);
+
+    pool.parallelFor(0, segments.size(), grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const Segment& segment = segments[i];
+            // The map is a rectangle, so with both ends on it so is the
+            // rest.  The raycaster can't tell, its open-space jumps may
+            // carry it past the edge without stopping there.
+            int cx, cy;
+            if (!map->grid.worldToCell(segment.from.x, segment.from.y, cx, cy)
+                || !map->grid.worldToCell(segment.to.x, segment.to.y, cx, cy)) {continue;}
+            const float dx = segment.to.x - segment.from.x;
+            const float dy = segment.to.y - segment.from.y;
+            const float length = std::hypot(dx, dy);
+            const RayHit hit = raycaster.cast(segment.from, std::atan2(dy, dx), length);
+            // A miss that stopped short means the ray left the map
+            results[i] = !hit.hit && hit.range_cm >= length;
+        }
+    });
+}
+
+void SpatialQueryEngine::rangeAlongRay(const std::vector<Ray>& rays, std::vector<RayHit>& results) const {
+    results.assign(rays.size(), RayHit());
+    const auto map = snapshot();
+    if (!map) {return;}
+    const Raycaster raycaster(map->grid, map->field);
+
+    pool.parallelFor(0, rays.size(), grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            results[i] = raycaster.cast(rays[i].start, rays[i].angle_rad, rays[i].max_range_cm);
+        }
+    });
+}
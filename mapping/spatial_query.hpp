@@ -0,0 +1,91 @@
+/**
+ * @file spatial_query.hpp
+ * @brief Batched "nearest obstacle", "is segment free" and "range along
+ * ray" queries against a frozen copy of the map.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "distance_field.hpp"
+#include "occupancy_grid.hpp"
+#include "raycaster.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @brief Read-only map plus the acceleration data the queries need
+ *
+ * @details Built once from the live grid and then never touched, so any
+ * number of threads can query it while mapping carries on.
+ */
+struct MapSnapshot {
+    explicit MapSnapshot(const OccupancyGrid& grid) : grid(grid) {}
+
+    OccupancyGrid grid;
+    DistanceField field;
+};
+
+/**
+ * @brief Copies the grid and builds its distance field
+ *
+ * @param grid The live map
+ * @param pool Optional pool for the distance transform
+ */
+std::shared_ptr<const MapSnapshot> makeMapSnapshot(const OccupancyGrid& grid, ThreadPool* pool = nullptr);
+
+struct NearestObstacle {
+    bool found = false;
+    float distance_cm = 0;
+    Vec2 position;   // center of the closest occupied cell
+};
+
+struct Segment {
+    Vec2 from;
+    Vec2 to;
+};
+
+struct Ray {
+    Vec2 start;
+    float angle_rad = 0;
+    float max_range_cm = 0;
+};
+
+/**
+ * @brief Answers query batches in parallel on a thread pool
+ *
+ * @details Every batch grabs the current snapshot once at the start, so
+ * a batch always sees one consistent map even if setSnapshot() is
+ * called partway through.  Results are written in the same order as the
+ * queries.
+ */
+class SpatialQueryEngine {
+public:
+    explicit SpatialQueryEngine(ThreadPool& pool, size_t batch_grain = 256);
+
+    void setSnapshot(std::shared_ptr<const MapSnapshot> snapshot);
+    std::shared_ptr<const MapSnapshot> snapshot() const;
+
+    void nearestObstacle(const std::vector<Vec2>& points, std::vector<NearestObstacle>& results) const;
+    /**
+     * @brief 1 for each segment with no occupied cell along it
+     *
+     * @details Unknown cells count as free, the map only knows about
+     * walls it has seen.  A segment that starts outside the map or
+     * leaves it is not free, since nothing is known past the edge.
+     */
+    void segmentFree(const std::vector<Segment>& segments, std::vector<uint8_t>& results) const;
+    void rangeAlongRay(const std::vector<Ray>& rays, std::vector<RayHit>& results) const;
+
+private:
+    ThreadPool& pool;
+    size_t grain;
+    mutable std::mutex snapshot_mutex;
+    std::shared_ptr<const MapSnapshot> current;
+};
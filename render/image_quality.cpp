@@ -0,0 +1,110 @@
+/**
+ * @file image_quality.cpp
+ * @brief PSNR and windowed SSIM on raw pixel buffers.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "image_quality.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+const int window_radius = 5;
+const double window_sigma = 1.5;
+
+/**
+ * @brief Separable Gaussian blur of one float plane, borders clamped
+ */
+void gaussianBlur(const std::vector<double>& in, std::vector<double>& out, int width, int height,
+                  const std::vector<double>& kernel){
+    std::vector<double> rows(in.size());
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            double sum = 0;
+            for (int k = -window_radius; k <= window_radius; k++) {
+                const int sx = std::clamp(x + k, 0, width - 1);
+                sum += kernel[k + window_radius] * in[size_t(y) * width + sx];
+            }
+            rows[size_t(y) * width + x] = sum;
+        }
+    }
+    out.resize(in.size());
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            double sum = 0;
+            for (int k = -window_radius; k <= window_radius; k++) {
+                const int sy = std::clamp(y + k, 0, height - 1);
+                sum += kernel[k + window_radius] * rows[size_t(sy) * width + x];
+            }
+            out[size_t(y) * width + x] = sum;
+        }
+    }
+}
+
+} // namespace
+
+double psnr(const ImageView& a, const ImageView& b){
+    double squared_error = 0;
+    for (int y = 0; y < a.height; y++) {
+        const uint8_t* row_a = a.data + y * a.stride;
+        const uint8_t* row_b = b.data + y * b.stride;
+        for (int i = 0; i < a.width * a.channels; i++) {
+            const double diff = double(row_a[i]) - row_b[i];
+            squared_error += diff * diff;
+        }
+    }
+    if (squared_error == 0) {return std::numeric_limits<double>::infinity();}
+    const double mse = squared_error / (double(a.width) * a.height * a.channels);
+    return 10 * std::log10(255.0 * 255.0 / mse);
+}
+
+double ssim(const ImageView& a, const ImageView& b){
+    const double c1 = (0.01 * 255) * (0.01 * 255);
+    const double c2 = (0.03 * 255) * (0.03 * 255);
+    std::vector<double> kernel(2 * window_radius + 1);
+    double kernel_sum = 0;
+    for (int k = -window_radius; k <= window_radius; k++) {
+        kernel[k + window_radius] = std::exp(-k * k / (2 * window_sigma * window_sigma));
+        kernel_sum += kernel[k + window_radius];
+    }
+    for (double& weight : kernel) {weight /= kernel_sum;}
+
+    const size_t pixels = size_t(a.width) * a.height;
+    std::vector<double> x(pixels), y(pixels), xx(pixels), yy(pixels), xy(pixels);
+    std::vector<double> mu_x, mu_y, mu_xx, mu_yy, mu_xy;
+    double total = 0;
+    for (int channel = 0; channel < a.channels; channel++) {
+        for (int row = 0; row < a.height; row++) {
+            for (int col = 0; col < a.width; col++) {
+                const size_t i = size_t(row) * a.width + col;
+                x[i] = a.data[row * a.stride + size_t(col) * a.channels + channel];
+                y[i] = b.data[row * b.stride + size_t(col) * b.channels + channel];
+                xx[i] = x[i] * x[i];
+                yy[i] = y[i] * y[i];
+                xy[i] = x[i] * y[i];
+            }
+        }
+        gaussianBlur(x, mu_x, a.width, a.height, kernel);
+        gaussianBlur(y, mu_y, a.width, a.height, kernel);
+        gaussianBlur(xx, mu_xx, a.width, a.height, kernel);
+        gaussianBlur(yy, mu_yy, a.width, a.height, kernel);
+        gaussianBlur(xy, mu_xy, a.width, a.height, kernel);
+
+        double channel_sum = 0;
+        for (size_t i = 0; i < pixels; i++) {
+            const double var_x = mu_xx[i] - mu_x[i] * mu_x[i];
+            const double var_y = mu_yy[i] - mu_y[i] * mu_y[i];
+            const double covariance = mu_xy[i] - mu_x[i] * mu_y[i];
+            channel_sum += (2 * mu_x[i] * mu_y[i] + c1) * (2 * covariance + c2)
+                         / ((mu_x[i] * mu_x[i] + mu_y[i] * mu_y[i] + c1) * (var_x + var_y + c2));
+        }
+        total += channel_sum / pixels;
+    }
+    return a.channels > 0 ? total / a.channels : 1;
+}
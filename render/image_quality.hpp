@@ -0,0 +1,42 @@
+/**
+ * @file image_quality.hpp
+ * @brief PSNR and SSIM between two 8-bit images, for checking that a
+ * faster render path still draws the same picture.
+ *
+ * @details Works on plain pixel buffers so it needs no opencv; a cv::Mat
+ * passes its data, cols, rows, step and channels().
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Interleaved 8-bit pixels, stride in bytes between rows
+ */
+struct ImageView {
+    const uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    size_t stride = 0;
+    int channels = 1;
+};
+
+/**
+ * @brief Peak signal-to-noise ratio in dB over every channel, infinity
+ * for identical images
+ */
+double psnr(const ImageView& a, const ImageView& b);
+
+/**
+ * @brief Structural similarity, 1 for identical images, averaged over
+ * the channels
+ *
+ * @details The usual definition (Wang et al. 2004): 11x11 Gaussian
+ * window with sigma 1.5, K1 0.01, K2 0.03, borders clamped.
+ */
+double ssim(const ImageView& a, const ImageView& b);
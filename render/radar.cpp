@@ -0,0 +1,153 @@
+/**
+ * @file radar.cpp
+ * @brief Radar drawing, coverage tint and upscaled display.
+ *
+ * @author Vladimir Herdman
+ * @date 2024-11-29
+ * @version 0.5.0
+ */
+#include "radar.hpp"
+#include "../util/trace.hpp"
+
+#include <cmath>
+#include <string>
+
+std::deque<std::pair<int, int>> line_deque;
+
+namespace {
+
+// Upscaled copy that actually goes on screen
+cv::Mat larger_frame = cv::Mat::zeros(size*scale, CV_8UC3);
+
+// drawRadar's output, drawn once for updateRadarCached
+cv::Mat radar_template;
+
+/**
+ * @brief Everything updateRadar draws over the blank radar
+ */
+void drawSweep(cv::Mat& frame, const int degree, const int distanceCM, const CoverageMap* coverage){
+    if (coverage){drawCoverageOverlay(frame, *coverage);}
+    line_deque.push_front(std::make_pair(degree, distanceCM));
+
+    if (line_deque.size() > 40){line_deque.pop_back();}
+    
+    // Draw lines and red blips (fade as get farther back)
+    int color_change = 0;
+    for (auto line : line_deque){
+        // line.first: angle | line.second: range detected
+        color_change += 5;
+        drawLineAtAngle(frame, circle_center, line.first, 100, cv::Scalar(0, 200-color_change, 0), false);
+        if (line.second < 50 and line.second > 2){
+            cv::circle(frame, calculate_circle_point(line.first, line.second*2), 3, cv::Scalar(0, 8, 255-color_change*1.4), -1);
+        }
+    }
+
+    // Add data to bottom square area
+    cv::putText(frame, std::to_string(degree), cv::Point(angle_display.x+55, angle_display.y), fontFace, 0.8, green);
+    if (distanceCM < 50){
+        cv::putText(frame, std::to_string(distanceCM)+" cm", cv::Point(distance_display.x+65, distance_display.y), fontFace, 0.8, green);
+    } else{
+        cv::putText(frame, "Nothing", cv::Point(distance_display.x+65, distance_display.y), fontFace, 0.8, green);
+    }
+}
+
+} // namespace
+
+void drawLineAtAngle(cv::Mat& frame, cv::Point start, int angle, int length, cv::Scalar color, const bool with_text) {
+    const double angle_radians = (angle * (M_PI / 180));
+
+    // Section for line
+    int end_x = start.x + cos(angle_radians) * length;
+    int end_y = start.y - sin(angle_radians) * length;
+    cv::line(frame, start, cv::Point(end_x, end_y), color);
+
+    // Section for text
+    end_x = start.x + cos(angle_radians) * (length+3);
+    end_y = start.y - sin(angle_radians) * (length+3);
+    if (angle >= 90) {end_x -= 8;}
+    if (with_text){
+        cv::putText(frame, std::to_string(angle), cv::Point(end_x, end_y), fontFace, fontScale, green);
+    }
+}
+
+cv::Point calculate_circle_point(const int angle, const int length){
+    const double angle_radians = (angle * (M_PI / 180));
+    const int end_x = circle_center.x + cos(angle_radians) * length;
+    const int end_y = circle_center.y - sin(angle_radians) * length;
+    return cv::Point(end_x, end_y);
+}
+
+void drawCoverageOverlay(cv::Mat& frame, const CoverageMap& coverage){
+    const float pixels_per_cm = 2.0f;
+    const cv::Vec3b tint = {200, 120, 0};
+    for (int py = 0; py < height - 21; py++) {
+        cv::Vec3b* row = frame.ptr<cv::Vec3b>(py);
+        const float world_y = (circle_center.y - py) / pixels_per_cm;
+        const int cy = int(std::floor((world_y - coverage.origin().y) / coverage.resolution()));
+        if (cy < 0 || cy >= coverage.height()) {continue;}
+        for (int px = 0; px < width; px++) {
+            const float world_x = (px - circle_center.x) / pixels_per_cm;
+            const int cx = int(std::floor((world_x - coverage.origin().x) / coverage.resolution()));
+            if (cx < 0 || cx >= coverage.width()) {continue;}
+            const uint16_t seen = coverage.observations(cx, cy);
+            if (seen == 0) {continue;}
+            const float alpha = 0.15f + 0.35f * std::min<uint16_t>(seen, 10) / 10.0f;
+            for (int channel = 0; channel < 3; channel++) {
+                row[px][channel] = uint8_t(row[px][channel] * (1 - alpha) + tint[channel] * alpha);
+            }
+        }
+    }
+}
+
+void showRadar(const cv::Mat& frame){
+    {
+        TRACE_SCOPE("resize");
+        cv::resize(frame, larger_frame, larger_frame.size(), 0, 0, cv::INTER_CUBIC);
+    }
+    TRACE_SCOPE("imshow");
+    cv::imshow("Radar", larger_frame);
+    cv::waitKey(1);
+}
+
+void drawRadar(cv::Mat& frame){
+    TRACE_SCOPE("drawRadar");
+    // Base frames
+    frame = cv::Mat::zeros(size, CV_8UC3);
+    frame.setTo(background);
+
+    // Circles
+    cv::circle(frame, circle_center, 3, green, -1);
+    for (int radius = 1; radius < 6; radius++){
+        cv::circle(frame, circle_center, radius*20, green);
+    }
+    
+    // Angle lines
+    for (int angle = 1; angle < 6; angle++) {
+        drawLineAtAngle(frame, circle_center, angle*30, 104, green, true);
+    }
+    
+    // Bottom info section
+    cv::line(frame, cv::Point(0, height-21), cv::Point(width, height-21), green);
+    cv::rectangle(frame, cv::Point(0, height-20), cv::Point(width, height), cv::Scalar(15, 15, 15), -1);
+    cv::putText(frame, "Degree: ", angle_display, fontFace, 0.8, green);
+    cv::putText(frame, "Distance: ", distance_display, fontFace, 0.8, green);
+
+    // Text for circles (ranges)
+    for (int radius = 1; radius < 6; radius++){
+        cv::putText(frame, std::to_string(radius*10), cv::Point(width/2+radius*20-5, height-17), fontFace, 0.5, green);
+    }
+
+}
+
+void updateRadar(cv::Mat& frame, const int degree, const int distanceCM, const CoverageMap* coverage){
+    TRACE_SCOPE("updateRadar");
+    drawRadar(frame);
+    drawSweep(frame, degree, distanceCM, coverage);
+}
+
+void updateRadarCached(cv::Mat& frame, const int degree, const int distanceCM, const CoverageMap* coverage){
+    TRACE_SCOPE("updateRadarCached");
+    if (radar_template.empty()){drawRadar(radar_template);}
+    radar_template.copyTo(frame);
+    drawSweep(frame, degree, distanceCM, coverage);
+}
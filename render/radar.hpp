@@ -0,0 +1,125 @@
+/**
+ * @file radar.hpp
+ * @brief Draws the radar view and puts it on screen.
+ *
+ * @details Everything opencv touches lives here, so the rest of the
+ * program (and the benchmarks) can drive the drawing directly.
+ *
+ * @author Vladimir Herdman
+ * @date 2024-11-29
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <deque>
+#include <utility>
+
+#include "../mapping/coverage_map.hpp"
+
+// Radar layout, in pixels before the upscale
+const int width = 240;  // Go out five rings to measure 50 cm and 10 extra as padding
+const int height = 140;  // Go out radius of largest ring (50) and 20 more for top/bottom padding/text
+const cv::Size size(width, height);
+const int scale = 3;
+const cv::Point circle_center(width/2, height - 20);
+
+const cv::Scalar green(0, 180, 0);
+const cv::Scalar background(30, 30, 30);
+
+const int fontFace = cv::FONT_HERSHEY_PLAIN;
+const double fontScale = 0.5;
+const cv::Point angle_display(5, height-5);
+const cv::Point distance_display(width/2-20, height-5);
+
+// Most recent (degree, distance) lines, newest first, faded as they age
+extern std::deque<std::pair<int, int>> line_deque;
+
+/**
+ * @brief Draws lines and text at an angle
+ * 
+ * @details This function takes a frame and a length to draw from a starting
+ * point at an angle, and then does so to the specified frame.
+ * 
+ * @param frame The cv::Mat to draw on
+ * @param start The starting cv::Point the line will begin at
+ * @param angle The degrees from 0-180 to have the line point
+ * @param length The length of the line once drawn
+ * @param color The color of the line
+ * @param with_text To put the angle the line is at past the line when drawn
+ */
+void drawLineAtAngle(cv::Mat& frame, cv::Point start, int angle, int length, cv::Scalar color, const bool with_text);
+
+/**
+ * @brief Calculates the point for a screen blip off detected distance
+ * 
+ * @details This function acts similarly to the above line drawing
+ * function, except it doesn't draw on the frame, it just returns the
+ * calculated point of where the circle should be.
+ * 
+ * @param angle The degrees from 0-180 the object was detected
+ * @param length The distance at which something was detected
+ */
+cv::Point calculate_circle_point(const int angle, const int length);
+
+/**
+ * @brief Tints the radar by how often each spot has been observed
+ *
+ * @details Every radar pixel above the info bar is mapped back to its
+ * coverage cell (the radar draws 2 pixels per cm), and cells seen more
+ * often get a stronger blue tint, saturating at 10 observations.
+ *
+ * @param frame The radar cv::Mat to draw on
+ * @param coverage The coverage layer to show
+ */
+void drawCoverageOverlay(cv::Mat& frame, const CoverageMap& coverage);
+
+/**
+ * @brief Upscales a radar frame and puts it on screen
+ *
+ * @details Kept apart from the drawing so replays and benchmarks can run
+ * the whole pipeline without a window (--headless).
+ *
+ * @param frame The radar cv::Mat to show
+ */
+void showRadar(const cv::Mat& frame);
+
+/**
+ * @brief Sets up the initial radar used throughout the code
+ * 
+ * @details Specifically, drawRadar takes a given frame and creates a
+ * pre-built template for how the radar will look, this radar then
+ * updated throughout the arduino data collection process.
+ * 
+ * @param frame The cv::Mat to draw on
+ */
+void drawRadar(cv::Mat& frame);
+
+/**
+ * @brief Updates frame with new line and removes old ones.
+ * 
+ * @details This function draws on a frame the new line based off the
+ * degree, and uses the distance to add in a red line for a detected
+ * object.  After an amount of lines, the old ones are faded out. A
+ * copy of the frame is used so as to simplify the drawing process and
+ * start with a blank slate each time.
+ * 
+ * @param frame The cv::Mat to draw on, not a reference
+ * @param degree The angle to draw a line at
+ * @param distanceCM The distance at which something was detected
+ * @param coverage Coverage layer to tint the radar with, if any
+ */
+void updateRadar(cv::Mat& frame, const int degree, const int distanceCM, const CoverageMap* coverage = nullptr);
+
+/**
+ * @brief Same frame as updateRadar, copied from a template drawn once
+ * instead of redrawing the rings, angle lines and labels every time
+ *
+ * @details tools/render_check compares the two frame by frame.
+ *
+ * @param frame The cv::Mat to draw on
+ * @param degree The angle to draw a line at
+ * @param distanceCM The distance at which something was detected
+ * @param coverage Coverage layer to tint the radar with, if any
+ */
+void updateRadarCached(cv::Mat& frame, const int degree, const int distanceCM, const CoverageMap* coverage = nullptr);
@@ -0,0 +1,195 @@
+/**
+ * @file async_file_writer.cpp
+ * @brief Writer thread, buffer swapping and fsync policy.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "async_file_writer.hpp"
+#include "../util/trace.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief fdatasync where there is one, it skips the metadata update
+ */
+void syncData(int fd){
+#ifdef __linux__
+    fdatasync(fd);
+#else
+    fsync(fd);
+#endif
+}
+
+}  // namespace
+
+bool parseFsyncPolicy(const std::string& text, FsyncPolicy& policy){
+    if (text == "never") {
+        policy.mode = FsyncMode::Never;
+    } else if (text == "always") {
+        policy.mode = FsyncMode::Always;
+    } else {
+        char* end = nullptr;
+        const long milliseconds = std::strtol(text.c_str(), &end, 10);
+        if (text.empty() || *end != '\0' || milliseconds <= 0) {return false;}
+        policy.mode = FsyncMode::Interval;
+        policy.interval = std::chrono::milliseconds(milliseconds);
+    }
+    return true;
+}
+
+AsyncFileWriter::AsyncFileWriter(size_t buffer_bytes, size_t max_pending_bytes, std::chrono::milliseconds flush_after)
+    : buffer_bytes(buffer_bytes), max_pending_bytes(max_pending_bytes), flush_after(flush_after) {}
+
+AsyncFileWriter::~AsyncFileWriter(){
+    close();
+}
+
+bool AsyncFileWriter::open(const std::string& path, FsyncPolicy fsync_policy){
+    if (isOpen()) {close();}
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0644);
+    if (fd == -1) {
+        std::cerr << "Error creating " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    policy = fsync_policy;
+    active.reserve(buffer_bytes);
+    writing.reserve(buffer_bytes);
+    stopping = false;
+    writer = std::thread([this]() { writerLoop(); });
+    return true;
+}
+
+void AsyncFileWriter::close(){
+    if (!isOpen()) {return;}
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        stopping = true;
+    }
+    wake_writer.notify_one();
+    writer.join();
+    ::close(fd);
+    fd = -1;
+}
+
+bool AsyncFileWriter::append(const void* first, size_t first_bytes, const void* second, size_t second_bytes){
+    const size_t total = first_bytes + second_bytes;
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        if (fd < 0 || failed.load(std::memory_order_relaxed) || active.size() + total > max_pending_bytes) {
+            bytes_dropped += total;
+            return false;
+        }
+        const char* first_bytes_ptr = static_cast<const char*>(first);
+        active.insert(active.end(), first_bytes_ptr, first_bytes_ptr + first_bytes);
+        if (second_bytes) {
+            const char* second_bytes_ptr = static_cast<const char*>(second);
+            active.insert(active.end(), second_bytes_ptr, second_bytes_ptr + second_bytes);
+        }
+        pending_bytes.store(active.size(), std::memory_order_relaxed);
+        // Only wake the writer once per full buffer, not once per append
+        wake = active.size() >= buffer_bytes && active.size() - total < buffer_bytes;
+    }
+    if (wake) {wake_writer.notify_one();}
+    return true;
+}
+
+void AsyncFileWriter::flush(){
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        flush_requested = true;
+    }
+    wake_writer.notify_one();
+}
+
+WriterStats AsyncFileWriter::stats() const {
+    WriterStats stats;
+    stats.bytes_written = bytes_written;
+    stats.bytes_dropped = bytes_dropped;
+    stats.writes = write_calls;
+    stats.fsyncs = fsync_calls;
+    stats.pending_bytes = pending_bytes.load(std::memory_order_relaxed);
+    stats.failed = failed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t AsyncFileWriter::writeAll(const char* bytes, size_t count){
+    size_t done = 0;
+    while (done < count) {
+        const ssize_t written = ::write(fd, bytes + done, count - done);
+        if (written < 0) {
+            if (errno == EINTR) {continue;}
+            std::cerr << "Error writing session data: " << strerror(errno) << std::endl;
+            return done;
+        }
+        done += size_t(written);
+        bytes_written += uint64_t(written);
+    }
+    write_calls++;
+    return done;
+}
+
+void AsyncFileWriter::writerLoop(){
+    setTraceThreadName("file writer");
+    auto last_sync = std::chrono::steady_clock::now();
+    bool unsynced = false;
+    while (true) {
+        bool finished;
+        {
+            std::unique_lock<std::mutex> lock(buffer_mutex);
+            wake_writer.wait_for(lock, flush_after, [this]() {
+                return stopping || flush_requested || active.size() >= buffer_bytes;
+            });
+            finished = stopping;
+            flush_requested = false;
+            active.swap(writing);
+            pending_bytes.store(0, std::memory_order_relaxed);
+        }
+
+        if (!writing.empty() && failed.load(std::memory_order_relaxed)) {
+            bytes_dropped += writing.size();
+            writing.clear();
+        } else if (!writing.empty()) {
+            TRACE_SCOPE("file write");
+            // The file only ever grows by our writes, so this is where the
+            // batch starts
+            const uint64_t batch_start = bytes_written;
+            const size_t written = writeAll(writing.data(), writing.size());
+            if (written < writing.size()) {
+                // Take the torn batch back out, a record cut in half would
+                // misalign everything a reader finds after it
+                if (written > 0 && ftruncate(fd, off_t(batch_start)) != 0) {
+                    std::cerr << "Error cutting off a partly written batch: " << strerror(errno) << std::endl;
+                }
+                bytes_written -= written;
+                bytes_dropped += writing.size();
+                failed.store(true, std::memory_order_relaxed);
+                std::cerr << "Stopped writing after a failed write, later data is dropped" << std::endl;
+            }
+            writing.clear();
+            unsynced = true;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const bool sync_due = policy.mode == FsyncMode::Always ||
+                              (policy.mode == FsyncMode::Interval && now - last_sync >= policy.interval);
+        if (unsynced && (sync_due || (finished && policy.mode != FsyncMode::Never))) {
+            TRACE_SCOPE("fsync");
+            syncData(fd);
+            fsync_calls++;
+            last_sync = now;
+            unsynced = false;
+        }
+        if (finished) {return;}
+    }
+}
@@ -0,0 +1,140 @@
+/**
+ * @file async_file_writer.hpp
+ * @brief Append-only file writer that does its I/O on its own thread.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class FsyncMode {
+    Never,      // leave it to the kernel
+    Interval,   // at most once per interval
+    Always,     // after every write the writer thread makes
+};
+
+struct FsyncPolicy {
+    FsyncMode mode = FsyncMode::Interval;
+    std::chrono::milliseconds interval{1000};
+};
+
+/**
+ * @brief Reads "never", "always" or a number of milliseconds
+ *
+ * @param text The command line value
+ * @param policy Set when the text is valid
+ */
+bool parseFsyncPolicy(const std::string& text, FsyncPolicy& policy);
+
+struct WriterStats {
+    uint64_t bytes_written = 0;
+    uint64_t bytes_dropped = 0;   // refused because the backlog was full, or lost to a failed write
+    uint64_t writes = 0;
+    uint64_t fsyncs = 0;
+    size_t pending_bytes = 0;     // appended but not yet handed to write()
+    bool failed = false;          // a write failed, nothing more goes to the file
+};
+
+/**
+ * @brief Buffers appends in memory and writes them out in big chunks
+ *
+ * @details append() only copies into the active buffer under a short
+ * lock, so the caller never waits on the disk.  The writer thread swaps
+ * the buffer out when it passes buffer_bytes or flush_after has gone by
+ * and writes the whole thing with one write() call.  If the disk falls
+ * so far behind that max_pending_bytes are waiting, appends are dropped
+ * and counted instead of blocking or growing memory without bound.
+ *
+ * A failed write() (a full disk, an I/O error) cuts the file back to
+ * where that batch started, so it never ends in a torn record, and marks
+ * the writer failed: everything after is dropped, appends are refused,
+ * and callers keeping file offsets (SessionRecorder's index) stay right
+ * about what's in the file.
+ */
+class AsyncFileWriter {
+public:
+    AsyncFileWriter(size_t buffer_bytes = size_t(1) << 20, size_t max_pending_bytes = size_t(64) << 20,
+                    std::chrono::milliseconds flush_after = std::chrono::milliseconds(50));
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    /**
+     * @brief Creates the file and starts the writer thread
+     *
+     * @param path File to create, must not exist yet
+     * @param policy When to fsync
+     */
+    bool open(const std::string& path, FsyncPolicy policy);
+
+    /**
+     * @brief Writes out everything pending, syncs and closes the file
+     */
+    void close();
+
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * @brief Queues bytes to be written, false if they were dropped
+     * (backlog full or writer failed)
+     *
+     * @details The two parts go into the buffer together, so a record
+     * header and its payload can't be split by a buffer swap.
+     *
+     * @param first First part
+     * @param first_bytes Size of the first part
+     * @param second Optional second part
+     * @param second_bytes Size of the second part
+     */
+    bool append(const void* first, size_t first_bytes, const void* second = nullptr, size_t second_bytes = 0);
+
+    /**
+     * @brief Asks the writer thread to write what's buffered right away
+     */
+    void flush();
+
+    /**
+     * @brief Counters so far, read from atomics without taking the
+     * buffer lock, so any thread can poll them
+     */
+    WriterStats stats() const;
+
+private:
+    void writerLoop();
+    // Bytes actually written, less than count when write() failed
+    size_t writeAll(const char* bytes, size_t count);
+
+    const size_t buffer_bytes;
+    const size_t max_pending_bytes;
+    const std::chrono::milliseconds flush_after;
+
+    int fd = -1;
+    FsyncPolicy policy;
+    std::thread writer;
+
+    mutable std::mutex buffer_mutex;
+    std::condition_variable wake_writer;
+    std::vector<char> active;    // appended to by callers
+    std::vector<char> writing;   // owned by the writer thread while it writes
+    bool flush_requested = false;
+    bool stopping = false;
+
+    std::atomic<uint64_t> bytes_written{0};
+    std::atomic<uint64_t> bytes_dropped{0};
+    std::atomic<uint64_t> write_calls{0};
+    std::atomic<uint64_t> fsync_calls{0};
+    std::atomic<size_t> pending_bytes{0};  // mirrors active.size() so stats() needn't lock
+    std::atomic<bool> failed{false};
+};
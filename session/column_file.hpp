@@ -0,0 +1,47 @@
+/**
+ * @file column_file.hpp
+ * @brief On-disk layout of exported sample columns.
+ *
+ * @details An exported session is a directory with one file per column
+ * (timestamp_ns, sensor, degree, distance_cm).  Each file is a 64-byte
+ * ColumnFileHeader followed by row_count values of one type packed end
+ * to end, so a column loads with a single mmap and the values start
+ * 64-byte aligned.  Row i of every column belongs to the same sample.
+ * From numpy for example:
+ *
+ *     np.memmap("degree.col", dtype="<i4", mode="r", offset=64)
+ *
+ * Everything is little-endian.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <cstdint>
+
+const char column_file_magic[4] = {'U', 'S', 'C', 'O'};
+const uint16_t column_file_version = 1;
+
+enum class ColumnType : uint8_t {
+    UInt16 = 1,
+    Int32 = 2,
+    UInt64 = 3,
+};
+
+struct ColumnFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t header_bytes;      // where the values start
+    uint8_t type;               // a ColumnType
+    uint8_t element_bytes;
+    uint16_t reserved;
+    uint32_t reserved2;
+    uint64_t row_count;
+    uint64_t start_steady_ns;   // copied from the session's header
+    int64_t start_unix_ns;
+    char name[24];              // column name, zero padded
+};
+
+static_assert(sizeof(ColumnFileHeader) == 64, "column header layout changed");
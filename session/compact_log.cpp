@@ -0,0 +1,313 @@
+/**
+ * @file compact_log.cpp
+ * @brief Varint block encoding, decoding and file handling for compact logs.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "compact_log.hpp"
+#include "../util/crc32.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Bytes of the block header the checksums cover, everything before crc
+// for the block's and everything before header_crc for the header's own
+const size_t checked_header_bytes = offsetof(CompactBlockHeader, crc);
+const size_t header_crc_bytes = offsetof(CompactBlockHeader, header_crc);
+
+inline uint64_t zigzag(int64_t value){
+    return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value){
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+inline void putVarint(std::vector<uint8_t>& out, uint64_t value){
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+/**
+ * @brief Reads one varint, false if it runs off the end or is too long
+ *
+ * @details Nearly every value is a single byte, so that case is checked
+ * first and the loop is only for the rest.
+ */
+inline bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value){
+    if (p < end && *p < 0x80) {
+        value = *p++;
+        return true;
+    }
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const uint8_t byte = *p++;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (byte < 0x80) {return true;}
+    }
+    return false;
+}
+
+uint32_t blockCrc(const CompactBlockHeader& header, const uint8_t* payload){
+    const uint32_t crc = crc32c(payload, header.payload_bytes);
+    return crc32c(&header, checked_header_bytes, crc);
+}
+
+/**
+ * @brief First offset after from holding the sync word, or end
+ */
+size_t findSync(const uint8_t* data, size_t from, size_t end){
+    while (from + sizeof(uint32_t) <= end) {
+        uint32_t sync;
+        std::memcpy(&sync, data + from, sizeof(sync));
+        if (sync == compact_block_sync) {return from;}
+        from++;
+    }
+    return end;
+}
+
+} // namespace
+
+bool checkBlockHeader(const CompactBlockHeader& header){
+    // Every sample takes at least three bytes
+    return header.sync == compact_block_sync && header.header_crc == crc32c(&header, header_crc_bytes)
+        && uint64_t(header.sample_count) * 3 <= header.payload_bytes;
+}
+
+void CompactBlockEncoder::reset(uint16_t sensor, uint64_t base_timestamp){
+    payload.clear();
+    block_sensor = sensor;
+    sample_count = 0;
+    base_timestamp_ns = base_timestamp;
+    previous_timestamp_ns = base_timestamp;
+    previous_degree = 0;
+    previous_distance = 0;
+}
+
+void CompactBlockEncoder::add(uint64_t timestamp_ns, int32_t degree, int32_t distance_cm){
+    putVarint(payload, zigzag(int64_t(timestamp_ns - previous_timestamp_ns)));
+    putVarint(payload, zigzag(int64_t(degree) - previous_degree));
+    putVarint(payload, zigzag(int64_t(distance_cm) - previous_distance));
+    previous_timestamp_ns = timestamp_ns;
+    previous_degree = degree;
+    previous_distance = distance_cm;
+    sample_count++;
+}
+
+void CompactBlockEncoder::finish(std::vector<uint8_t>& out) const {
+    CompactBlockHeader header{compact_block_sync, block_sensor, 0, sample_count,
+                              uint32_t(payload.size()), base_timestamp_ns, 0, 0};
+    header.crc = blockCrc(header, payload.data());
+    header.header_crc = crc32c(&header, header_crc_bytes);
+    const size_t start = out.size();
+    out.resize(start + sizeof(header) + payload.size());
+    std::memcpy(out.data() + start, &header, sizeof(header));
+    std::memcpy(out.data() + start + sizeof(header), payload.data(), payload.size());
+}
+
+BlockStatus decodeCompactBlock(const uint8_t* data, size_t available,
+                               std::vector<CompactSample>& samples, CompactBlockHeader& header){
+    if (available < sizeof(header)) {return BlockStatus::Truncated;}
+    std::memcpy(&header, data, sizeof(header));
+    if (!checkBlockHeader(header)) {return BlockStatus::Corrupt;}
+    if (header.payload_bytes > available - sizeof(header)) {return BlockStatus::Truncated;}
+
+    const uint8_t* p = data + sizeof(header);
+    const uint8_t* end = p + header.payload_bytes;
+    if (blockCrc(header, p) != header.crc) {return BlockStatus::Corrupt;}
+
+    samples.resize(header.sample_count);
+    uint64_t timestamp_ns = header.base_timestamp_ns;
+    int64_t degree = 0, distance = 0;
+    for (CompactSample& sample : samples) {
+        uint64_t dt, ddegree, ddistance;
+        if (!getVarint(p, end, dt) || !getVarint(p, end, ddegree) || !getVarint(p, end, ddistance)) {
+            return BlockStatus::Corrupt;
+        }
+        timestamp_ns += uint64_t(unzigzag(dt));
+        degree += unzigzag(ddegree);
+        distance += unzigzag(ddistance);
+        sample = CompactSample{timestamp_ns, int32_t(degree), int32_t(distance)};
+    }
+    return p == end ? BlockStatus::Ok : BlockStatus::Corrupt;
+}
+
+CompactLogWriter::CompactLogWriter(size_t block_samples, std::chrono::milliseconds block_interval)
+    : block_samples(block_samples),
+      block_interval_ns(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(block_interval).count())) {}
+
+bool CompactLogWriter::open(const std::string& path, FsyncPolicy policy, SessionStart start){
+    if (!writer.open(path, policy)) {return false;}
+
+    SessionFileHeader header;
+    std::memcpy(header.magic, compact_log_magic, sizeof(header.magic));
+    header.version = compact_log_version;
+    header.header_bytes = sizeof(SessionFileHeader);
+    header.start_steady_ns = start.steady_ns;
+    header.start_unix_ns = start.unix_ns;
+    writer.append(&header, sizeof(header));
+    encoder.reset(0, header.start_steady_ns);
+    return true;
+}
+
+void CompactLogWriter::close(){
+    if (!isOpen()) {return;}
+    flushBlock();
+    writer.close();
+}
+
+void CompactLogWriter::append(uint64_t timestamp_ns, const ParsedSample& sample, uint16_t sensor){
+    if (encoder.samples() > 0 && (sensor != encoder.sensor() || encoder.samples() >= block_samples
+                                  || timestamp_ns - encoder.baseTimestamp() >= block_interval_ns)) {
+        flushBlock();
+    }
+    if (encoder.samples() == 0) {
+        encoder.reset(sensor, timestamp_ns);
+        block_opened_ns = monotonicNanoseconds();
+    }
+    encoder.add(timestamp_ns, sample.degree, sample.distance_cm);
+}
+
+void CompactLogWriter::flushBlock(){
+    if (encoder.samples() == 0) {return;}
+    block.clear();
+    encoder.finish(block);
+    writer.append(block.data(), block.size());
+    // Blocks are the unit readers following the log wait for, so hand
+    // each one to the disk now rather than on the writer's next timeout
+    writer.flush();
+    encoder.reset(encoder.sensor(), encoder.baseTimestamp());
+}
+
+void CompactLogWriter::flushIfDue(uint64_t now_ns){
+    if (encoder.samples() > 0 && now_ns >= block_opened_ns + block_interval_ns) {flushBlock();}
+}
+
+CompactLogReader::~CompactLogReader(){
+    close();
+}
+
+bool CompactLogReader::open(const std::string& path){
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error opening compact log: " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(SessionFileHeader)) {
+        std::cerr << "Not a compact log: " << path << std::endl;
+        close();
+        return false;
+    }
+    file_bytes = size_t(info.st_size);
+    void* mapped = mmap(nullptr, file_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error mapping compact log: " << path << ": " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    mapping = static_cast<const uint8_t*>(mapped);
+    madvise(mapped, file_bytes, MADV_SEQUENTIAL);
+
+    std::memcpy(&file_header, mapping, sizeof(file_header));
+    if (std::memcmp(file_header.magic, compact_log_magic, sizeof(file_header.magic)) != 0
+        || file_header.header_bytes < sizeof(SessionFileHeader) || file_header.header_bytes > file_bytes) {
+        std::cerr << "Not a compact log: " << path << std::endl;
+        close();
+        return false;
+    }
+    if (file_header.version != compact_log_version) {
+        std::cerr << "Unsupported compact log version " << file_header.version << ": " << path << std::endl;
+        close();
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+void CompactLogReader::close(){
+    if (mapping) {munmap(const_cast<uint8_t*>(mapping), file_bytes);}
+    if (fd >= 0) {::close(fd);}
+    mapping = nullptr;
+    fd = -1;
+    file_bytes = position = 0;
+    corrupt_blocks = 0;
+}
+
+bool CompactLogReader::nextBlock(std::vector<CompactSample>& samples, uint16_t& sensor){
+    while (position < file_bytes) {
+        CompactBlockHeader header;
+        const BlockStatus status = decodeCompactBlock(mapping + position, file_bytes - position, samples, header);
+        if (status == BlockStatus::Ok) {
+            position += sizeof(header) + header.payload_bytes;
+            sensor = header.sensor;
+            return true;
+        }
+        // A block still being written (or cut off by a crash) ends the
+        // log, Truncated is only ever given for an intact header
+        if (status == BlockStatus::Truncated) {return false;}
+
+        // Damaged, carry on from the next sync word after this one
+        corrupt_blocks++;
+        position = findSync(mapping, position + 1, file_bytes);
+    }
+    return false;
+}
+
+void CompactLogReader::seek(uint64_t timestamp_ns){
+    rewind();
+    size_t offset = position;
+    CompactBlockHeader header;
+    while (offset + sizeof(header) <= file_bytes) {
+        std::memcpy(&header, mapping + offset, sizeof(header));
+        // nextBlock resyncs past a damaged header, stopping short is enough
+        if (!checkBlockHeader(header) || header.base_timestamp_ns > timestamp_ns) {break;}
+        position = offset;
+        offset += sizeof(header) + header.payload_bytes;
+    }
+}
+
+std::vector<CompactBlockRef> CompactLogReader::blocks(uint64_t* damaged) const {
+    std::vector<CompactBlockRef> found;
+    if (damaged) {*damaged = 0;}
+    size_t offset = file_header.header_bytes;
+    while (offset + sizeof(CompactBlockHeader) <= file_bytes) {
+        CompactBlockHeader header;
+        std::memcpy(&header, mapping + offset, sizeof(header));
+        if (checkBlockHeader(header)) {
+            // A block still being written ends the log
+            if (header.payload_bytes > file_bytes - offset - sizeof(header)) {break;}
+            found.push_back(CompactBlockRef{offset, header.sample_count, header.sensor, header.base_timestamp_ns});
+            offset += sizeof(header) + header.payload_bytes;
+            continue;
+        }
+        if (damaged) {(*damaged)++;}
+        offset = findSync(mapping, offset + 1, file_bytes);
+    }
+    return found;
+}
+
+BlockStatus CompactLogReader::decodeBlock(const CompactBlockRef& block, std::vector<CompactSample>& samples) const {
+    if (block.offset >= file_bytes) {return BlockStatus::Truncated;}
+    CompactBlockHeader header;
+    return decodeCompactBlock(mapping + block.offset, file_bytes - block.offset, samples, header);
+}
+
+bool isCompactLog(const std::string& path){
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, compact_log_magic, sizeof(magic)) == 0;
+}
@@ -0,0 +1,270 @@
+/**
+ * @file compact_log.hpp
+ * @brief Block-compressed log of parsed samples.
+ *
+ * @details A compact log is a SessionFileHeader (with compact_log_magic)
+ * followed by blocks.  Each block is a CompactBlockHeader and a payload
+ * of three zigzag varints per sample: the change in timestamp, degree
+ * and distance from the previous sample.  The first sample is relative
+ * to the block's base timestamp and zero degree/distance, so every block
+ * decodes on its own.  Consecutive degrees differ by one and distances
+ * drift slowly, so most samples come to 3-6 bytes against the 24 of a
+ * Sample record in a session log (16 of record header, 8 of payload).
+ * Everything is little-endian.
+ *
+ * Blocks are checked with CRC-32C, which SSE4.2 and ARMv8 compute in
+ * hardware at several GB/s.  With the table CRC-32 the checksum was a
+ * quarter of the decode time, now it's a few percent, and decoding got
+ * about 12% faster (bench compact_log_decode, measured on encoded
+ * bytes).  The rest is the varints, each one's length depending on the
+ * one before, which keeps decoding well under 1 GB/s of log read; only
+ * the CompactSample output, about four times the size, gets past that.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "async_file_writer.hpp"
+#include "session_log.hpp"
+#include "../ingest/sample_parser.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const char compact_log_magic[4] = {'U', 'S', 'C', 'L'};
+const uint16_t compact_log_version = 3;   // 2 added header_crc, 3 moved to crc32c
+const uint32_t compact_block_sync = 0x42435355;   // "USCB"
+
+struct CompactBlockHeader {
+    uint32_t sync;              // compact_block_sync, lets a reader resync after damage
+    uint16_t sensor;
+    uint16_t reserved;
+    uint32_t sample_count;
+    uint32_t payload_bytes;
+    uint64_t base_timestamp_ns;
+    uint32_t crc;               // crc32c of the payload, then the 24 header bytes above
+    uint32_t header_crc;        // crc32c of the 28 bytes above, so payload_bytes can be trusted
+};
+
+static_assert(sizeof(CompactBlockHeader) == 32, "compact block layout changed");
+
+/**
+ * @brief One decoded sample
+ */
+struct CompactSample {
+    uint64_t timestamp_ns;
+    int32_t degree;
+    int32_t distance_cm;
+};
+
+enum class BlockStatus {
+    Ok,
+    Truncated,  // not enough bytes left for the whole block
+    Corrupt,    // bad sync word, checksum or encoding
+};
+
+/**
+ * @brief Builds one block in memory
+ */
+class CompactBlockEncoder {
+public:
+    /**
+     * @brief Starts a new, empty block
+     */
+    void reset(uint16_t sensor, uint64_t base_timestamp_ns);
+
+    void add(uint64_t timestamp_ns, int32_t degree, int32_t distance_cm);
+
+    size_t samples() const { return sample_count; }
+    uint16_t sensor() const { return block_sensor; }
+    uint64_t baseTimestamp() const { return base_timestamp_ns; }
+
+    /**
+     * @brief Appends the finished block (header and payload) to out
+     */
+    void finish(std::vector<uint8_t>& out) const;
+
+private:
+    std::vector<uint8_t> payload;
+    uint16_t block_sensor = 0;
+    uint32_t sample_count = 0;
+    uint64_t base_timestamp_ns = 0;
+    uint64_t previous_timestamp_ns = 0;
+    int32_t previous_degree = 0;
+    int32_t previous_distance = 0;
+};
+
+/**
+ * @brief Whether a block header is intact (sync word, its own checksum
+ * and a payload big enough for its samples), before anything in it is
+ * relied on
+ *
+ * @details Only a header that passes can say a block is still being
+ * written, one that fails is damage however far its payload_bytes says
+ * the block goes.
+ */
+bool checkBlockHeader(const CompactBlockHeader& header);
+
+/**
+ * @brief Checks and decodes the block at the start of data
+ *
+ * @param data Start of the block
+ * @param available Bytes from data to the end of the log
+ * @param samples Replaced with the block's samples when it is Ok
+ * @param header Filled in when the block is Ok
+ */
+BlockStatus decodeCompactBlock(const uint8_t* data, size_t available,
+                               std::vector<CompactSample>& samples, CompactBlockHeader& header);
+
+/**
+ * @brief Writes parsed samples to a compact log through an AsyncFileWriter
+ *
+ * @details A block is closed when it is full, when the sensor changes or
+ * when block_interval has passed since its first sample, and is written
+ * out as soon as it closes.  append() only notices that when the next
+ * sample comes, so if samples stop the last block would sit in memory
+ * until close().  flushIfDue() closes it once it has been open
+ * block_interval by the clock; called from the owner's loop, a reader
+ * following the log waits at most block_interval plus one pass of that
+ * loop for new data.
+ */
+class CompactLogWriter {
+public:
+    CompactLogWriter(size_t block_samples = 4096,
+                     std::chrono::milliseconds block_interval = std::chrono::milliseconds(500));
+
+    /**
+     * @brief Creates a new log and writes its header
+     *
+     * @param path Log file to create, must not exist yet
+     * @param policy When the writer thread should fsync
+     * @param start Start times for the header, a replayed log's own when
+     * its timestamps are being written again
+     */
+    bool open(const std::string& path, FsyncPolicy policy, SessionStart start = sessionStartNow());
+
+    /**
+     * @brief Writes the open block and closes the log
+     */
+    void close();
+    bool isOpen() const { return writer.isOpen(); }
+
+    void append(uint64_t timestamp_ns, const ParsedSample& sample, uint16_t sensor = 0);
+
+    /**
+     * @brief Writes the open block now, even if it isn't full
+     */
+    void flushBlock();
+
+    /**
+     * @brief Writes the open block if it was started block_interval or
+     * more before now_ns (monotonicNanoseconds), cheap enough to call on
+     * every pass of a loop
+     */
+    void flushIfDue(uint64_t now_ns);
+
+    WriterStats stats() const { return writer.stats(); }
+
+private:
+    const size_t block_samples;
+    const uint64_t block_interval_ns;
+    AsyncFileWriter writer;
+    CompactBlockEncoder encoder;
+    std::vector<uint8_t> block;
+    // When the open block got its first sample, by the clock rather than
+    // by sample timestamps, which are a replayed log's own in a replay
+    uint64_t block_opened_ns = 0;
+};
+
+/**
+ * @brief Where a block sits in a log, from its header alone
+ */
+struct CompactBlockRef {
+    size_t offset;
+    uint32_t sample_count;
+    uint16_t sensor;
+    uint64_t base_timestamp_ns;
+};
+
+/**
+ * @brief Memory-mapped reader for compact logs, one block at a time
+ *
+ * @details A block that fails its checksum is counted and skipped.  If
+ * its header can't be trusted either, the reader looks for the next sync
+ * word and carries on from there.  Only a block with an intact header
+ * that runs past the end of the file ends the log early, as the one
+ * still being written (or cut off by a crash).
+ */
+class CompactLogReader {
+public:
+    CompactLogReader() = default;
+    ~CompactLogReader();
+
+    CompactLogReader(const CompactLogReader&) = delete;
+    CompactLogReader& operator=(const CompactLogReader&) = delete;
+
+    /**
+     * @brief Maps a log and checks its header, false on failure
+     */
+    bool open(const std::string& path);
+    void close();
+
+    const SessionFileHeader& header() const { return file_header; }
+
+    /**
+     * @brief Decodes the next good block, false at the end of the log
+     *
+     * @param samples Replaced with the block's samples
+     * @param sensor Set to the block's sensor
+     */
+    bool nextBlock(std::vector<CompactSample>& samples, uint16_t& sensor);
+
+    /**
+     * @brief Moves to the last block starting at or before a time
+     *
+     * @details Only block headers are read on the way, payloads are
+     * jumped over.
+     */
+    void seek(uint64_t timestamp_ns);
+
+    void rewind() { position = file_header.header_bytes; }
+
+    /**
+     * @brief Every block in the log, found by walking the block headers
+     *
+     * @details Payloads are jumped over without being checked, so a block
+     * listed here can still turn out Corrupt in decodeBlock.  Stretches
+     * with no believable header are skipped to the next sync word.  Used
+     * to split a log between threads, the reader's position is untouched.
+     *
+     * @param damaged If given, set to how many damaged headers were
+     * skipped, which nextBlock() would have counted as corrupt blocks
+     */
+    std::vector<CompactBlockRef> blocks(uint64_t* damaged = nullptr) const;
+
+    /**
+     * @brief Decodes a block listed by blocks(), safe to call from several
+     * threads at once
+     */
+    BlockStatus decodeBlock(const CompactBlockRef& block, std::vector<CompactSample>& samples) const;
+
+    uint64_t corruptBlocks() const { return corrupt_blocks; }
+
+private:
+    int fd = -1;
+    const uint8_t* mapping = nullptr;
+    size_t file_bytes = 0;
+    size_t position = 0;
+    SessionFileHeader file_header{};
+    uint64_t corrupt_blocks = 0;
+};
+
+/**
+ * @brief Whether a file starts like a compact log rather than a session log
+ */
+bool isCompactLog(const std::string& path);
@@ -0,0 +1,185 @@
+/**
+ * @file flight_recorder.cpp
+ * @brief Ring file setup, crash handlers and post-mortem reading for
+ * FlightRecorder.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "flight_recorder.hpp"
+#include "session_log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+// The recorder the crash handlers write to
+FlightRecorder* crash_recorder = nullptr;
+
+const int fatal_signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+void recordFatalSignal(int signal_number){
+    // Only memory stores, safe in a signal handler.  SA_RESETHAND put
+    // the default action back, raising again lets it run
+    if (crash_recorder) {
+        crash_recorder->recordEvent(monotonicNanoseconds(), FlightEvent::Signal, signal_number);
+    }
+    std::raise(signal_number);
+}
+
+void recordTerminate(){
+    if (crash_recorder) {
+        crash_recorder->recordEvent(monotonicNanoseconds(), FlightEvent::Terminate);
+    }
+    std::abort();
+}
+
+} // namespace
+
+FlightRecorder::~FlightRecorder(){
+    close();
+}
+
+bool FlightRecorder::open(const std::string& path, size_t capacity){
+    close();
+    size_t ring = 1;
+    while (ring < capacity) {ring <<= 1;}
+
+    // Keep the last run's ring, it's the one worth reading after a crash
+    std::rename(path.c_str(), (path + ".prev").c_str());
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error creating flight recorder: " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    file_bytes = sizeof(FlightRecorderHeader) + ring * sizeof(FlightEntry);
+    if (ftruncate(fd, off_t(file_bytes)) != 0) {
+        std::cerr << "Error sizing flight recorder: " << path << ": " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    void* mapped = mmap(nullptr, file_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error mapping flight recorder: " << path << ": " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    header = new (mapped) FlightRecorderHeader();
+    std::memcpy(header->magic, flight_recorder_magic, sizeof(header->magic));
+    header->version = flight_recorder_version;
+    header->entry_bytes = sizeof(FlightEntry);
+    header->capacity = uint32_t(ring);
+    header->entries_offset = sizeof(FlightRecorderHeader);
+    header->start_steady_ns = monotonicNanoseconds();
+    header->start_unix_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    entries = reinterpret_cast<FlightEntry*>(static_cast<char*>(mapped) + sizeof(FlightRecorderHeader));
+    mask = ring - 1;
+    return true;
+}
+
+void FlightRecorder::close(){
+    if (crash_recorder == this) {crash_recorder = nullptr;}
+    if (header) {munmap(header, file_bytes);}
+    if (fd >= 0) {::close(fd);}
+    header = nullptr;
+    entries = nullptr;
+    fd = -1;
+}
+
+void installFlightCrashHandlers(FlightRecorder& recorder){
+    crash_recorder = &recorder;
+    std::set_terminate(recordTerminate);
+
+    struct sigaction action{};
+    action.sa_handler = recordFatalSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESETHAND;
+    for (int signal_number : fatal_signals) {
+        sigaction(signal_number, &action, nullptr);
+    }
+}
+
+bool readFlightLog(const std::string& path, FlightLogInfo& info, std::vector<FlightEntry>& entries){
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Error opening flight recorder: " << path << std::endl;
+        return false;
+    }
+    // The ring's size is checked against this before it is allocated
+    const uint64_t file_bytes = uint64_t(std::max<std::streamoff>(file.tellg(), 0));
+    file.seekg(0);
+
+    // Field by field, the header can't be copied as a whole because of the atomic
+    char fixed[offsetof(FlightRecorderHeader, next_entry)];
+    uint64_t next_entry;
+    if (!file.read(fixed, sizeof(fixed)) || !file.read(reinterpret_cast<char*>(&next_entry), sizeof(next_entry))
+        || std::memcmp(fixed, flight_recorder_magic, sizeof(flight_recorder_magic)) != 0) {
+        std::cerr << "Not a flight recorder file: " << path << std::endl;
+        return false;
+    }
+    uint16_t version, entry_bytes;
+    uint32_t entries_offset;
+    std::memcpy(&version, fixed + offsetof(FlightRecorderHeader, version), sizeof(version));
+    std::memcpy(&entry_bytes, fixed + offsetof(FlightRecorderHeader, entry_bytes), sizeof(entry_bytes));
+    std::memcpy(&info.capacity, fixed + offsetof(FlightRecorderHeader, capacity), sizeof(info.capacity));
+    std::memcpy(&entries_offset, fixed + offsetof(FlightRecorderHeader, entries_offset), sizeof(entries_offset));
+    std::memcpy(&info.start_steady_ns, fixed + offsetof(FlightRecorderHeader, start_steady_ns), sizeof(info.start_steady_ns));
+    std::memcpy(&info.start_unix_ns, fixed + offsetof(FlightRecorderHeader, start_unix_ns), sizeof(info.start_unix_ns));
+    info.total_entries = next_entry;
+    if (version != flight_recorder_version || entry_bytes != sizeof(FlightEntry)
+        || info.capacity == 0 || (info.capacity & (info.capacity - 1)) != 0
+        || entries_offset < sizeof(FlightRecorderHeader)) {
+        std::cerr << "Unsupported flight recorder file: " << path << std::endl;
+        return false;
+    }
+
+    if (entries_offset + uint64_t(info.capacity) * sizeof(FlightEntry) > file_bytes) {
+        std::cerr << "Flight recorder file is cut short: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<FlightEntry> ring(info.capacity);
+    file.seekg(entries_offset);
+    if (!file.read(reinterpret_cast<char*>(ring.data()), std::streamsize(ring.size() * sizeof(FlightEntry)))) {
+        std::cerr << "Flight recorder file is cut short: " << path << std::endl;
+        return false;
+    }
+
+    // Oldest surviving entry first
+    const uint64_t kept = std::min<uint64_t>(next_entry, info.capacity);
+    entries.resize(kept);
+    for (uint64_t i = 0; i < kept; i++) {
+        entries[i] = ring[(next_entry - kept + i) & (info.capacity - 1)];
+    }
+    return true;
+}
+
+const char* flightEventName(uint8_t code){
+    switch (FlightEvent(code)) {
+        case FlightEvent::Start: return "start";
+        case FlightEvent::Shutdown: return "shutdown";
+        case FlightEvent::Sweep: return "sweep";
+        case FlightEvent::InvalidMessage: return "invalid message";
+        case FlightEvent::MapSaved: return "map saved";
+        case FlightEvent::Signal: return "signal";
+        case FlightEvent::Terminate: return "terminate";
+        case FlightEvent::ReplayStart: return "replay start";
+    }
+    return "unknown";
+}
@@ -0,0 +1,159 @@
+/**
+ * @file flight_recorder.hpp
+ * @brief Crash-surviving ring of recent samples and events in a mapped file.
+ *
+ * @details The file is a FlightRecorderHeader followed by a power of two
+ * FlightEntry slots used as a ring.  Entries are plain stores into a
+ * MAP_SHARED mapping, the kernel owns those pages, so whatever was
+ * written is still in the file after the process dies however it dies.
+ * Only losing power before writeback loses data.  The header's
+ * next_entry counts every entry ever written, the newest one is at
+ * (next_entry - 1) % capacity.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "../ingest/sample_parser.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const char flight_recorder_magic[4] = {'U', 'S', 'F', 'R'};
+const uint16_t flight_recorder_version = 1;
+
+enum class FlightEntryKind : uint8_t {
+    Sample = 1,     // degree, value = distance in cm
+    Event = 2,      // code is a FlightEvent, value depends on it
+};
+
+enum class FlightEvent : uint8_t {
+    Start = 1,
+    Shutdown = 2,       // clean exit
+    Sweep = 3,          // value = sweeps so far
+    InvalidMessage = 4, // value = invalid messages so far
+    MapSaved = 5,
+    Signal = 6,         // value = signal number, written from the handler
+    Terminate = 7,      // std::terminate was called
+    ReplayStart = 8,
+};
+
+struct FlightEntry {
+    uint64_t timestamp_ns;
+    uint8_t kind;
+    uint8_t code;
+    int16_t degree;
+    int32_t value;
+};
+
+struct FlightRecorderHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t entry_bytes;       // sizeof(FlightEntry)
+    uint32_t capacity;          // entries in the ring, a power of two
+    uint32_t entries_offset;    // where the ring starts in the file
+    uint64_t start_steady_ns;
+    int64_t start_unix_ns;
+    uint8_t reserved[32];
+    std::atomic<uint64_t> next_entry;   // own cache line, bumped per entry
+    uint8_t padding[56];
+};
+
+static_assert(sizeof(FlightEntry) == 16, "flight entry layout changed");
+static_assert(sizeof(FlightRecorderHeader) == 128, "flight header layout changed");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "flight recorder needs lock-free 64 bit atomics");
+
+/**
+ * @brief Writes samples and events into the mapped ring
+ *
+ * @details Recording is one relaxed fetch_add and a 16 byte store, no
+ * locks and no system calls, so it is safe from signal handlers and
+ * costs a few nanoseconds.  Callers pass timestamps they already have
+ * instead of the recorder reading the clock.
+ */
+class FlightRecorder {
+public:
+    FlightRecorder() = default;
+    ~FlightRecorder();
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    /**
+     * @brief Creates the ring file and maps it, false on failure
+     *
+     * @details An existing file at path is kept as PATH.prev first, so
+     * starting again after a crash doesn't wipe the evidence.
+     *
+     * @param path Ring file
+     * @param capacity Entries to keep, rounded up to a power of two
+     */
+    bool open(const std::string& path, size_t capacity);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    void recordSample(uint64_t timestamp_ns, const ParsedSample& sample){
+        record(FlightEntry{timestamp_ns, uint8_t(FlightEntryKind::Sample), 0,
+                           int16_t(sample.degree), sample.distance_cm});
+    }
+
+    void recordEvent(uint64_t timestamp_ns, FlightEvent event, int32_t value = 0){
+        record(FlightEntry{timestamp_ns, uint8_t(FlightEntryKind::Event), uint8_t(event), 0, value});
+    }
+
+    void record(const FlightEntry& entry){
+        const uint64_t slot = header->next_entry.fetch_add(1, std::memory_order_relaxed) & mask;
+        entries[slot] = entry;
+    }
+
+private:
+    int fd = -1;
+    FlightRecorderHeader* header = nullptr;
+    FlightEntry* entries = nullptr;
+    size_t file_bytes = 0;
+    uint64_t mask = 0;
+};
+
+/**
+ * @brief Records a Terminate or Signal event before the process dies
+ *
+ * @details Installs a std::terminate handler and handlers for the fatal
+ * signals (SEGV, BUS, FPE, ILL, ABRT).  Each records its event and then
+ * lets the default action happen, so core dumps and exit codes are as
+ * before.
+ *
+ * @param recorder Must stay open until the process exits
+ */
+void installFlightCrashHandlers(FlightRecorder& recorder);
+
+/**
+ * @brief What readFlightLog found in a ring file's header
+ */
+struct FlightLogInfo {
+    uint32_t capacity = 0;
+    uint64_t total_entries = 0;     // ever written, older ones were overwritten
+    uint64_t start_steady_ns = 0;
+    int64_t start_unix_ns = 0;
+};
+
+/**
+ * @brief Reads a ring file back, oldest entry first, false on failure
+ *
+ * @details Works on a file left by a crashed process.  The newest entry
+ * may be half written if the crash happened in the middle of it.
+ *
+ * @param path Ring file
+ * @param info Filled in from the file's header
+ * @param entries Replaced with the entries still in the ring
+ */
+bool readFlightLog(const std::string& path, FlightLogInfo& info, std::vector<FlightEntry>& entries);
+
+/**
+ * @brief Name for an event code, "unknown" for codes this build lacks
+ */
+const char* flightEventName(uint8_t code);
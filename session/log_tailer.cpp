@@ -0,0 +1,190 @@
+/**
+ * @file log_tailer.cpp
+ * @brief inotify waiting and incremental block decoding for CompactLogTailer.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "log_tailer.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace {
+
+const size_t read_chunk_bytes = 256 * 1024;
+
+} // namespace
+
+CompactLogTailer::~CompactLogTailer(){
+    close();
+}
+
+bool CompactLogTailer::open(const std::string& path, bool from_start){
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error opening compact log: " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+#ifdef __linux__
+    // Set the watch up before the first read so no write can slip between
+    watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch_fd < 0 || inotify_add_watch(watch_fd, path.c_str(), IN_MODIFY | IN_CLOSE_WRITE) < 0) {
+        std::cerr << "Error watching compact log: " << path << ": " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+#endif
+    if (!from_start) {
+        // Skip to the end, the first block boundary is found by the sync
+        // word the same way as after damage, so nothing counts as corrupt
+        struct stat info;
+        if (fstat(fd, &info) == 0 && size_t(info.st_size) > sizeof(SessionFileHeader)) {
+            if (pread(fd, &file_header, sizeof(file_header), 0) == ssize_t(sizeof(file_header))) {
+                have_header = true;
+                joined_mid_block = true;
+                file_offset = uint64_t(info.st_size);
+            }
+        }
+    }
+    return true;
+}
+
+void CompactLogTailer::close(){
+    if (fd >= 0) {::close(fd);}
+    if (watch_fd >= 0) {::close(watch_fd);}
+    fd = watch_fd = -1;
+    writer_closed = have_header = joined_mid_block = false;
+    file_offset = 0;
+    pending.clear();
+    pending_start = 0;
+    corrupt_blocks = 0;
+}
+
+bool CompactLogTailer::readMore(){
+    // Drop what's been decoded before growing the buffer
+    if (pending_start > 0) {
+        pending.erase(pending.begin(), pending.begin() + ptrdiff_t(pending_start));
+        pending_start = 0;
+    }
+    bool got_any = false;
+    while (true) {
+        const size_t old_size = pending.size();
+        pending.resize(old_size + read_chunk_bytes);
+        const ssize_t count = pread(fd, pending.data() + old_size, read_chunk_bytes, off_t(file_offset));
+        pending.resize(old_size + size_t(std::max<ssize_t>(count, 0)));
+        if (count <= 0) {break;}
+        file_offset += uint64_t(count);
+        got_any = true;
+        if (size_t(count) < read_chunk_bytes) {break;}
+    }
+    return got_any;
+}
+
+bool CompactLogTailer::decodeBuffered(std::vector<CompactSample>& samples, uint16_t& sensor){
+    if (!have_header) {
+        if (pending.size() - pending_start < sizeof(file_header)) {return false;}
+        std::memcpy(&file_header, pending.data() + pending_start, sizeof(file_header));
+        if (std::memcmp(file_header.magic, compact_log_magic, sizeof(file_header.magic)) != 0
+            || file_header.header_bytes < sizeof(SessionFileHeader)) {
+            std::cerr << "Not a compact log" << std::endl;
+            return false;
+        }
+        if (file_header.version != compact_log_version) {
+            std::cerr << "Unsupported compact log version " << file_header.version << std::endl;
+            return false;
+        }
+        if (pending.size() - pending_start < file_header.header_bytes) {return false;}
+        pending_start += file_header.header_bytes;
+        have_header = true;
+    }
+
+    while (pending_start < pending.size()) {
+        CompactBlockHeader header;
+        const BlockStatus status = decodeCompactBlock(pending.data() + pending_start, pending.size() - pending_start,
+                                                      samples, header);
+        if (status == BlockStatus::Ok) {
+            pending_start += sizeof(header) + header.payload_bytes;
+            sensor = header.sensor;
+            joined_mid_block = false;
+            return true;
+        }
+        // Rest of the block hasn't landed yet, which an intact header is
+        // needed to tell apart from one whose size was damaged
+        if (status == BlockStatus::Truncated) {return false;}
+        // Damaged (or we joined mid-block), move on to the next sync word
+        if (!joined_mid_block) {corrupt_blocks++;}
+        size_t next = pending_start + 1;
+        while (next + sizeof(uint32_t) <= pending.size()) {
+            uint32_t sync;
+            std::memcpy(&sync, pending.data() + next, sizeof(sync));
+            if (sync == compact_block_sync) {break;}
+            next++;
+        }
+        pending_start = std::min(next, pending.size());
+    }
+    return false;
+}
+
+bool CompactLogTailer::waitForChange(int timeout_ms){
+#ifdef __linux__
+    pollfd watch{watch_fd, POLLIN, 0};
+    const int ready = ::poll(&watch, 1, timeout_ms);
+    if (ready <= 0) {return false;}
+
+    // Drain the events, only whether the writer is done matters
+    alignas(inotify_event) char events[4096];
+    ssize_t count;
+    while ((count = ::read(watch_fd, events, sizeof(events))) > 0) {
+        for (ssize_t offset = 0; offset < count;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(events + offset);
+            if (event->mask & IN_CLOSE_WRITE) {writer_closed = true;}
+            offset += ssize_t(sizeof(inotify_event) + event->len);
+        }
+    }
+    return true;
+#else
+    // No inotify, check for growth every couple of milliseconds
+    const auto step = std::chrono::milliseconds(2);
+    for (int waited = 0; timeout_ms < 0 || waited < timeout_ms; waited += 2) {
+        struct stat info;
+        if (fstat(fd, &info) == 0 && uint64_t(info.st_size) > file_offset) {return true;}
+        std::this_thread::sleep_for(step);
+    }
+    return false;
+#endif
+}
+
+TailStatus CompactLogTailer::next(std::vector<CompactSample>& samples, uint16_t& sensor, int timeout_ms){
+    if (fd < 0) {return TailStatus::Error;}
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout_ms, 0));
+    while (true) {
+        if (decodeBuffered(samples, sensor)) {return TailStatus::Block;}
+        if (readMore()) {continue;}
+        if (writer_closed) {return TailStatus::Finished;}
+
+        int wait_ms = -1;
+        if (timeout_ms >= 0) {
+            wait_ms = int(std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count());
+            if (wait_ms <= 0) {return TailStatus::Timeout;}
+        }
+        if (!waitForChange(wait_ms) && timeout_ms >= 0) {
+            // One last look, a write may have landed right at the deadline
+            if (readMore()) {continue;}
+            return TailStatus::Timeout;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ * @file log_tailer.hpp
+ * @brief Follows a compact log while it is still being written.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "compact_log.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class TailStatus {
+    Block,      // a new block was decoded
+    Timeout,    // nothing new within the timeout
+    Finished,   // the writer closed the log and every block has been read
+    Error,
+};
+
+/**
+ * @brief Hands out the blocks of a growing compact log as they land
+ *
+ * @details On Linux the tailer sleeps on an inotify watch of the file
+ * and wakes when the writer's write() lands, so there is no polling and
+ * no coordination beyond the file itself.  Blocks are only ever
+ * appended whole-or-partly and carry a checksum, so a block that is
+ * still partly written just reads as truncated until the rest arrives.
+ * Elsewhere the file size is checked every few milliseconds instead.
+ */
+class CompactLogTailer {
+public:
+    CompactLogTailer() = default;
+    ~CompactLogTailer();
+
+    CompactLogTailer(const CompactLogTailer&) = delete;
+    CompactLogTailer& operator=(const CompactLogTailer&) = delete;
+
+    /**
+     * @brief Starts following a log, false on failure
+     *
+     * @param path The log, which the writer must already have created
+     * @param from_start Read the blocks already in the file too, rather
+     * than only the ones written from now on
+     */
+    bool open(const std::string& path, bool from_start = true);
+    void close();
+
+    /**
+     * @brief Waits for the next block
+     *
+     * @param samples Replaced with the block's samples
+     * @param sensor Set to the block's sensor
+     * @param timeout_ms How long to wait for new data, -1 for ever
+     */
+    TailStatus next(std::vector<CompactSample>& samples, uint16_t& sensor, int timeout_ms = -1);
+
+    const SessionFileHeader& header() const { return file_header; }
+    uint64_t corruptBlocks() const { return corrupt_blocks; }
+
+private:
+    bool readMore();
+    bool waitForChange(int timeout_ms);
+    bool decodeBuffered(std::vector<CompactSample>& samples, uint16_t& sensor);
+
+    int fd = -1;
+    int watch_fd = -1;
+    bool writer_closed = false;
+    bool have_header = false;
+    bool joined_mid_block = false;     // skipping to the first sync word isn't damage
+    SessionFileHeader file_header{};
+    uint64_t file_offset = 0;           // how far into the file has been read
+    std::vector<uint8_t> pending;       // read but not yet decoded
+    size_t pending_start = 0;
+    uint64_t corrupt_blocks = 0;
+};
@@ -0,0 +1,44 @@
+/**
+ * @file replay_clock.cpp
+ * @brief Speed parsing and pacing for session replay.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "replay_clock.hpp"
+#include "session_log.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+bool parseReplaySpeed(const std::string& text, ReplaySpeed& speed){
+    if (text == "real") {speed.factor = 1.0; return true;}
+    if (text == "max") {speed.factor = 0.0; return true;}
+
+    char* end = nullptr;
+    const double factor = std::strtod(text.c_str(), &end);
+    if (end != text.c_str() && (*end == '\0' || (*end == 'x' && end[1] == '\0')) && factor > 0) {
+        speed.factor = factor;
+        return true;
+    }
+    std::cerr << "Invalid replay speed (real, max or a factor like 10x): " << text << std::endl;
+    return false;
+}
+
+void ReplayClock::waitUntil(uint64_t timestamp_ns){
+    if (speed.unlimited()) {return;}
+    if (!started) {
+        started = true;
+        first_record_ns = timestamp_ns;
+        start_ns = monotonicNanoseconds();
+        return;
+    }
+    if (timestamp_ns <= first_record_ns) {return;}
+    const uint64_t due_ns = start_ns + uint64_t(double(timestamp_ns - first_record_ns) / speed.factor);
+    const uint64_t now_ns = monotonicNanoseconds();
+    if (due_ns > now_ns) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(due_ns - now_ns));
+    }
+}
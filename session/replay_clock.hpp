@@ -0,0 +1,54 @@
+/**
+ * @file replay_clock.hpp
+ * @brief Paces a session replay at recorded, scaled or unlimited speed.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief How fast to replay, speed 1 is the recorded timing and 0 is as
+ * fast as possible
+ */
+struct ReplaySpeed {
+    double factor = 1.0;
+
+    bool unlimited() const { return factor <= 0; }
+};
+
+/**
+ * @brief Reads "real", "max" or a factor like "10" or "10x"
+ *
+ * @param text The command line value
+ * @param speed Set when the text is valid
+ */
+bool parseReplaySpeed(const std::string& text, ReplaySpeed& speed);
+
+/**
+ * @brief Sleeps until each record is due
+ *
+ * @details The first record is due straight away, every later one when
+ * its distance from the first, divided by the speed factor, has passed
+ * on the steady clock.  Waiting against the start rather than the
+ * previous record keeps sleep overshoot from adding up over long logs.
+ */
+class ReplayClock {
+public:
+    explicit ReplayClock(ReplaySpeed speed) : speed(speed) {}
+
+    /**
+     * @brief Returns once the record stamped timestamp_ns is due
+     */
+    void waitUntil(uint64_t timestamp_ns);
+
+private:
+    ReplaySpeed speed;
+    bool started = false;
+    uint64_t first_record_ns = 0;
+    uint64_t start_ns = 0;
+};
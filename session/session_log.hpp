@@ -0,0 +1,104 @@
+/**
+ * @file session_log.hpp
+ * @brief On-disk layout of recorded session logs.
+ *
+ * @details A session log is a SessionFileHeader followed by records, each
+ * a SessionRecordHeader and then payload_bytes of payload.  Records are
+ * only ever appended.  Timestamps are steady (monotonic) clock
+ * nanoseconds, the header keeps the steady and wall clock time the
+ * session started at so the two can be related afterwards.  Everything
+ * is little-endian.
+ *
+ * A cleanly closed log ends in a time index: an Index record holding
+ * SessionIndexEntry pairs, then an IndexTrailer record whose payload
+ * points back at it.  The trailer is always the last 32 bytes of the
+ * file, so a reader can find the index without scanning.  Both are
+ * ordinary records, readers that don't care about them skip them like
+ * any other type they don't use.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+const char session_log_magic[4] = {'U', 'S', 'R', 'L'};
+const uint16_t session_log_version = 1;
+
+struct SessionFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t header_bytes;      // sizeof(SessionFileHeader), lets later versions grow it
+    uint64_t start_steady_ns;
+    int64_t start_unix_ns;
+};
+
+enum class SessionRecordType : uint8_t {
+    RawChunk = 1,   // bytes exactly as read() returned them
+    Sample = 2,     // a SessionSample
+    Index = 3,      // SessionIndexEntry array
+    IndexTrailer = 4,   // a SessionIndexTrailer, last record of the file
+};
+
+struct SessionRecordHeader {
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t sensor;            // which scanner, 0 with a single arduino
+    uint32_t payload_bytes;
+    uint64_t timestamp_ns;
+};
+
+struct SessionSample {
+    int32_t degree;
+    int32_t distance_cm;
+};
+
+/**
+ * @brief One index point, the record at offset is the first one with a
+ * timestamp at or after timestamp_ns
+ */
+struct SessionIndexEntry {
+    uint64_t timestamp_ns;
+    uint64_t offset;            // from the start of the file
+};
+
+struct SessionIndexTrailer {
+    uint64_t index_offset;      // of the Index record's header
+    uint32_t entry_count;
+    char magic[4];              // session_index_magic
+};
+
+const char session_index_magic[4] = {'U', 'S', 'R', 'X'};
+
+static_assert(sizeof(SessionFileHeader) == 24, "session header layout changed");
+static_assert(sizeof(SessionRecordHeader) == 16, "session record layout changed");
+static_assert(sizeof(SessionSample) == 8, "session sample layout changed");
+static_assert(sizeof(SessionIndexEntry) == 16, "session index layout changed");
+static_assert(sizeof(SessionIndexTrailer) == 16, "session index layout changed");
+
+/**
+ * @brief Steady clock reading in nanoseconds, the log's time base
+ */
+inline uint64_t monotonicNanoseconds(){
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * @brief The two start times a log header carries
+ */
+struct SessionStart {
+    uint64_t steady_ns;
+    int64_t unix_ns;
+};
+
+/**
+ * @brief Start times for a log recorded from now on
+ */
+inline SessionStart sessionStartNow(){
+    return SessionStart{monotonicNanoseconds(), int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count())};
+}
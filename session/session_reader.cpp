@@ -0,0 +1,144 @@
+/**
+ * @file session_reader.cpp
+ * @brief Mapping, index loading and seeking for SessionReader.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "session_reader.hpp"
+#include "session_recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SessionReader::~SessionReader(){
+    close();
+}
+
+bool SessionReader::open(const std::string& path){
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error opening session log: " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(SessionFileHeader)) {
+        std::cerr << "Not a session log: " << path << std::endl;
+        close();
+        return false;
+    }
+    file_bytes = size_t(info.st_size);
+    void* mapped = mmap(nullptr, file_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error mapping session log: " << path << ": " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    mapping = static_cast<const char*>(mapped);
+
+    std::memcpy(&file_header, mapping, sizeof(file_header));
+    if (std::memcmp(file_header.magic, session_log_magic, sizeof(file_header.magic)) != 0
+        || file_header.header_bytes < sizeof(SessionFileHeader) || file_header.header_bytes > file_bytes) {
+        std::cerr << "Not a session log: " << path << std::endl;
+        close();
+        return false;
+    }
+    if (file_header.version != session_log_version) {
+        std::cerr << "Unsupported session log version " << file_header.version << ": " << path << std::endl;
+        close();
+        return false;
+    }
+
+    records_end = file_bytes;
+    stored_index = loadStoredIndex();
+    if (!stored_index) {buildIndex();}
+    madvise(const_cast<char*>(mapping), file_bytes, MADV_SEQUENTIAL);
+    rewind();
+    return true;
+}
+
+void SessionReader::close(){
+    if (mapping) {munmap(const_cast<char*>(mapping), file_bytes);}
+    if (fd >= 0) {::close(fd);}
+    mapping = nullptr;
+    fd = -1;
+    file_bytes = records_end = position = 0;
+    index.clear();
+    stored_index = false;
+}
+
+bool SessionReader::recordAt(size_t offset, SessionRecordHeader& record) const {
+    if (offset + sizeof(record) > records_end) {return false;}
+    std::memcpy(&record, mapping + offset, sizeof(record));
+    return offset + sizeof(record) + record.payload_bytes <= records_end;
+}
+
+bool SessionReader::loadStoredIndex(){
+    // The trailer record is always the last thing in a closed log
+    const size_t trailer_bytes = sizeof(SessionRecordHeader) + sizeof(SessionIndexTrailer);
+    if (file_bytes < file_header.header_bytes + trailer_bytes) {return false;}
+    const size_t trailer_offset = file_bytes - trailer_bytes;
+    SessionRecordHeader record;
+    SessionIndexTrailer trailer;
+    std::memcpy(&record, mapping + trailer_offset, sizeof(record));
+    std::memcpy(&trailer, mapping + trailer_offset + sizeof(record), sizeof(trailer));
+    if (record.type != uint8_t(SessionRecordType::IndexTrailer) || record.payload_bytes != sizeof(trailer)
+        || std::memcmp(trailer.magic, session_index_magic, sizeof(trailer.magic)) != 0) {
+        return false;
+    }
+
+    // Index record it points at
+    const size_t entries_bytes = size_t(trailer.entry_count) * sizeof(SessionIndexEntry);
+    if (trailer.index_offset < file_header.header_bytes
+        || trailer.index_offset + sizeof(record) + entries_bytes != trailer_offset) {
+        return false;
+    }
+    std::memcpy(&record, mapping + trailer.index_offset, sizeof(record));
+    if (record.type != uint8_t(SessionRecordType::Index) || record.payload_bytes != entries_bytes) {return false;}
+
+    index.resize(trailer.entry_count);
+    std::memcpy(index.data(), mapping + trailer.index_offset + sizeof(record), entries_bytes);
+    records_end = trailer.index_offset;
+    return true;
+}
+
+void SessionReader::buildIndex(){
+    // Same spacing the recorder uses, minus the sweep marks it can't recover
+    size_t offset = file_header.header_bytes;
+    size_t last_indexed = 0;
+    SessionRecordHeader record;
+    while (recordAt(offset, record)) {
+        if (index.empty() || offset - last_indexed >= SessionRecorder::index_interval_bytes) {
+            index.push_back(SessionIndexEntry{record.timestamp_ns, offset});
+            last_indexed = offset;
+        }
+        offset += sizeof(record) + record.payload_bytes;
+    }
+}
+
+bool SessionReader::next(SessionRecordHeader& record, const char*& payload){
+    if (!recordAt(position, record)) {return false;}
+    payload = mapping + position + sizeof(record);
+    position += sizeof(record) + record.payload_bytes;
+    return true;
+}
+
+void SessionReader::seek(uint64_t timestamp_ns){
+    // Last index point at or before the time, the records before the
+    // first point are covered by starting from the top
+    auto after = std::upper_bound(index.begin(), index.end(), timestamp_ns,
+        [](uint64_t t, const SessionIndexEntry& entry){ return t < entry.timestamp_ns; });
+    position = after == index.begin() ? file_header.header_bytes : size_t(std::prev(after)->offset);
+
+    SessionRecordHeader record;
+    while (recordAt(position, record) && record.timestamp_ns < timestamp_ns) {
+        position += sizeof(record) + record.payload_bytes;
+    }
+}
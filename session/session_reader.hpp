@@ -0,0 +1,89 @@
+/**
+ * @file session_reader.hpp
+ * @brief Memory-mapped reader for session logs, with seeking by time.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "session_log.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Steps through the records of a session log one at a time
+ *
+ * @details The whole log is mapped read-only, so records are handed out
+ * as pointers into the mapping with no copying.  The time index from the
+ * end of the log is loaded on open.  A log without one (the recorder
+ * never got to close it) is indexed by one scan instead, and a log cut
+ * short mid-record just ends at the last complete record.
+ */
+class SessionReader {
+public:
+    SessionReader() = default;
+    ~SessionReader();
+
+    SessionReader(const SessionReader&) = delete;
+    SessionReader& operator=(const SessionReader&) = delete;
+
+    /**
+     * @brief Maps a log and checks its header, false on failure
+     *
+     * @param path The session log
+     */
+    bool open(const std::string& path);
+    void close();
+
+    const SessionFileHeader& header() const { return file_header; }
+
+    /**
+     * @brief Reads the next record, false at the end of the log
+     *
+     * @param record Filled in with the record header
+     * @param payload Set to the payload, valid until the reader closes
+     */
+    bool next(SessionRecordHeader& record, const char*& payload);
+
+    /**
+     * @brief Moves to the first record at or after a time
+     *
+     * @details Binary searches the index for the last point at or before
+     * the time and scans forward from there, so only one index interval
+     * of records is ever read.  Raw chunks can split a message, so the
+     * first chunk after a seek may start with the tail of one.
+     *
+     * @param timestamp_ns Steady clock time, same base as the records
+     */
+    void seek(uint64_t timestamp_ns);
+
+    /**
+     * @brief Moves back to the first record
+     */
+    void rewind() { position = file_header.header_bytes; }
+
+    const std::vector<SessionIndexEntry>& timeIndex() const { return index; }
+
+    /**
+     * @brief Whether the index came from the log rather than a scan
+     */
+    bool hasStoredIndex() const { return stored_index; }
+
+private:
+    bool recordAt(size_t offset, SessionRecordHeader& record) const;
+    bool loadStoredIndex();
+    void buildIndex();
+
+    int fd = -1;
+    const char* mapping = nullptr;
+    size_t file_bytes = 0;
+    size_t records_end = 0;     // where the index (or the file) starts
+    size_t position = 0;
+    SessionFileHeader file_header{};
+    std::vector<SessionIndexEntry> index;
+    bool stored_index = false;
+};
@@ -0,0 +1,69 @@
+/**
+ * @file session_recorder.cpp
+ * @brief Record encoding and time indexing for SessionRecorder.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "session_recorder.hpp"
+
+#include <cstring>
+
+bool SessionRecorder::open(const std::string& path, FsyncPolicy policy, SessionStart start){
+    if (!writer.open(path, policy)) {return false;}
+
+    SessionFileHeader header;
+    std::memcpy(header.magic, session_log_magic, sizeof(header.magic));
+    header.version = session_log_version;
+    header.header_bytes = sizeof(SessionFileHeader);
+    header.start_steady_ns = start.steady_ns;
+    header.start_unix_ns = start.unix_ns;
+    writer.append(&header, sizeof(header));
+
+    file_offset = sizeof(header);
+    last_indexed_offset = 0;
+    index_next = true;
+    index.clear();
+    return true;
+}
+
+void SessionRecorder::close(){
+    if (!isOpen()) {return;}
+
+    // Index record, then the trailer pointing back at it
+    const uint64_t index_offset = file_offset;
+    const uint64_t timestamp_ns = index.empty() ? 0 : index.back().timestamp_ns;
+    const SessionRecordHeader index_header{uint8_t(SessionRecordType::Index), 0, 0,
+        uint32_t(index.size() * sizeof(SessionIndexEntry)), timestamp_ns};
+    writer.append(&index_header, sizeof(index_header), index.data(), index.size() * sizeof(SessionIndexEntry));
+
+    SessionIndexTrailer trailer{index_offset, uint32_t(index.size()), {}};
+    std::memcpy(trailer.magic, session_index_magic, sizeof(trailer.magic));
+    const SessionRecordHeader trailer_header{uint8_t(SessionRecordType::IndexTrailer), 0, 0,
+        sizeof(SessionIndexTrailer), timestamp_ns};
+    writer.append(&trailer_header, sizeof(trailer_header), &trailer, sizeof(trailer));
+
+    writer.close();
+}
+
+void SessionRecorder::append(const SessionRecordHeader& header, const void* payload){
+    // Dropped records never reach the file, so they mustn't move the offset
+    if (!writer.append(&header, sizeof(header), payload, header.payload_bytes)) {return;}
+
+    if (index_next || file_offset - last_indexed_offset >= index_interval_bytes) {
+        index.push_back(SessionIndexEntry{header.timestamp_ns, file_offset});
+        last_indexed_offset = file_offset;
+        index_next = false;
+    }
+    file_offset += sizeof(header) + header.payload_bytes;
+}
+
+void SessionRecorder::recordRaw(uint64_t timestamp_ns, const char* bytes, size_t count, uint16_t sensor){
+    append(SessionRecordHeader{uint8_t(SessionRecordType::RawChunk), 0, sensor, uint32_t(count), timestamp_ns}, bytes);
+}
+
+void SessionRecorder::recordSample(uint64_t timestamp_ns, const ParsedSample& sample, uint16_t sensor){
+    const SessionSample payload{sample.degree, sample.distance_cm};
+    append(SessionRecordHeader{uint8_t(SessionRecordType::Sample), 0, sensor, sizeof(SessionSample), timestamp_ns}, &payload);
+}
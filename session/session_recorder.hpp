@@ -0,0 +1,65 @@
+/**
+ * @file session_recorder.hpp
+ * @brief Records raw serial chunks and parsed samples to a session log.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "async_file_writer.hpp"
+#include "session_log.hpp"
+#include "../ingest/sample_parser.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Encodes records and hands them to an AsyncFileWriter
+ *
+ * @details Recording from the read loop costs a small memcpy per record,
+ * all disk I/O happens on the writer's thread.  The recorder keeps track
+ * of where each record lands in the file and builds the time index as it
+ * goes, close() writes it out at the end of the log.
+ */
+class SessionRecorder {
+public:
+    static constexpr uint64_t index_interval_bytes = 64 * 1024;
+
+    /**
+     * @brief Creates a new log and writes its header
+     *
+     * @param path Log file to create, must not exist yet
+     * @param policy When the writer thread should fsync
+     * @param start Start times for the header, a replayed log's own when
+     * its timestamps are being written again
+     */
+    bool open(const std::string& path, FsyncPolicy policy, SessionStart start = sessionStartNow());
+
+    /**
+     * @brief Writes the time index and closes the log
+     */
+    void close();
+    bool isOpen() const { return writer.isOpen(); }
+
+    void recordRaw(uint64_t timestamp_ns, const char* bytes, size_t count, uint16_t sensor = 0);
+    void recordSample(uint64_t timestamp_ns, const ParsedSample& sample, uint16_t sensor = 0);
+
+    /**
+     * @brief Puts an index point at the next record, so seeks can land
+     * on the start of a sweep
+     */
+    void markSweep() { index_next = true; }
+
+    WriterStats stats() const { return writer.stats(); }
+
+private:
+    void append(const SessionRecordHeader& header, const void* payload);
+
+    AsyncFileWriter writer;
+    uint64_t file_offset = 0;           // where the next record will start
+    uint64_t last_indexed_offset = 0;
+    bool index_next = false;
+    std::vector<SessionIndexEntry> index;
+};
@@ -0,0 +1,333 @@
+/**
+ * @file snapshot.cpp
+ * @brief Snapshot encoding, restoring and forked background writes.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "snapshot.hpp"
+#include "session_log.hpp"
+#include "../util/crc32.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Buffered write() to a file descriptor with a running CRC
+ *
+ * @details The buffer is a plain member, nothing here allocates, which
+ * is what makes writing from a forked child safe.
+ */
+class SnapshotOutput {
+public:
+    explicit SnapshotOutput(int fd) : fd(fd) {}
+
+    void put(const void* data, size_t count){
+        crc = crc32(data, count, crc);
+        total += count;
+        // Big arrays go straight out instead of through the buffer
+        if (count >= sizeof(buffer)) {
+            flush();
+            writeAll(static_cast<const char*>(data), count);
+            return;
+        }
+        if (used + count > sizeof(buffer)) {flush();}
+        std::memcpy(buffer + used, data, count);
+        used += count;
+    }
+
+    template <typename T>
+    void put(const T& value) { put(&value, sizeof(value)); }
+
+    void section(SnapshotSection tag, uint64_t payload_bytes){
+        put(SnapshotSectionHeader{uint32_t(tag), 0, payload_bytes});
+    }
+
+    void flush(){
+        writeAll(buffer, used);
+        used = 0;
+    }
+
+    uint32_t checksum() const { return crc; }
+    uint64_t bytes() const { return total; }
+    bool ok() const { return !failed; }
+
+private:
+    void writeAll(const char* data, size_t count){
+        while (count > 0 && !failed) {
+            const ssize_t written = ::write(fd, data, count);
+            if (written < 0 && errno == EINTR) {continue;}
+            if (written <= 0) {failed = true; return;}
+            data += written;
+            count -= size_t(written);
+        }
+    }
+
+    int fd;
+    char buffer[64 * 1024];
+    size_t used = 0;
+    uint32_t crc = 0;
+    uint64_t total = 0;
+    bool failed = false;
+};
+
+/**
+ * @brief Bounds-checked reads from a loaded snapshot
+ */
+struct SnapshotInput {
+    const char* data;
+    size_t size;
+    size_t position = 0;
+
+    bool get(void* out, size_t count){
+        if (count > size - position) {return false;}
+        std::memcpy(out, data + position, count);
+        position += count;
+        return true;
+    }
+
+    template <typename T>
+    bool get(T& value) { return get(&value, sizeof(value)); }
+};
+
+} // namespace
+
+bool writeSnapshotFile(const char* path, const RuntimeState& state){
+    char tmp_path[4096];
+    const size_t path_length = std::strlen(path);
+    if (path_length + sizeof(".tmp") > sizeof(tmp_path)) {return false;}
+    std::memcpy(tmp_path, path, path_length);
+    std::memcpy(tmp_path + path_length, ".tmp", sizeof(".tmp"));
+    const int fd = ::open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {return false;}
+
+    SnapshotOutput out(fd);
+    SnapshotFileHeader header{};
+    std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+    header.version = snapshot_version;
+    header.header_bytes = sizeof(header);
+    header.created_unix_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    out.put(header);
+
+    // Grid
+    const OccupancyGrid& grid = state.grid;
+    const size_t cells = size_t(grid.width()) * grid.height();
+    out.section(SnapshotSection::Grid, 5*4 + cells);
+    out.put(int32_t(grid.width()));
+    out.put(int32_t(grid.height()));
+    out.put(grid.resolution());
+    out.put(grid.origin().x);
+    out.put(grid.origin().y);
+    out.put(grid.data(), cells);
+
+    // Coverage, same shape as the grid
+    out.section(SnapshotSection::Coverage, cells * (sizeof(uint16_t) + sizeof(uint8_t) + sizeof(uint32_t)));
+    out.put(state.coverage.observationData(), cells * sizeof(uint16_t));
+    out.put(state.coverage.incidenceData(), cells * sizeof(uint8_t));
+    out.put(state.coverage.lastSeenData(), cells * sizeof(uint32_t));
+
+    // Trail and per-degree measurements, walked in place
+    out.section(SnapshotSection::Trail, sizeof(uint64_t) + state.trail.size() * 2 * sizeof(int32_t));
+    out.put(uint64_t(state.trail.size()));
+    for (const auto& [degree, distance] : state.trail) {
+        out.put(int32_t(degree));
+        out.put(int32_t(distance));
+    }
+    out.section(SnapshotSection::Measurements, sizeof(uint64_t) + state.measurements.size() * 2 * sizeof(int32_t));
+    out.put(uint64_t(state.measurements.size()));
+    for (const auto& [degree, distance] : state.measurements) {
+        out.put(int32_t(degree));
+        out.put(int32_t(distance));
+    }
+
+    out.section(SnapshotSection::Pose, 3*sizeof(float) + sizeof(uint64_t));
+    out.put(state.pose.x);
+    out.put(state.pose.y);
+    out.put(state.pose.theta);
+    out.put(uint64_t(state.sweeps));
+
+    SnapshotTrailer trailer{};
+    std::memcpy(trailer.magic, snapshot_end_magic, sizeof(trailer.magic));
+    trailer.crc = out.checksum();
+    trailer.file_bytes = out.bytes() + sizeof(trailer);
+    out.put(trailer);
+    out.flush();
+
+    const bool ok = out.ok() && ::fsync(fd) == 0;
+    ::close(fd);
+    return ok && std::rename(tmp_path, path) == 0;
+}
+
+bool restoreSnapshot(const std::string& path, RuntimeState& state){
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Error opening snapshot: " << path << std::endl;
+        return false;
+    }
+    std::vector<char> bytes(size_t(file.tellg()));
+    file.seekg(0);
+    if (!file.read(bytes.data(), std::streamsize(bytes.size()))
+        || bytes.size() < sizeof(SnapshotFileHeader) + sizeof(SnapshotTrailer)) {
+        std::cerr << "Snapshot is cut short: " << path << std::endl;
+        return false;
+    }
+
+    // Whole-file checks before anything is touched
+    SnapshotFileHeader header;
+    SnapshotTrailer trailer;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    std::memcpy(&trailer, bytes.data() + bytes.size() - sizeof(trailer), sizeof(trailer));
+    if (std::memcmp(header.magic, snapshot_magic, sizeof(header.magic)) != 0
+        || std::memcmp(trailer.magic, snapshot_end_magic, sizeof(trailer.magic)) != 0
+        || trailer.file_bytes != bytes.size()
+        || crc32(bytes.data(), bytes.size() - sizeof(trailer)) != trailer.crc) {
+        std::cerr << "Snapshot is damaged: " << path << std::endl;
+        return false;
+    }
+    if (header.version != snapshot_version || header.header_bytes < sizeof(header)) {
+        std::cerr << "Unsupported snapshot version " << header.version << ": " << path << std::endl;
+        return false;
+    }
+
+    // Decode into locals first so a bad section leaves the state as it was
+    std::optional<OccupancyGrid> grid;
+    std::optional<CoverageMap> coverage;
+    std::deque<std::pair<int, int>> trail;
+    std::map<int, int> measurements;
+    Pose2 pose = state.pose;
+    uint64_t sweeps = state.sweeps;
+
+    SnapshotInput in{bytes.data(), bytes.size() - sizeof(trailer), header.header_bytes};
+    SnapshotSectionHeader section;
+    while (in.get(section)) {
+        if (section.payload_bytes > in.size - in.position) {break;}
+        SnapshotInput payload{in.data + in.position, size_t(section.payload_bytes)};
+        in.position += size_t(section.payload_bytes);
+        bool ok = true;
+
+        switch (SnapshotSection(section.tag)) {
+            case SnapshotSection::Grid: {
+                int32_t width, height;
+                float resolution;
+                Vec2 origin;
+                ok = payload.get(width) && payload.get(height) && payload.get(resolution)
+                     && payload.get(origin.x) && payload.get(origin.y) && width > 0 && height > 0
+                     && payload.size - payload.position == size_t(width) * height;
+                if (ok) {
+                    grid.emplace(width, height, resolution, origin);
+                    payload.get(grid->data(), size_t(width) * height);
+                    grid->markModified();
+                    coverage.emplace(*grid);
+                }
+                break;
+            }
+            case SnapshotSection::Coverage: {
+                ok = bool(grid);
+                const size_t cells = ok ? size_t(grid->width()) * grid->height() : 0;
+                ok = ok && payload.get(coverage->observationData(), cells * sizeof(uint16_t))
+                     && payload.get(coverage->incidenceData(), cells * sizeof(uint8_t))
+                     && payload.get(coverage->lastSeenData(), cells * sizeof(uint32_t));
+                break;
+            }
+            case SnapshotSection::Trail:
+            case SnapshotSection::Measurements: {
+                uint64_t count = 0;
+                ok = payload.get(count) && count * 2 * sizeof(int32_t) == payload.size - payload.position;
+                for (uint64_t i = 0; ok && i < count; i++) {
+                    int32_t degree = 0, distance = 0;
+                    payload.get(degree);
+                    payload.get(distance);
+                    if (SnapshotSection(section.tag) == SnapshotSection::Trail) {
+                        trail.emplace_back(degree, distance);
+                    } else {
+                        measurements[degree] = distance;
+                    }
+                }
+                break;
+            }
+            case SnapshotSection::Pose:
+                ok = payload.get(pose.x) && payload.get(pose.y) && payload.get(pose.theta) && payload.get(sweeps);
+                break;
+            default:
+                break;   // newer section, not ours to read
+        }
+        if (!ok) {
+            std::cerr << "Snapshot section " << section.tag << " doesn't fit: " << path << std::endl;
+            return false;
+        }
+    }
+
+    // A snapshot always has a grid, but keep the current one if it didn't
+    if (grid) {
+        state.grid = std::move(*grid);
+        state.coverage = std::move(*coverage);
+    }
+    state.trail = std::move(trail);
+    state.measurements = std::move(measurements);
+    state.pose = pose;
+    state.sweeps = sweeps;
+    return true;
+}
+
+SnapshotWriter::~SnapshotWriter(){
+    wait();
+}
+
+bool SnapshotWriter::start(const RuntimeState& state){
+    poll();
+    if (busy()) {return false;}
+
+    const auto before = std::chrono::steady_clock::now();
+    const pid_t pid = fork();
+    if (pid == 0) {
+        // Child: write and leave without running any destructors or
+        // touching the parent's threads, buffers or windows
+        _exit(writeSnapshotFile(path.c_str(), state) ? 0 : 1);
+    }
+    const double fork_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - before).count();
+    if (pid < 0) {
+        std::cerr << "Error forking snapshot writer: " << std::strerror(errno) << std::endl;
+        snapshot_stats.failed++;
+        return false;
+    }
+    child = pid;
+    snapshot_stats.last_fork_us = fork_us;
+    snapshot_stats.worst_fork_us = std::max(snapshot_stats.worst_fork_us, fork_us);
+    return true;
+}
+
+void SnapshotWriter::collect(int status){
+    child = -1;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        snapshot_stats.written++;
+    } else {
+        snapshot_stats.failed++;
+        std::cerr << "Snapshot to " << path << " failed" << std::endl;
+    }
+}
+
+void SnapshotWriter::poll(){
+    if (!busy()) {return;}
+    int status;
+    if (waitpid(child, &status, WNOHANG) == child) {collect(status);}
+}
+
+void SnapshotWriter::wait(){
+    if (!busy()) {return;}
+    int status;
+    while (waitpid(child, &status, 0) < 0 && errno == EINTR) {}
+    collect(status);
+}
@@ -0,0 +1,144 @@
+/**
+ * @file snapshot.hpp
+ * @brief Saves and restores the program's runtime state for fast restarts.
+ *
+ * @details A snapshot file is a SnapshotFileHeader, tagged sections (a
+ * SnapshotSectionHeader and its payload each), and a SnapshotTrailer
+ * with a CRC-32 of everything before it.  Sections a reader doesn't
+ * know are skipped, so later versions can add state without breaking
+ * old snapshots.  Everything is little-endian.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include "../mapping/coverage_map.hpp"
+#include "../mapping/occupancy_grid.hpp"
+#include "../mapping/scan.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <sys/types.h>
+#include <utility>
+
+const char snapshot_magic[4] = {'U', 'S', 'S', 'S'};
+const char snapshot_end_magic[4] = {'U', 'S', 'S', 'E'};
+const uint16_t snapshot_version = 1;
+
+struct SnapshotFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t header_bytes;
+    int64_t created_unix_ns;
+};
+
+enum class SnapshotSection : uint32_t {
+    Grid = 1,           // width, height, resolution, origin, then the cells
+    Coverage = 2,       // observation, incidence and last-seen layers
+    Trail = 3,          // recent (degree, distance) pairs, newest first
+    Measurements = 4,   // first distance seen at each degree
+    Pose = 5,           // scanner pose and sweep count
+};
+
+struct SnapshotSectionHeader {
+    uint32_t tag;
+    uint32_t reserved;
+    uint64_t payload_bytes;
+};
+
+struct SnapshotTrailer {
+    char magic[4];
+    uint32_t crc;           // crc32 of the whole file before the trailer
+    uint64_t file_bytes;    // trailer included
+};
+
+static_assert(sizeof(SnapshotFileHeader) == 16, "snapshot header layout changed");
+static_assert(sizeof(SnapshotSectionHeader) == 16, "snapshot section layout changed");
+static_assert(sizeof(SnapshotTrailer) == 16, "snapshot trailer layout changed");
+
+/**
+ * @brief Everything a snapshot covers, by reference to where main keeps it
+ */
+struct RuntimeState {
+    OccupancyGrid& grid;
+    CoverageMap& coverage;
+    std::deque<std::pair<int, int>>& trail;
+    std::map<int, int>& measurements;
+    Pose2& pose;
+    uint64_t& sweeps;
+};
+
+/**
+ * @brief Writes a snapshot to PATH.tmp and renames it over path
+ *
+ * @details Only uses open, write, fsync, rename and close and never
+ * allocates, so it is safe to call in a child forked from a process
+ * with other threads running.
+ *
+ * @param path Snapshot file
+ * @param state What to save
+ */
+bool writeSnapshotFile(const char* path, const RuntimeState& state);
+
+/**
+ * @brief Loads a snapshot into the state, false (state untouched) if the
+ * file is missing, damaged or doesn't fit
+ *
+ * @param path Snapshot file
+ * @param state Where to put it
+ */
+bool restoreSnapshot(const std::string& path, RuntimeState& state);
+
+struct SnapshotStats {
+    uint64_t written = 0;
+    uint64_t failed = 0;
+    double last_fork_us = 0;     // how long the caller was paused
+    double worst_fork_us = 0;
+};
+
+/**
+ * @brief Takes snapshots in the background with fork()
+ *
+ * @details The child gets a copy-on-write view of the whole process as
+ * it was at the fork, writes it out and exits, so the caller is only
+ * paused for as long as fork() takes to copy the page tables, not for
+ * the write.  Only one snapshot is in flight at a time.
+ */
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::string path) : path(std::move(path)) {}
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    /**
+     * @brief Forks a child to write the state, false if one is still
+     * running or fork failed
+     */
+    bool start(const RuntimeState& state);
+
+    /**
+     * @brief Collects a finished child without blocking
+     */
+    void poll();
+
+    /**
+     * @brief Blocks until the running child (if any) is done
+     */
+    void wait();
+
+    bool busy() const { return child > 0; }
+    const SnapshotStats& stats() const { return snapshot_stats; }
+
+private:
+    void collect(int status);
+
+    std::string path;
+    pid_t child = -1;
+    SnapshotStats snapshot_stats;
+};
@@ -0,0 +1,247 @@
+/**
+ * @file compact_log_check.cpp
+ * @brief Writes compact logs, damages them on purpose and checks what
+ * the reader gets back.
+ *
+ * @details Each case writes the same samples through CompactLogWriter
+ * (small blocks, so there are plenty of them), optionally changes some
+ * bytes of the file, then reads it with CompactLogReader::nextBlock and
+ * with blocks()/decodeBlock.  A case passes when the samples that come
+ * back are exactly the written ones less the damaged blocks, and the
+ * damage was counted.  The cases:
+ *
+ *   round trip       untouched, every sample back bit for bit
+ *   payload byte     one payload byte flipped, that block lost
+ *   payload size     a block's payload_bytes set to 0x7fffffff, only
+ *                    that block lost, not the rest of the log
+ *   header field     a block's timestamp changed, caught by header_crc
+ *   cut short        the file ends mid-block, which isn't damage
+ *
+ *     compact_log_check [--dir DIR]
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "../session/compact_log.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t sample_count = 100000;
+const size_t block_samples = 64;
+
+struct Written {
+    CompactSample sample;
+    uint16_t sensor;
+};
+
+/**
+ * @brief Sweeps with the odd negative distance and clock jump, from a
+ * fixed seed so every run writes the same
+ *
+ * @details The sensor changes every block_samples samples, so every
+ * block but the last is full and block i holds samples i*block_samples
+ * onwards.
+ */
+std::vector<Written> testSamples(){
+    std::vector<Written> samples;
+    uint32_t state = 777;
+    auto next = [&state](){
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    };
+    uint64_t timestamp_ns = 1000000000;
+    int degree = 0, step = 1;
+    for (size_t i = 0; i < sample_count; i++) {
+        timestamp_ns += 30000000 + next() % 1000;
+        if (next() % 5000 == 0) {timestamp_ns += uint64_t(next()) << 12;}
+        if (degree + step > 180 || degree + step < 0) {step = -step;}
+        degree += step;
+        int distance = int(next() % 400);
+        if (next() % 1000 == 0) {distance = -int(next() % 100000);}
+        samples.push_back(Written{CompactSample{timestamp_ns, degree, distance}, uint16_t(i / block_samples % 4)});
+    }
+    return samples;
+}
+
+bool writeLog(const std::filesystem::path& path, const std::vector<Written>& samples){
+    std::filesystem::remove(path);
+    CompactLogWriter writer(block_samples, std::chrono::milliseconds(1000000));
+    if (!writer.open(path.string(), FsyncPolicy{})) {return false;}
+    for (const Written& written : samples) {
+        writer.append(written.sample.timestamp_ns,
+                      ParsedSample{written.sample.degree, written.sample.distance_cm}, written.sensor);
+    }
+    writer.close();
+    return writer.stats().bytes_dropped == 0;
+}
+
+std::vector<uint8_t> readFile(const std::filesystem::path& path){
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+bool writeFile(const std::filesystem::path& path, const std::vector<uint8_t>& bytes){
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+    return bool(out);
+}
+
+/**
+ * @brief Offset of every block, walked from the headers of an undamaged log
+ */
+std::vector<size_t> blockOffsets(const std::vector<uint8_t>& log){
+    std::vector<size_t> offsets;
+    size_t offset = sizeof(SessionFileHeader);
+    while (offset + sizeof(CompactBlockHeader) <= log.size()) {
+        CompactBlockHeader header;
+        std::memcpy(&header, log.data() + offset, sizeof(header));
+        offsets.push_back(offset);
+        offset += sizeof(header) + header.payload_bytes;
+    }
+    return offsets;
+}
+
+struct ReadBack {
+    std::vector<Written> samples;
+    uint64_t corrupt = 0;
+};
+
+ReadBack readSequential(const std::filesystem::path& path){
+    ReadBack back;
+    CompactLogReader reader;
+    if (!reader.open(path.string())) {return back;}
+    std::vector<CompactSample> block;
+    uint16_t sensor;
+    while (reader.nextBlock(block, sensor)) {
+        for (const CompactSample& sample : block) {back.samples.push_back(Written{sample, sensor});}
+    }
+    back.corrupt = reader.corruptBlocks();
+    return back;
+}
+
+ReadBack readByBlocks(const std::filesystem::path& path){
+    ReadBack back;
+    CompactLogReader reader;
+    if (!reader.open(path.string())) {return back;}
+    std::vector<CompactSample> block;
+    for (const CompactBlockRef& ref : reader.blocks(&back.corrupt)) {
+        if (reader.decodeBlock(ref, block) != BlockStatus::Ok) {
+            back.corrupt++;
+            continue;
+        }
+        for (const CompactSample& sample : block) {back.samples.push_back(Written{sample, ref.sensor});}
+    }
+    return back;
+}
+
+bool same(const Written& a, const Written& b){
+    return a.sensor == b.sensor && a.sample.timestamp_ns == b.sample.timestamp_ns
+        && a.sample.degree == b.sample.degree && a.sample.distance_cm == b.sample.distance_cm;
+}
+
+/**
+ * @brief Whether got is expected with the samples of the lost blocks
+ * taken out, and the damage counted as expected
+ */
+bool matches(const ReadBack& got, const std::vector<Written>& written, const std::vector<size_t>& lost_blocks,
+             uint64_t min_corrupt, uint64_t max_corrupt){
+    std::vector<Written> expected;
+    for (size_t i = 0; i < written.size(); i++) {
+        bool lost = false;
+        for (size_t block : lost_blocks) {lost = lost || i / block_samples == block;}
+        if (!lost) {expected.push_back(written[i]);}
+    }
+    if (got.samples.size() != expected.size() || got.corrupt < min_corrupt || got.corrupt > max_corrupt) {
+        std::cout << "    got " << got.samples.size() << " samples, " << got.corrupt << " corrupt, expected "
+                  << expected.size() << " samples, " << min_corrupt << "-" << max_corrupt << " corrupt" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); i++) {
+        if (!same(got.samples[i], expected[i])) {
+            std::cout << "    sample " << i << " differs" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) {
+            dir = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--dir DIR]" << std::endl;
+            return 1;
+        }
+    }
+
+    const std::vector<Written> samples = testSamples();
+
+    const std::filesystem::path clean = dir / "compact_log_check.ucl";
+    const std::filesystem::path damaged = dir / "compact_log_check_damaged.ucl";
+    if (!writeLog(clean, samples)) {
+        std::cerr << "Error writing " << clean << std::endl;
+        return 1;
+    }
+    const std::vector<uint8_t> log = readFile(clean);
+    const std::vector<size_t> offsets = blockOffsets(log);
+    std::cout << samples.size() << " samples in " << offsets.size() << " blocks, " << log.size() << " bytes" << std::endl;
+
+    struct Case {
+        const char* name;
+        void (*damage)(std::vector<uint8_t>& log, const std::vector<size_t>& offsets);
+        std::vector<size_t> lost_blocks;
+        uint64_t min_corrupt, max_corrupt;
+    };
+    // A resync can also stop at a sync word that happens to be in a
+    // payload, which counts once more, hence the ranges
+    const std::vector<Case> cases = {
+        {"round trip", [](std::vector<uint8_t>&, const std::vector<size_t>&) {}, {}, 0, 0},
+        {"payload byte", [](std::vector<uint8_t>& bytes, const std::vector<size_t>& at) {
+            bytes[at[10] + sizeof(CompactBlockHeader) + 7] ^= 0x40;
+        }, {10}, 1, 1},
+        {"payload size", [](std::vector<uint8_t>& bytes, const std::vector<size_t>& at) {
+            const uint32_t size = 0x7fffffff;
+            std::memcpy(bytes.data() + at[10] + offsetof(CompactBlockHeader, payload_bytes), &size, sizeof(size));
+        }, {10}, 1, 2},
+        {"header field", [](std::vector<uint8_t>& bytes, const std::vector<size_t>& at) {
+            bytes[at[500] + offsetof(CompactBlockHeader, base_timestamp_ns)] ^= 0x01;
+        }, {500}, 1, 2},
+        {"cut short", [](std::vector<uint8_t>& bytes, const std::vector<size_t>& at) {
+            bytes.resize(at.back() + sizeof(CompactBlockHeader) + 5);
+        }, {(sample_count - 1) / block_samples}, 0, 0},
+    };
+
+    bool passed = true;
+    for (const Case& test : cases) {
+        std::vector<uint8_t> bytes = log;
+        test.damage(bytes, offsets);
+        if (!writeFile(damaged, bytes)) {
+            std::cerr << "Error writing " << damaged << std::endl;
+            return 1;
+        }
+        const bool sequential = matches(readSequential(damaged), samples, test.lost_blocks,
+                                        test.min_corrupt, test.max_corrupt);
+        const bool by_blocks = matches(readByBlocks(damaged), samples, test.lost_blocks,
+                                       test.min_corrupt, test.max_corrupt);
+        std::cout << std::left << std::setw(14) << test.name << " nextBlock " << (sequential ? "ok  " : "FAIL")
+                  << " blocks " << (by_blocks ? "ok" : "FAIL") << std::endl;
+        passed = passed && sequential && by_blocks;
+    }
+    std::filesystem::remove(clean);
+    std::filesystem::remove(damaged);
+    return passed ? 0 : 1;
+}
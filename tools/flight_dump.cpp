@@ -0,0 +1,64 @@
+/**
+ * @file flight_dump.cpp
+ * @brief Prints what a flight recorder ring held when the program stopped.
+ *
+ * @details Times are seconds since the recorder was opened, the last
+ * lines are what led up to the crash (or clean shutdown).
+ *
+ *     flight_dump [--events] [--last N] RING_FILE
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "../session/flight_recorder.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv){
+    bool events_only = false;
+    size_t last = 0;
+    std::string path;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--events") {
+            events_only = true;
+        } else if (arg == "--last" && i + 1 < argc) {
+            last = std::stoul(argv[++i]);
+        } else if (arg[0] != '-' && path.empty()) {
+            path = arg;
+        } else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--events] [--last N] RING_FILE" << std::endl;
+        return 1;
+    }
+
+    FlightLogInfo info;
+    std::vector<FlightEntry> entries;
+    if (!readFlightLog(path, info, entries)) {return 1;}
+    std::cout << entries.size() << " of " << info.total_entries << " entries kept (ring of "
+              << info.capacity << ")" << std::endl;
+
+    size_t first = last > 0 && last < entries.size() ? entries.size() - last : 0;
+    std::cout << std::fixed << std::setprecision(3);
+    for (size_t i = first; i < entries.size(); i++) {
+        const FlightEntry& entry = entries[i];
+        if (events_only && entry.kind != uint8_t(FlightEntryKind::Event)) {continue;}
+        std::cout << std::setw(10) << (int64_t(entry.timestamp_ns) - int64_t(info.start_steady_ns)) / 1e9 << " s  ";
+        if (entry.kind == uint8_t(FlightEntryKind::Sample)) {
+            std::cout << "sample " << entry.degree << " deg " << entry.value << " cm";
+        } else if (entry.kind == uint8_t(FlightEntryKind::Event)) {
+            std::cout << "event " << flightEventName(entry.code) << " " << entry.value;
+        } else {
+            std::cout << "unreadable entry";
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
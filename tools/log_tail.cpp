@@ -0,0 +1,107 @@
+/**
+ * @file log_tail.cpp
+ * @brief Follows a compact log as it is recorded and prints what arrives.
+ *
+ * @details Ends when the recording program closes the log (or on
+ * Ctrl-C) and then prints how old the newest and oldest sample of each
+ * block were when it got here.  The oldest is the delay a live consumer
+ * sees for a sample, and is about the writer's block time.
+ *
+ *     log_tail [--quiet] [--end] [--timeout MS] LOG
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "../session/log_tailer.hpp"
+#include "../session/session_log.hpp"
+
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+#include <string>
+
+namespace {
+
+volatile std::sig_atomic_t keep_running = 1;
+
+void stopRunning(int){
+    keep_running = 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+    bool quiet = false, from_start = true;
+    int timeout_ms = -1;
+    std::string path;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--quiet") {
+            quiet = true;
+        } else if (arg == "--end") {
+            from_start = false;
+        } else if (arg == "--timeout" && i + 1 < argc) {
+            timeout_ms = std::stoi(argv[++i]);
+        } else if (arg[0] != '-' && path.empty()) {
+            path = arg;
+        } else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--quiet] [--end] [--timeout MS] LOG" << std::endl;
+        return 1;
+    }
+
+    CompactLogTailer tailer;
+    if (!tailer.open(path, from_start)) {return 1;}
+    std::signal(SIGINT, stopRunning);
+
+    // Wake up now and then so Ctrl-C is noticed even when the log is quiet
+    const int step_ms = timeout_ms >= 0 ? std::min(timeout_ms, 200) : 200;
+    int idle_ms = 0;
+    std::vector<CompactSample> block;
+    uint16_t sensor;
+    uint64_t blocks = 0, samples = 0;
+    double age_sum_ms = 0, worst_age_ms = 0;
+    double oldest_age_sum_ms = 0, worst_oldest_age_ms = 0;
+    while (keep_running) {
+        const TailStatus status = tailer.next(block, sensor, step_ms);
+        if (status == TailStatus::Finished || status == TailStatus::Error) {break;}
+        if (status == TailStatus::Timeout) {
+            idle_ms += step_ms;
+            if (timeout_ms >= 0 && idle_ms >= timeout_ms) {break;}
+            continue;
+        }
+        idle_ms = 0;
+
+        // Only meaningful on the machine doing the recording, both sides
+        // read the same steady clock
+        const int64_t now_ns = int64_t(monotonicNanoseconds());
+        const double age_ms = (now_ns - int64_t(block.back().timestamp_ns)) / 1e6;
+        const double oldest_age_ms = (now_ns - int64_t(block.front().timestamp_ns)) / 1e6;
+        age_sum_ms += age_ms;
+        worst_age_ms = std::max(worst_age_ms, age_ms);
+        oldest_age_sum_ms += oldest_age_ms;
+        worst_oldest_age_ms = std::max(worst_oldest_age_ms, oldest_age_ms);
+        blocks++;
+        samples += block.size();
+        if (!quiet) {
+            for (const CompactSample& sample : block) {
+                std::cout << sample.timestamp_ns << " " << sensor << " " << sample.degree << " "
+                          << sample.distance_cm << "\n";
+            }
+            std::cout.flush();
+        }
+    }
+
+    std::cerr << blocks << " blocks, " << samples << " samples, " << tailer.corruptBlocks() << " damaged";
+    if (blocks > 0) {
+        std::cerr << ", newest sample age on arrival avg " << age_sum_ms / blocks << " ms, worst " << worst_age_ms << " ms"
+                  << ", oldest avg " << oldest_age_sum_ms / blocks << " ms, worst " << worst_oldest_age_ms << " ms";
+    }
+    std::cerr << std::endl;
+    return 0;
+}
@@ -0,0 +1,246 @@
+/**
+ * @file render_check.cpp
+ * @brief Renders fixed sample sequences through the reference radar
+ * drawing and every faster path, and checks they look the same.
+ *
+ * @details Each sequence is drawn first with updateRadar, keeping every
+ * frame, then with each other path from the same starting state, and
+ * each frame is compared against the reference one.  A path passes when
+ * its worst frame stays above --min-psnr and --min-ssim.  Drawing time
+ * (the update calls only, best of --repeat runs) is reported next to the
+ * quality, so a speedup and what it costs are read off the same line.
+ *
+ * With --golden DIR the last reference frame of each sequence is also
+ * checked against DIR/SEQUENCE.png, written there the first time (or with
+ * --update-golden), which catches the reference itself drifting, say
+ * after an opencv upgrade.
+ *
+ *     render_check [--min-psnr DB] [--min-ssim S] [--repeat N]
+ *                  [--golden DIR [--update-golden]]
+ *
+ * Needs opencv but no window.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "../ingest/arduino_emulator.hpp"
+#include "../ingest/sample_parser.hpp"
+#include "../mapping/coverage_map.hpp"
+#include "../mapping/occupancy_grid.hpp"
+#include "../render/image_quality.hpp"
+#include "../render/radar.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct RenderPath {
+    const char* name;
+    void (*update)(cv::Mat&, const int, const int, const CoverageMap*);
+};
+
+// The first is the reference the others are held to
+const RenderPath render_paths[] = {
+    {"reference", updateRadar},
+    {"cached", updateRadarCached},
+};
+
+struct Sequence {
+    std::string name;
+    std::vector<ParsedSample> samples;
+    bool coverage = false;
+};
+
+/**
+ * @brief The arduino's sweep, through the real parser
+ */
+std::vector<ParsedSample> emulatedSweeps(int sweeps){
+    ArduinoEmulator arduino;
+    std::string stream;
+    for (int i = 0; i < sweeps * 360; i++) {arduino.next(stream);}
+    std::vector<ParsedSample> samples;
+    SampleParser parser;
+    parser.feed(stream.data(), stream.size(), [&](const ParsedSample& sample){ samples.push_back(sample); });
+    return samples;
+}
+
+/**
+ * @brief Jumps all over, through every distance case (blip, no blip,
+ * "Nothing"), from a fixed seed so every run draws the same
+ */
+std::vector<ParsedSample> scatteredSamples(size_t count){
+    std::vector<ParsedSample> samples;
+    uint32_t state = 12345;
+    auto next = [&state](){
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    };
+    for (size_t i = 0; i < count; i++) {
+        samples.push_back(ParsedSample{int(next() % 181), int(next() % 80)});
+    }
+    return samples;
+}
+
+/**
+ * @brief Map and coverage state for the coverage tint, rebuilt for each
+ * path so they all see the same
+ */
+struct MappingState {
+    OccupancyGrid grid{400, 400, 1.0f, Vec2{-200, -200}};
+    CoverageMap coverage{grid};
+
+    void integrate(const ParsedSample& sample){
+        if (sample.distance_cm > 1) {
+            grid.integrateRay(Pose2(), sample.degree, sample.distance_cm, 50, &coverage);
+        }
+    }
+};
+
+struct PathResult {
+    double best_ms = std::numeric_limits<double>::infinity();
+    double min_psnr = std::numeric_limits<double>::infinity();
+    double min_ssim = 1;
+};
+
+ImageView view(const cv::Mat& frame){
+    return ImageView{frame.data, frame.cols, frame.rows, frame.step, frame.channels()};
+}
+
+/**
+ * @brief Draws a sequence with one path, comparing against the reference
+ * frames if there are any and keeping the frames if asked to
+ */
+PathResult runPath(const RenderPath& path, const Sequence& sequence, int repeat,
+                   const std::vector<cv::Mat>* reference, std::vector<cv::Mat>* keep){
+    PathResult result;
+    for (int run = 0; run < repeat; run++) {
+        line_deque.clear();
+        std::unique_ptr<MappingState> mapping;
+        if (sequence.coverage) {mapping = std::make_unique<MappingState>();}
+        cv::Mat frame;
+        drawRadar(frame);
+
+        double drawing_ns = 0;
+        for (size_t i = 0; i < sequence.samples.size(); i++) {
+            const ParsedSample& sample = sequence.samples[i];
+            if (mapping) {mapping->integrate(sample);}
+            const auto start = std::chrono::steady_clock::now();
+            path.update(frame, sample.degree, sample.distance_cm, mapping ? &mapping->coverage : nullptr);
+            drawing_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+            if (run > 0) {continue;}
+            if (keep) {keep->push_back(frame.clone());}
+            if (reference) {
+                // Identical frames are the usual case, and SSIM is the slow one
+                const double frame_psnr = psnr(view(frame), view((*reference)[i]));
+                result.min_psnr = std::min(result.min_psnr, frame_psnr);
+                if (std::isfinite(frame_psnr)) {
+                    result.min_ssim = std::min(result.min_ssim, ssim(view(frame), view((*reference)[i])));
+                }
+            }
+        }
+        result.best_ms = std::min(result.best_ms, drawing_ns / 1e6);
+    }
+    line_deque.clear();
+    return result;
+}
+
+void printRow(const std::string& sequence, const std::string& path, size_t frames, double ms_per_frame,
+              double speedup, double min_psnr, double min_ssim, bool ok){
+    std::cout << std::left << std::setw(10) << sequence << std::setw(11) << path << std::right
+              << std::setw(7) << frames;
+    if (ms_per_frame >= 0) {
+        std::cout << std::setprecision(4) << std::setw(11) << ms_per_frame
+                  << std::setprecision(2) << std::setw(8) << speedup << "x";
+    } else {
+        std::cout << std::setw(11) << "-" << std::setw(9) << "-";
+    }
+    std::cout << std::setprecision(2) << std::setw(10) << min_psnr
+              << std::setprecision(4) << std::setw(10) << min_ssim << "  " << (ok ? "ok" : "FAIL") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+    double min_psnr = 40;
+    double min_ssim = 0.99;
+    int repeat = 3;
+    std::string golden_dir;
+    bool update_golden = false;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--min-psnr" && i + 1 < argc) {
+            min_psnr = std::stod(argv[++i]);
+        } else if (arg == "--min-ssim" && i + 1 < argc) {
+            min_ssim = std::stod(argv[++i]);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--golden" && i + 1 < argc) {
+            golden_dir = argv[++i];
+        } else if (arg == "--update-golden") {
+            update_golden = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--min-psnr DB] [--min-ssim S] [--repeat N]"
+                      << " [--golden DIR [--update-golden]]" << std::endl;
+            return 1;
+        }
+    }
+
+    const std::vector<Sequence> sequences = {
+        {"sweep", emulatedSweeps(2), false},
+        {"scattered", scatteredSamples(500), false},
+        {"coverage", emulatedSweeps(2), true},
+    };
+
+    std::cout << std::fixed << std::left << std::setw(10) << "sequence" << std::setw(11) << "path" << std::right
+              << std::setw(7) << "frames" << std::setw(11) << "ms/frame" << std::setw(9) << "speedup"
+              << std::setw(10) << "min PSNR" << std::setw(10) << "min SSIM" << "  result" << std::endl;
+    bool passed = true;
+    for (const Sequence& sequence : sequences) {
+        const size_t frames = sequence.samples.size();
+        std::vector<cv::Mat> reference;
+        const PathResult base = runPath(render_paths[0], sequence, repeat, nullptr, &reference);
+        printRow(sequence.name, render_paths[0].name, frames, base.best_ms / frames, 1, base.min_psnr, 1, true);
+
+        for (size_t p = 1; p < std::size(render_paths); p++) {
+            const PathResult result = runPath(render_paths[p], sequence, repeat, &reference, nullptr);
+            const bool ok = result.min_psnr >= min_psnr && result.min_ssim >= min_ssim;
+            passed = passed && ok;
+            printRow(sequence.name, render_paths[p].name, frames, result.best_ms / frames,
+                     base.best_ms / result.best_ms, result.min_psnr, result.min_ssim, ok);
+        }
+
+        if (golden_dir.empty() || reference.empty()) {continue;}
+        const std::string golden_path = golden_dir + "/" + sequence.name + ".png";
+        const cv::Mat golden = update_golden ? cv::Mat() : cv::imread(golden_path, cv::IMREAD_COLOR);
+        if (golden.empty()) {
+            if (!cv::imwrite(golden_path, reference.back())) {
+                std::cerr << "Error writing golden image: " << golden_path << std::endl;
+                return 1;
+            }
+            std::cout << "Wrote " << golden_path << std::endl;
+            continue;
+        }
+        if (golden.size() != reference.back().size() || golden.channels() != reference.back().channels()) {
+            std::cerr << "Golden image is a different size: " << golden_path << std::endl;
+            passed = false;
+            continue;
+        }
+        const double golden_psnr = psnr(view(reference.back()), view(golden));
+        const double golden_ssim = ssim(view(reference.back()), view(golden));
+        const bool ok = golden_psnr >= min_psnr && golden_ssim >= min_ssim;
+        passed = passed && ok;
+        printRow(sequence.name, "golden", 1, -1, 0, golden_psnr, golden_ssim, ok);
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,356 @@
+/**
+ * @file saturation_bench.cpp
+ * @brief Drives the whole host program through an emulated arduino at
+ * rising sample rates and finds the fastest it keeps up with.
+ *
+ * @details Each step starts the host fresh on the slave end of a pty,
+ * with --headless --latency --metrics, and plays the arduino's sweep
+ * ("degree:distance|", 1 to 180 and back) into the master end at a fixed
+ * rate.  The host's metrics are scraped while it runs.  A step passes
+ * when, after a short drain, every sample sent was handled without parse
+ * errors or dropped log bytes, the samples still queued in the pty never
+ * got past --max-backlog-ms worth of input, and the p99 sample-to-frame
+ * latency (headless, so up to the drawn frame) stayed within --slo-ms.
+ * The rate grows by --factor per step until one fails, then the curve
+ * and the highest passing rate are printed.
+ *
+ *     saturation_bench [--host PATH] [--start N] [--factor F] [--max N]
+ *                      [--seconds S] [--slo-ms MS] [--max-backlog-ms MS]
+ *                      [--keep-going] [-- HOST_ARGS...]
+ *
+ * Anything after "--" goes to the host too, e.g. "-- --record /tmp/s.log"
+ * to include logging in the load.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "../ingest/arduino_emulator.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string host = "./main";
+    double start_rate = 500;
+    double factor = 1.5;
+    double max_rate = 1e6;
+    double step_seconds = 3;
+    double slo_ms = 50;
+    double max_backlog_ms = 100;
+    bool keep_going = false;
+    std::vector<std::string> host_args;
+};
+
+struct StepResult {
+    double target_rate = 0;
+    double sent_rate = 0;
+    double handled_rate = 0;
+    uint64_t sent = 0;
+    uint64_t handled = 0;
+    uint64_t max_backlog = 0;
+    double p50_ms = NAN;
+    double p99_ms = NAN;
+    uint64_t parse_errors = 0;
+    uint64_t dropped_bytes = 0;
+    std::string failure;   // empty when the host kept up
+};
+
+using Metrics = std::map<std::string, double>;
+
+double secondsSince(Clock::time_point start){
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Fetches and parses the host's metrics, "name{labels}" to value
+ */
+bool scrape(const std::string& socket_path, Metrics& metrics){
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {return false;}
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return false;
+    }
+    const char request[] = "GET /metrics HTTP/1.0\r\n\r\n";
+    if (send(fd, request, sizeof(request) - 1, MSG_NOSIGNAL) != ssize_t(sizeof(request) - 1)) {
+        close(fd);
+        return false;
+    }
+    std::string response;
+    char chunk[4096];
+    ssize_t count;
+    while ((count = recv(fd, chunk, sizeof(chunk), 0)) > 0) {response.append(chunk, size_t(count));}
+    close(fd);
+
+    const size_t body = response.find("\r\n\r\n");
+    if (response.compare(0, 12, "HTTP/1.0 200") != 0 || body == std::string::npos) {return false;}
+    metrics.clear();
+    size_t line_start = body + 4;
+    while (line_start < response.size()) {
+        size_t line_end = response.find('\n', line_start);
+        if (line_end == std::string::npos) {line_end = response.size();}
+        const std::string line = response.substr(line_start, line_end - line_start);
+        line_start = line_end + 1;
+        const size_t space = line.rfind(' ');
+        if (line.empty() || line[0] == '#' || space == std::string::npos) {continue;}
+        metrics[line.substr(0, space)] = std::strtod(line.c_str() + space + 1, nullptr);
+    }
+    return true;
+}
+
+double metric(const Metrics& metrics, const std::string& key){
+    const auto found = metrics.find(key);
+    return found == metrics.end() ? 0 : found->second;
+}
+
+/**
+ * @brief A running host and the pty it reads
+ */
+struct Host {
+    pid_t pid = -1;
+    int master = -1;
+    std::string socket_path;
+
+    ~Host(){ stop(); }
+
+    bool start(const Options& options){
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+            std::cerr << "Error opening pty: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        // Raw, so nothing is echoed back or held for a newline
+        termios tty;
+        tcgetattr(master, &tty);
+        cfmakeraw(&tty);
+        tcsetattr(master, TCSANOW, &tty);
+        fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+        const std::string slave = ptsname(master);
+
+        socket_path = "/tmp/saturation_bench." + std::to_string(getpid()) + ".sock";
+        std::vector<std::string> args = {options.host, "--port", slave, "--headless", "--latency",
+                                         "--metrics", socket_path};
+        args.insert(args.end(), options.host_args.begin(), options.host_args.end());
+
+        pid = fork();
+        if (pid == 0) {
+            const int null = open("/dev/null", O_WRONLY);
+            dup2(null, STDOUT_FILENO);
+            std::vector<char*> argv;
+            for (std::string& arg : args) {argv.push_back(arg.data());}
+            argv.push_back(nullptr);
+            execv(argv[0], argv.data());
+            std::perror("exec host");
+            _exit(127);
+        }
+        if (pid < 0) {
+            std::cerr << "Error starting host: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        // Ready once it answers a scrape
+        Metrics metrics;
+        const Clock::time_point start = Clock::now();
+        while (secondsSince(start) < 10) {
+            if (scrape(socket_path, metrics)) {return true;}
+            if (waitpid(pid, nullptr, WNOHANG) == pid) {
+                pid = -1;
+                std::cerr << "Host exited before serving metrics: " << options.host << std::endl;
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        std::cerr << "Host never served metrics on " << socket_path << std::endl;
+        return false;
+    }
+
+    void stop(){
+        if (pid > 0) {
+            kill(pid, SIGINT);
+            const Clock::time_point start = Clock::now();
+            while (waitpid(pid, nullptr, WNOHANG) != pid) {
+                if (secondsSince(start) > 5) {
+                    kill(pid, SIGKILL);
+                    waitpid(pid, nullptr, 0);
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            pid = -1;
+        }
+        if (master >= 0) {close(master);}
+        master = -1;
+    }
+};
+
+/**
+ * @brief Runs one host at one rate and judges whether it kept up
+ */
+bool runStep(const Options& options, double rate, StepResult& result){
+    result = StepResult();
+    result.target_rate = rate;
+    Host host;
+    if (!host.start(options)) {return false;}
+
+    ArduinoEmulator arduino;
+    std::string pending;          // generated but not yet taken by the pty
+    uint64_t generated = 0;
+    uint64_t pending_messages = 0;
+    Metrics metrics;
+    const size_t max_pending = 1 << 16;
+    const double backlog_limit = std::max(16.0, rate * options.max_backlog_ms / 1000);
+
+    const Clock::time_point start = Clock::now();
+    Clock::time_point next_scrape = start;
+    double elapsed = 0;
+    uint64_t due = 0;
+    while ((elapsed = secondsSince(start)) < options.step_seconds) {
+        due = uint64_t(elapsed * rate);
+        while (generated < due && pending.size() < max_pending) {
+            arduino.next(pending);
+            generated++;
+            pending_messages++;
+        }
+        if (!pending.empty()) {
+            const ssize_t written = write(host.master, pending.data(), pending.size());
+            if (written > 0) {
+                pending_messages -= uint64_t(std::count(pending.begin(), pending.begin() + written, '|'));
+                pending.erase(0, size_t(written));
+            }
+        }
+
+        if (Clock::now() >= next_scrape) {
+            next_scrape += std::chrono::milliseconds(250);
+            if (scrape(host.socket_path, metrics)) {
+                // Everything generated on time but not yet handled, whether
+                // it waits here, in the pty or in the host
+                const uint64_t handled = uint64_t(metric(metrics, "radar_samples_total"));
+                const uint64_t on_time = std::min(due, generated);
+                result.max_backlog = std::max(result.max_backlog, on_time > handled ? on_time - handled : 0);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    result.sent = generated - pending_messages;
+    result.sent_rate = result.sent / elapsed;
+
+    // Let the host finish what it was sent, or stall trying
+    uint64_t handled = 0;
+    Clock::time_point last_progress = Clock::now();
+    while (handled < result.sent && std::chrono::duration<double>(Clock::now() - last_progress).count() < 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (!scrape(host.socket_path, metrics)) {break;}
+        const uint64_t now_handled = uint64_t(metric(metrics, "radar_samples_total"));
+        if (now_handled != handled) {last_progress = Clock::now();}
+        handled = now_handled;
+    }
+    result.handled = handled;
+    result.handled_rate = std::min(result.sent, handled) / elapsed;
+    result.parse_errors = uint64_t(metric(metrics, "radar_parse_errors_total"));
+    result.dropped_bytes = uint64_t(metric(metrics, "radar_writer_dropped_bytes_total{writer=\"session\"}")
+                                  + metric(metrics, "radar_writer_dropped_bytes_total{writer=\"compact\"}"));
+    const std::string latency = "radar_stage_latency_seconds{stage=\"sample-to-frame\",quantile=\"";
+    result.p50_ms = metric(metrics, latency + "0.5\"}") * 1e3;
+    result.p99_ms = metric(metrics, latency + "0.99\"}") * 1e3;
+
+    if (handled < result.sent || result.parse_errors > 0 || result.dropped_bytes > 0) {
+        result.failure = "drops";
+    } else if (result.max_backlog > backlog_limit || generated < due) {
+        // Either fell behind, or the pty stopped taking input altogether
+        result.failure = "queue";
+    } else if (result.p99_ms > options.slo_ms) {
+        result.failure = "latency";
+    }
+    return true;
+}
+
+void printUsage(const char* program){
+    std::cerr << "Usage: " << program << " [--host PATH] [--start N] [--factor F] [--max N] [--seconds S]"
+              << " [--slo-ms MS] [--max-backlog-ms MS] [--keep-going] [-- HOST_ARGS...]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--host" && i + 1 < argc) {
+            options.host = argv[++i];
+        } else if (arg == "--start" && i + 1 < argc) {
+            options.start_rate = std::stod(argv[++i]);
+        } else if (arg == "--factor" && i + 1 < argc) {
+            options.factor = std::stod(argv[++i]);
+        } else if (arg == "--max" && i + 1 < argc) {
+            options.max_rate = std::stod(argv[++i]);
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            options.step_seconds = std::stod(argv[++i]);
+        } else if (arg == "--slo-ms" && i + 1 < argc) {
+            options.slo_ms = std::stod(argv[++i]);
+        } else if (arg == "--max-backlog-ms" && i + 1 < argc) {
+            options.max_backlog_ms = std::stod(argv[++i]);
+        } else if (arg == "--keep-going") {
+            options.keep_going = true;
+        } else if (arg == "--") {
+            options.host_args.assign(argv + i + 1, argv + argc);
+            break;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.start_rate <= 0 || options.factor <= 1 || options.step_seconds <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(12) << "target/s" << std::setw(12) << "sent/s" << std::setw(12) << "handled/s"
+              << std::setw(12) << "backlog" << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms"
+              << std::setw(8) << "errors" << "  result" << std::endl;
+    double best = 0;
+    for (double rate = options.start_rate; rate <= options.max_rate; rate *= options.factor) {
+        StepResult result;
+        if (!runStep(options, rate, result)) {return 1;}
+        std::cout << std::setw(12) << result.target_rate << std::setw(12) << result.sent_rate
+                  << std::setw(12) << result.handled_rate << std::setw(12) << result.max_backlog
+                  << std::setw(10) << result.p50_ms << std::setw(10) << result.p99_ms
+                  << std::setw(8) << result.parse_errors + result.dropped_bytes
+                  << "  " << (result.failure.empty() ? "ok" : result.failure) << std::endl;
+        if (result.failure.empty()) {
+            best = std::max(best, rate);
+        } else if (!options.keep_going) {
+            break;
+        }
+    }
+    std::cout << "Max sustained: " << std::setprecision(0) << best << " samples/s" << std::endl;
+    return 0;
+}
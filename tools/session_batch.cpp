@@ -0,0 +1,325 @@
+/**
+ * @file session_batch.cpp
+ * @brief Turns a directory of recorded sessions into maps, point clouds,
+ * statistics and thumbnails, many sessions at a time.
+ *
+ * @details Every log in the input directory (session logs and compact
+ * logs both) becomes one task on a work-stealing ThreadPool.  Biggest
+ * logs are queued first so a long session doesn't end up running alone
+ * at the end.  Per session the tool writes, into the output directory,
+ * with NAME the log's whole file name (a.log and a.ucl are both there):
+ *   - NAME.map: the compressed occupancy grid, loadable with --load-map
+ *   - NAME.pgm: the grid as a greyscale image, one pixel per cell
+ *   - NAME_thumb.pgm: a small version of the same image
+ *   - NAME.xyz: every hit as an "x y z" point in cm
+ * and stats.csv gets one line per session.
+ *
+ *     session_batch [--threads N] [--thumb PIXELS] [-o OUT_DIR] LOG_DIR
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "../ingest/sample_parser.hpp"
+#include "../mapping/compressed_grid.hpp"
+#include "../mapping/coverage_map.hpp"
+#include "../mapping/occupancy_grid.hpp"
+#include "../session/compact_log.hpp"
+#include "../session/session_reader.hpp"
+#include "../util/thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Same map setup as main, the scanner sits in the middle of the grid
+const float max_range_cm = 50;
+const int map_cells = 400;
+const float map_resolution_cm = 1.0f;
+
+struct BatchOptions {
+    std::string input_dir;
+    std::string output_dir = "batch_out";
+    size_t threads = 0;
+    int thumb_pixels = 128;
+};
+
+struct SessionStats {
+    std::string name;
+    bool ok = false;
+    uint64_t samples = 0;
+    uint64_t invalid = 0;
+    uint64_t hits = 0;
+    uint64_t sweeps = 0;
+    double duration_s = 0;
+    int min_distance_cm = 0;
+    int max_distance_cm = 0;
+    double mean_distance_cm = 0;
+    double covered_percent = 0;
+    double process_ms = 0;
+};
+
+void printUsage(const char* program){
+    std::cerr << "Usage: " << program << " [--threads N] [--thumb PIXELS] [-o OUT_DIR] LOG_DIR" << std::endl;
+}
+
+bool parseOptions(int argc, char** argv, BatchOptions& options){
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::stoul(argv[++i]);
+        } else if (arg == "--thumb" && i + 1 < argc) {
+            options.thumb_pixels = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "-o" && i + 1 < argc) {
+            options.output_dir = argv[++i];
+        } else if (arg[0] != '-' && options.input_dir.empty()) {
+            options.input_dir = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.input_dir.empty();
+}
+
+/**
+ * @brief Whether a file starts like either kind of log
+ */
+bool isLogFile(const std::filesystem::path& path){
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    if (!file.read(magic, sizeof(magic))) {return false;}
+    return std::memcmp(magic, session_log_magic, sizeof(magic)) == 0
+        || std::memcmp(magic, compact_log_magic, sizeof(magic)) == 0;
+}
+
+/**
+ * @brief Calls on_sample(timestamp_ns, sample) for every sample in a log,
+ * false if it couldn't be opened
+ *
+ * @details Session logs go through the same SampleParser as the live
+ * program, compact logs already hold samples.
+ */
+template <typename F>
+bool forEachSample(const std::string& path, uint64_t& start_ns, uint64_t& invalid, F&& on_sample){
+    if (isCompactLog(path)) {
+        CompactLogReader reader;
+        if (!reader.open(path)) {return false;}
+        start_ns = reader.header().start_steady_ns;
+        std::vector<CompactSample> block;
+        uint16_t sensor;
+        while (reader.nextBlock(block, sensor)) {
+            for (const CompactSample& sample : block) {
+                on_sample(sample.timestamp_ns, ParsedSample{sample.degree, sample.distance_cm});
+            }
+        }
+        invalid = reader.corruptBlocks();
+        return true;
+    }
+
+    SessionReader reader;
+    if (!reader.open(path)) {return false;}
+    start_ns = reader.header().start_steady_ns;
+    SampleParser parser;
+    SessionRecordHeader record;
+    const char* payload;
+    while (reader.next(record, payload)) {
+        if (record.type != uint8_t(SessionRecordType::RawChunk)) {continue;}
+        parser.feed(payload, record.payload_bytes, [&](const ParsedSample& sample){
+            on_sample(record.timestamp_ns, sample);
+        });
+    }
+    invalid = parser.invalidMessages();
+    return true;
+}
+
+/**
+ * @brief Grey level for a cell, black occupied, white free, grey unknown
+ */
+inline uint8_t cellShade(int8_t log_odds){
+    return uint8_t(128 - std::clamp(int(log_odds), -127, 127));
+}
+
+/**
+ * @brief Writes a binary PGM, rows given bottom-up like the grid
+ */
+bool writePgm(const std::filesystem::path& path, int width, int height, const std::vector<uint8_t>& pixels){
+    std::ofstream file(path, std::ios::binary);
+    file << "P5\n" << width << " " << height << "\n255\n";
+    for (int y = height - 1; y >= 0; y--) {
+        file.write(reinterpret_cast<const char*>(pixels.data() + size_t(y)*width), width);
+    }
+    return bool(file);
+}
+
+bool writeMapImages(const OccupancyGrid& grid, const std::filesystem::path& out_dir, const std::string& name,
+                    int thumb_pixels){
+    std::vector<uint8_t> pixels(size_t(grid.width()) * grid.height());
+    for (size_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = cellShade(grid.data()[i]);
+    }
+    if (!writePgm(out_dir / (name + ".pgm"), grid.width(), grid.height(), pixels)) {return false;}
+
+    // Thumbnail keeps the darkest cell of each block so thin walls survive
+    const int thumb_width = std::min(thumb_pixels, grid.width());
+    const int thumb_height = std::max(1, grid.height() * thumb_width / grid.width());
+    std::vector<uint8_t> thumb(size_t(thumb_width) * thumb_height, 255);
+    for (int y = 0; y < grid.height(); y++) {
+        const int ty = std::min(thumb_height - 1, y * thumb_height / grid.height());
+        for (int x = 0; x < grid.width(); x++) {
+            const int tx = std::min(thumb_width - 1, x * thumb_width / grid.width());
+            uint8_t& pixel = thumb[size_t(ty)*thumb_width + tx];
+            pixel = std::min(pixel, pixels[size_t(y)*grid.width() + x]);
+        }
+    }
+    return writePgm(out_dir / (name + "_thumb.pgm"), thumb_width, thumb_height, thumb);
+}
+
+/**
+ * @brief Builds everything for one log, runs on a pool worker
+ */
+SessionStats processSession(const std::filesystem::path& log, const BatchOptions& options){
+    const auto started = std::chrono::steady_clock::now();
+    SessionStats stats;
+    stats.name = log.filename().string();
+    const std::filesystem::path out_dir(options.output_dir);
+
+    OccupancyGrid grid(map_cells, map_cells, map_resolution_cm,
+                       Vec2{-map_cells*map_resolution_cm/2, -map_cells*map_resolution_cm/2});
+    CoverageMap coverage(grid);
+    SweepAssembler sweeps;
+    const Pose2 scanner_pose;
+    std::ofstream points(out_dir / (stats.name + ".xyz"));
+
+    uint64_t start_ns = 0, first_ns = 0, last_ns = 0;
+    double distance_sum = 0;
+    stats.min_distance_cm = INT32_MAX;
+    stats.max_distance_cm = INT32_MIN;
+    stats.ok = forEachSample(log.string(), start_ns, stats.invalid,
+        [&](uint64_t timestamp_ns, const ParsedSample& sample){
+            if (stats.samples == 0) {first_ns = timestamp_ns;}
+            last_ns = timestamp_ns;
+            stats.samples++;
+            stats.min_distance_cm = std::min(stats.min_distance_cm, sample.distance_cm);
+            stats.max_distance_cm = std::max(stats.max_distance_cm, sample.distance_cm);
+            distance_sum += sample.distance_cm;
+
+            if (sample.distance_cm > 1) {
+                const uint32_t time_ms = uint32_t((timestamp_ns - start_ns) / 1000000);
+                grid.integrateRay(scanner_pose, sample.degree, sample.distance_cm, max_range_cm, &coverage, time_ms);
+            }
+            if (sample.distance_cm > 1 && sample.distance_cm < max_range_cm) {
+                const float angle = scanner_pose.theta + degreesToRadians(float(sample.degree));
+                points << scanner_pose.x + std::cos(angle)*sample.distance_cm << " "
+                       << scanner_pose.y + std::sin(angle)*sample.distance_cm << " 0\n";
+                stats.hits++;
+            }
+            if (sweeps.push(RangeSample{float(sample.degree), float(sample.distance_cm)})) {stats.sweeps++;}
+        });
+
+    if (stats.ok) {
+        stats.duration_s = (last_ns - first_ns) / 1e9;
+        if (stats.samples > 0) {
+            stats.mean_distance_cm = distance_sum / stats.samples;
+        } else {
+            stats.min_distance_cm = stats.max_distance_cm = 0;
+        }
+        // Half disc in front of the scanner the sensor can actually reach
+        stats.covered_percent = 100 * coverage.coveredFraction(1,
+            Vec2{scanner_pose.x - max_range_cm, scanner_pose.y},
+            Vec2{scanner_pose.x + max_range_cm, scanner_pose.y + max_range_cm},
+            Vec2{scanner_pose.x, scanner_pose.y}, max_range_cm);
+        stats.ok = CompressedGrid::compress(grid).save((out_dir / (stats.name + ".map")).string())
+                && writeMapImages(grid, out_dir, stats.name, options.thumb_pixels)
+                && bool(points);
+    }
+    stats.process_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return stats;
+}
+
+void writeStatsCsv(const std::filesystem::path& path, const std::vector<SessionStats>& all){
+    std::ofstream file(path);
+    file << "session,ok,samples,invalid,hits,sweeps,duration_s,min_cm,max_cm,mean_cm,covered_percent,process_ms\n";
+    for (const SessionStats& stats : all) {
+        file << stats.name << "," << stats.ok << "," << stats.samples << "," << stats.invalid << ","
+             << stats.hits << "," << stats.sweeps << "," << stats.duration_s << ","
+             << stats.min_distance_cm << "," << stats.max_distance_cm << "," << stats.mean_distance_cm << ","
+             << stats.covered_percent << "," << stats.process_ms << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+    BatchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Every log in the directory, biggest first
+    std::error_code error;
+    std::vector<std::pair<uintmax_t, std::filesystem::path>> logs;
+    for (const auto& entry : std::filesystem::directory_iterator(options.input_dir, error)) {
+        if (entry.is_regular_file() && isLogFile(entry.path())) {
+            logs.emplace_back(entry.file_size(), entry.path());
+        }
+    }
+    if (error) {
+        std::cerr << "Error reading " << options.input_dir << ": " << error.message() << std::endl;
+        return 1;
+    }
+    if (logs.empty()) {
+        std::cerr << "No session logs in " << options.input_dir << std::endl;
+        return 1;
+    }
+    std::sort(logs.begin(), logs.end(), [](const auto& a, const auto& b){ return a.first > b.first; });
+    std::filesystem::create_directories(options.output_dir, error);
+    if (error) {
+        std::cerr << "Error creating " << options.output_dir << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(options.threads);
+    std::vector<SessionStats> results(logs.size());
+    std::mutex progress_mutex;
+    size_t finished = 0;
+    const auto started = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < logs.size(); i++) {
+        pool.submit([&, i]() {
+            results[i] = processSession(logs[i].second, options);
+            const SessionStats& stats = results[i];
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            finished++;
+            std::cout << "[" << finished << "/" << logs.size() << "] " << stats.name
+                      << (stats.ok ? "" : " FAILED") << ": " << stats.samples << " samples in "
+                      << stats.process_ms << " ms" << std::endl;
+        });
+    }
+    pool.wait();
+
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    double busy_ms = 0;
+    uint64_t samples = 0;
+    size_t failed = 0;
+    for (const SessionStats& stats : results) {
+        busy_ms += stats.process_ms;
+        samples += stats.samples;
+        failed += !stats.ok;
+    }
+    std::sort(results.begin(), results.end(), [](const SessionStats& a, const SessionStats& b){ return a.name < b.name; });
+    writeStatsCsv(std::filesystem::path(options.output_dir) / "stats.csv", results);
+
+    std::cout << results.size() << " sessions (" << failed << " failed) on " << pool.size() << " threads in "
+              << wall_s << " s, " << samples / wall_s << " samples/s, "
+              << busy_ms / 1000 / wall_s << "x parallel" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,408 @@
+/**
+ * @file session_export.cpp
+ * @brief Converts recorded sessions into column files and/or CSV for
+ * offline analysis.
+ *
+ * @details Each LOG becomes OUT_DIR/NAME/ holding timestamp_ns.col,
+ * sensor.col, degree.col and distance_cm.col (layout in column_file.hpp),
+ * and/or OUT_DIR/NAME.csv, NAME being the log's whole file name.  Two
+ * LOGs with the same file name (from different directories) are refused
+ * before anything is written.  Compact logs are split between threads by
+ * block: the block headers give every block's row count, a prefix sum
+ * over those gives every block's first row, and each thread decodes its
+ * blocks straight into the mapped column files.  Blocks that fail their
+ * checksum are closed up afterwards.  Session logs hold raw serial chunks
+ * whose messages can straddle chunks, so they are parsed on one thread.
+ *
+ *     session_export [--threads N] [--format columns|csv|both] [-o OUT_DIR] LOG...
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "../ingest/sample_parser.hpp"
+#include "../session/column_file.hpp"
+#include "../session/compact_log.hpp"
+#include "../session/session_reader.hpp"
+#include "../util/thread_pool.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Rows per CSV formatting task
+const size_t csv_chunk_rows = 64 * 1024;
+
+struct ExportOptions {
+    std::vector<std::string> logs;
+    std::string output_dir = "export_out";
+    size_t threads = 0;
+    bool columns = true;
+    bool csv = false;
+};
+
+void printUsage(const char* program){
+    std::cerr << "Usage: " << program
+              << " [--threads N] [--format columns|csv|both] [-o OUT_DIR] LOG..." << std::endl;
+}
+
+bool parseOptions(int argc, char** argv, ExportOptions& options){
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::stoul(argv[++i]);
+        } else if (arg == "--format" && i + 1 < argc) {
+            const std::string format = argv[++i];
+            if (format != "columns" && format != "csv" && format != "both") {return false;}
+            options.columns = format != "csv";
+            options.csv = format != "columns";
+        } else if (arg == "-o" && i + 1 < argc) {
+            options.output_dir = argv[++i];
+        } else if (arg[0] != '-') {
+            options.logs.push_back(arg);
+        } else {
+            return false;
+        }
+    }
+    return !options.logs.empty();
+}
+
+/**
+ * @brief One column being filled in through a writable mapping
+ *
+ * @details Backed by a column file, or by anonymous memory when only CSV
+ * is wanted.  The file is sized for the most rows it could get, finish()
+ * cuts it down to the rows actually kept.
+ */
+class ColumnOutput {
+public:
+    ColumnOutput() = default;
+    ~ColumnOutput() { release(); }
+
+    ColumnOutput(const ColumnOutput&) = delete;
+    ColumnOutput& operator=(const ColumnOutput&) = delete;
+
+    /**
+     * @brief Creates the column with room for rows values
+     *
+     * @param path Column file to create, empty for memory only
+     */
+    bool create(const std::filesystem::path& path, const char* name, ColumnType type, size_t element_bytes,
+                size_t rows, const SessionFileHeader& session){
+        element_size = element_bytes;
+        mapped_bytes = sizeof(ColumnFileHeader) + std::max<size_t>(rows, 1)*element_bytes;
+        if (!path.empty()) {
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0 || ftruncate(fd, off_t(mapped_bytes)) != 0) {
+                std::cerr << "Error creating " << path.string() << ": " << std::strerror(errno) << std::endl;
+                return false;
+            }
+        }
+        void* mapped = fd >= 0 ? mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                               : mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Error mapping " << path.string() << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        mapping = static_cast<uint8_t*>(mapped);
+
+        header = ColumnFileHeader{};
+        std::memcpy(header.magic, column_file_magic, sizeof(header.magic));
+        header.version = column_file_version;
+        header.header_bytes = sizeof(ColumnFileHeader);
+        header.type = uint8_t(type);
+        header.element_bytes = uint8_t(element_bytes);
+        header.start_steady_ns = session.start_steady_ns;
+        header.start_unix_ns = session.start_unix_ns;
+        std::strncpy(header.name, name, sizeof(header.name) - 1);
+        return true;
+    }
+
+    template <typename T>
+    T* values() { return reinterpret_cast<T*>(mapping + sizeof(ColumnFileHeader)); }
+
+    /**
+     * @brief Moves rows [from, from + count) down to start at row to
+     */
+    void moveRows(size_t to, size_t from, size_t count){
+        uint8_t* base = mapping + sizeof(ColumnFileHeader);
+        std::memmove(base + to*element_size, base + from*element_size, count*element_size);
+    }
+
+    /**
+     * @brief Writes the header for rows values and trims the file to fit
+     */
+    bool finish(size_t rows){
+        header.row_count = rows;
+        std::memcpy(mapping, &header, sizeof(header));
+        if (fd < 0) {return true;}
+        bool ok = munmap(mapping, mapped_bytes) == 0;
+        mapping = nullptr;
+        ok = ftruncate(fd, off_t(sizeof(ColumnFileHeader) + rows*element_size)) == 0 && ok;
+        if (!ok) {std::cerr << "Error writing column " << header.name << ": " << std::strerror(errno) << std::endl;}
+        return ok;
+    }
+
+private:
+    void release(){
+        if (mapping) {munmap(mapping, mapped_bytes);}
+        if (fd >= 0) {::close(fd);}
+        mapping = nullptr;
+        fd = -1;
+    }
+
+    int fd = -1;
+    uint8_t* mapping = nullptr;
+    size_t mapped_bytes = 0;
+    size_t element_size = 0;
+    ColumnFileHeader header{};
+};
+
+struct SessionColumns {
+    ColumnOutput timestamp;
+    ColumnOutput sensor;
+    ColumnOutput degree;
+    ColumnOutput distance;
+
+    bool create(const std::filesystem::path& dir, size_t rows, const SessionFileHeader& session){
+        auto file = [&](const char* name){
+            return dir.empty() ? std::filesystem::path() : dir / (std::string(name) + ".col");
+        };
+        return timestamp.create(file("timestamp_ns"), "timestamp_ns", ColumnType::UInt64, sizeof(uint64_t), rows, session)
+            && sensor.create(file("sensor"), "sensor", ColumnType::UInt16, sizeof(uint16_t), rows, session)
+            && degree.create(file("degree"), "degree", ColumnType::Int32, sizeof(int32_t), rows, session)
+            && distance.create(file("distance_cm"), "distance_cm", ColumnType::Int32, sizeof(int32_t), rows, session);
+    }
+
+    void set(size_t row, uint64_t timestamp_ns, uint16_t sensor_id, int32_t degree_value, int32_t distance_cm){
+        timestamp.values<uint64_t>()[row] = timestamp_ns;
+        sensor.values<uint16_t>()[row] = sensor_id;
+        degree.values<int32_t>()[row] = degree_value;
+        distance.values<int32_t>()[row] = distance_cm;
+    }
+
+    void moveRows(size_t to, size_t from, size_t count){
+        timestamp.moveRows(to, from, count);
+        sensor.moveRows(to, from, count);
+        degree.moveRows(to, from, count);
+        distance.moveRows(to, from, count);
+    }
+
+    bool finish(size_t rows){
+        // All four, even once one has failed, so none is left oversized
+        bool ok = timestamp.finish(rows);
+        ok = sensor.finish(rows) && ok;
+        ok = degree.finish(rows) && ok;
+        return distance.finish(rows) && ok;
+    }
+};
+
+/**
+ * @brief Decodes a compact log into columns, blocks spread over the pool
+ *
+ * @return Rows kept, or -1 on failure
+ */
+int64_t exportCompactLog(const std::string& path, const std::filesystem::path& column_dir, ThreadPool& pool,
+                         SessionColumns& columns, uint64_t& corrupt_blocks){
+    CompactLogReader reader;
+    if (!reader.open(path)) {return -1;}
+    uint64_t damaged_headers = 0;
+    const std::vector<CompactBlockRef> blocks = reader.blocks(&damaged_headers);
+
+    // First row of every block, the last entry is the total
+    std::vector<size_t> first_row(blocks.size() + 1, 0);
+    for (size_t i = 0; i < blocks.size(); i++) {
+        first_row[i + 1] = first_row[i] + blocks[i].sample_count;
+    }
+    if (!columns.create(column_dir, first_row.back(), reader.header())) {return -1;}
+
+    std::vector<uint8_t> bad(blocks.size(), 0);
+    const size_t grain = std::max<size_t>(1, blocks.size() / (pool.size() * 8));
+    pool.parallelFor(0, blocks.size(), grain, [&](size_t begin, size_t end) {
+        std::vector<CompactSample> samples;
+        for (size_t i = begin; i < end; i++) {
+            if (reader.decodeBlock(blocks[i], samples) != BlockStatus::Ok) {
+                bad[i] = 1;
+                continue;
+            }
+            size_t row = first_row[i];
+            for (const CompactSample& sample : samples) {
+                columns.set(row++, sample.timestamp_ns, blocks[i].sensor, sample.degree, sample.distance_cm);
+            }
+        }
+    });
+
+    // Close the gaps damaged blocks left
+    size_t rows = 0;
+    corrupt_blocks = damaged_headers;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if (bad[i]) {
+            corrupt_blocks++;
+            continue;
+        }
+        if (rows != first_row[i]) {columns.moveRows(rows, first_row[i], blocks[i].sample_count);}
+        rows += blocks[i].sample_count;
+    }
+    return int64_t(rows);
+}
+
+/**
+ * @brief Parses a session log's raw chunks into columns
+ *
+ * @return Rows kept, or -1 on failure
+ */
+int64_t exportSessionLog(const std::string& path, const std::filesystem::path& column_dir,
+                         SessionColumns& columns, uint64_t& invalid){
+    SessionReader reader;
+    if (!reader.open(path)) {return -1;}
+
+    struct Row {
+        uint64_t timestamp_ns;
+        uint16_t sensor;
+        ParsedSample sample;
+    };
+    std::vector<Row> parsed;
+    SampleParser parser;
+    SessionRecordHeader record;
+    const char* payload;
+    while (reader.next(record, payload)) {
+        if (record.type != uint8_t(SessionRecordType::RawChunk)) {continue;}
+        parser.feed(payload, record.payload_bytes, [&](const ParsedSample& sample){
+            parsed.push_back(Row{record.timestamp_ns, record.sensor, sample});
+        });
+    }
+    invalid = parser.invalidMessages();
+
+    if (!columns.create(column_dir, parsed.size(), reader.header())) {return -1;}
+    for (size_t row = 0; row < parsed.size(); row++) {
+        const Row& r = parsed[row];
+        columns.set(row, r.timestamp_ns, r.sensor, r.sample.degree, r.sample.distance_cm);
+    }
+    return int64_t(parsed.size());
+}
+
+/**
+ * @brief Writes the columns as CSV, formatting chunks of rows in parallel
+ * and writing them out in order
+ */
+bool writeCsv(const std::filesystem::path& path, SessionColumns& columns, size_t rows, ThreadPool& pool){
+    std::ofstream file(path, std::ios::binary);
+    file << "timestamp_ns,sensor,degree,distance_cm\n";
+    const uint64_t* timestamp = columns.timestamp.values<uint64_t>();
+    const uint16_t* sensor = columns.sensor.values<uint16_t>();
+    const int32_t* degree = columns.degree.values<int32_t>();
+    const int32_t* distance = columns.distance.values<int32_t>();
+
+    // A few chunks per thread at a time keeps memory bounded
+    const size_t chunks_per_round = pool.size() * 4;
+    std::vector<std::string> text(chunks_per_round);
+    for (size_t round_row = 0; round_row < rows && file; round_row += chunks_per_round*csv_chunk_rows) {
+        const size_t chunks = std::min(chunks_per_round, (rows - round_row + csv_chunk_rows - 1) / csv_chunk_rows);
+        pool.parallelFor(0, chunks, 1, [&](size_t begin, size_t end) {
+            for (size_t chunk = begin; chunk < end; chunk++) {
+                const size_t first = round_row + chunk*csv_chunk_rows;
+                const size_t last = std::min(rows, first + csv_chunk_rows);
+                std::string& out = text[chunk];
+                out.resize((last - first) * 56);    // longest possible line is 51 characters
+                char* p = out.data();
+                char* const out_end = p + out.size();
+                for (size_t row = first; row < last; row++) {
+                    p = std::to_chars(p, out_end, timestamp[row]).ptr;
+                    *p++ = ',';
+                    p = std::to_chars(p, out_end, sensor[row]).ptr;
+                    *p++ = ',';
+                    p = std::to_chars(p, out_end, degree[row]).ptr;
+                    *p++ = ',';
+                    p = std::to_chars(p, out_end, distance[row]).ptr;
+                    *p++ = '\n';
+                }
+                out.resize(size_t(p - out.data()));
+            }
+        });
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            file.write(text[chunk].data(), std::streamsize(text[chunk].size()));
+        }
+    }
+    file.flush();
+    if (!file) {std::cerr << "Error writing " << path.string() << std::endl;}
+    return bool(file);
+}
+
+} // namespace
+
+int main(int argc, char** argv){
+    ExportOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    // Output names, which the logs mustn't share
+    std::vector<std::string> names;
+    for (const std::string& log : options.logs) {
+        const std::string name = std::filesystem::path(log).filename().string();
+        const auto same = std::find(names.begin(), names.end(), name);
+        if (same != names.end()) {
+            std::cerr << "Both " << options.logs[size_t(same - names.begin())] << " and " << log
+                      << " would export as " << name << std::endl;
+            return 1;
+        }
+        names.push_back(name);
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(options.output_dir, error);
+    if (error) {
+        std::cerr << "Error creating " << options.output_dir << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(options.threads);
+    size_t failed = 0;
+    for (size_t i = 0; i < options.logs.size(); i++) {
+        const std::string& log = options.logs[i];
+        const std::string& name = names[i];
+        const auto started = std::chrono::steady_clock::now();
+        const std::filesystem::path out_dir(options.output_dir);
+        std::filesystem::path column_dir;
+        if (options.columns) {
+            column_dir = out_dir / name;
+            std::filesystem::create_directories(column_dir, error);
+            if (error) {
+                std::cerr << "Error creating " << column_dir.string() << ": " << error.message() << std::endl;
+                failed++;
+                continue;
+            }
+        }
+
+        SessionColumns columns;
+        uint64_t skipped = 0;
+        const bool compact = isCompactLog(log);
+        const int64_t rows = compact ? exportCompactLog(log, column_dir, pool, columns, skipped)
+                                     : exportSessionLog(log, column_dir, columns, skipped);
+        bool ok = rows >= 0;
+        if (ok && options.csv) {ok = writeCsv(out_dir / (name + ".csv"), columns, size_t(rows), pool);}
+        if (rows >= 0) {ok = columns.finish(size_t(rows)) && ok;}
+        failed += !ok;
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::cout << name << (ok ? "" : " FAILED") << ": " << std::max<int64_t>(rows, 0) << " rows in "
+                  << seconds << " s, " << std::max<int64_t>(rows, 0) / seconds << " rows/s";
+        if (skipped > 0) {std::cout << ", " << skipped << (compact ? " corrupt blocks" : " invalid messages");}
+        std::cout << std::endl;
+    }
+    return failed == 0 ? 0 : 1;
+}
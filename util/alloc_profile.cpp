@@ -0,0 +1,120 @@
+/**
+ * @file alloc_profile.cpp
+ * @brief Global operator new/delete hooks and the per-stage report.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "alloc_profile.hpp"
+
+#ifdef ALLOC_PROFILE
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+namespace {
+
+// Counters can't allocate, so they are plain arrays, one slot per stage
+// plus one for "other"
+const size_t stage_slots = pipeline_stage_count + 1;
+
+struct StageCounters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> entries{0};
+};
+
+StageCounters counters[stage_slots];
+
+inline void countAllocation(size_t bytes){
+    StageCounters& stage = counters[current_alloc_stage];
+    stage.allocations.fetch_add(1, std::memory_order_relaxed);
+    stage.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+inline void countFree(void* pointer){
+    if (pointer) {counters[current_alloc_stage].frees.fetch_add(1, std::memory_order_relaxed);}
+}
+
+void* allocate(size_t bytes){
+    countAllocation(bytes);
+    // malloc(0) may return null, new must not
+    void* pointer = std::malloc(bytes ? bytes : 1);
+    if (!pointer) {throw std::bad_alloc();}
+    return pointer;
+}
+
+void* allocateAligned(size_t bytes, std::align_val_t alignment){
+    countAllocation(bytes);
+    void* pointer = nullptr;
+    if (posix_memalign(&pointer, std::max(sizeof(void*), size_t(alignment)), bytes ? bytes : 1) != 0) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+} // namespace
+
+void countAllocStageEntry(PipelineStage stage){
+    counters[size_t(stage)].entries.fetch_add(1, std::memory_order_relaxed);
+}
+
+void printAllocationProfile(std::ostream& out){
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(2)
+        << "Allocations       " << std::setw(10) << "entries" << std::setw(12) << "allocs" << std::setw(14) << "bytes"
+        << std::setw(12) << "frees" << std::setw(14) << "allocs/entry" << std::setw(14) << "bytes/entry" << "\n";
+    for (size_t slot = 0; slot < stage_slots; slot++) {
+        const StageCounters& stage = counters[slot];
+        const uint64_t entries = stage.entries.load(std::memory_order_relaxed);
+        const uint64_t allocations = stage.allocations.load(std::memory_order_relaxed);
+        const uint64_t bytes = stage.bytes.load(std::memory_order_relaxed);
+        if (allocations == 0 && entries == 0) {continue;}
+        out << std::left << std::setw(18) << pipelineStageName(PipelineStage(slot)) << std::right
+            << std::setw(10) << entries << std::setw(12) << allocations << std::setw(14) << bytes
+            << std::setw(12) << stage.frees.load(std::memory_order_relaxed);
+        if (entries > 0) {
+            out << std::setw(14) << double(allocations) / entries << std::setw(14) << double(bytes) / entries;
+        }
+        out << "\n";
+    }
+    out.flush();
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// Replacements for every global form of new and delete
+
+void* operator new(size_t bytes) { return allocate(bytes); }
+void* operator new[](size_t bytes) { return allocate(bytes); }
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept {
+    try {return allocate(bytes);} catch (const std::bad_alloc&) {return nullptr;}
+}
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept {
+    try {return allocate(bytes);} catch (const std::bad_alloc&) {return nullptr;}
+}
+void* operator new(size_t bytes, std::align_val_t alignment) { return allocateAligned(bytes, alignment); }
+void* operator new[](size_t bytes, std::align_val_t alignment) { return allocateAligned(bytes, alignment); }
+
+void operator delete(void* pointer) noexcept { countFree(pointer); std::free(pointer); }
+void operator delete[](void* pointer) noexcept { countFree(pointer); std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { countFree(pointer); std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { countFree(pointer); std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { countFree(pointer); std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { countFree(pointer); std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { countFree(pointer); std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { countFree(pointer); std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { countFree(pointer); std::free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { countFree(pointer); std::free(pointer); }
+
+#else
+
+void printAllocationProfile(std::ostream&) {}
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * @file alloc_profile.hpp
+ * @brief Counts heap allocations per pipeline stage, in ALLOC_PROFILE
+ * builds only.
+ *
+ * @details Building with -DALLOC_PROFILE (make ALLOC_PROFILE=1) replaces
+ * the global operator new and delete with versions that count calls and
+ * bytes against the calling thread's current stage.  AllocStageScope sets
+ * that stage for a block and puts the previous one back after, so stages
+ * nest; StageTimer carries one, so every timed stage is tagged too.
+ * Allocations outside any scope count as "other".
+ *
+ * In a normal build AllocStageScope is empty and the hooks don't exist.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <ostream>
+
+#include "pipeline_stage.hpp"
+
+#ifdef ALLOC_PROFILE
+const bool alloc_profile_enabled = true;
+
+// Stage the calling thread is in, pipeline_stage_count when none
+inline thread_local uint8_t current_alloc_stage = uint8_t(pipeline_stage_count);
+
+/**
+ * @brief Counts one entry into a stage, for the per-entry figures
+ */
+void countAllocStageEntry(PipelineStage stage);
+
+class AllocStageScope {
+public:
+    explicit AllocStageScope(PipelineStage stage) : previous(current_alloc_stage) {
+        current_alloc_stage = uint8_t(stage);
+        countAllocStageEntry(stage);
+    }
+    ~AllocStageScope(){ current_alloc_stage = previous; }
+
+    AllocStageScope(const AllocStageScope&) = delete;
+    AllocStageScope& operator=(const AllocStageScope&) = delete;
+
+private:
+    const uint8_t previous;
+};
+#else
+const bool alloc_profile_enabled = false;
+
+class AllocStageScope {
+public:
+    explicit AllocStageScope(PipelineStage) {}
+};
+#endif
+
+/**
+ * @brief Prints allocations, bytes and frees per stage, and allocations
+ * per entry into the stage (per frame for the render stage, say).
+ * Prints nothing unless built with ALLOC_PROFILE.
+ */
+void printAllocationProfile(std::ostream& out);
@@ -0,0 +1,134 @@
+/**
+ * @file crc32.cpp
+ * @brief Slicing-by-8 table CRC-32 and CRC-32C, and the SSE4.2/ARMv8
+ * CRC-32C instructions.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "crc32.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace {
+
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+/**
+ * @brief Table 0 is the usual byte table, table k advances a byte k
+ * more positions so eight can be folded in at once
+ *
+ * @param polynomial The reflected polynomial
+ */
+CrcTables makeTables(uint32_t polynomial){
+    CrcTables tables{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (polynomial & (0u - (crc & 1)));
+        }
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (size_t k = 1; k < 8; k++) {
+            tables[k][i] = (tables[k-1][i] >> 8) ^ tables[0][tables[k-1][i] & 0xFF];
+        }
+    }
+    return tables;
+}
+
+const CrcTables crc32_tables = makeTables(0xEDB88320u);
+const CrcTables crc32c_tables = makeTables(0x82F63B78u);
+
+uint32_t sliceBy8(const CrcTables& tables, const uint8_t* bytes, size_t count, uint32_t crc){
+    crc = ~crc;
+    // Eight bytes at a time, the format is little-endian like the host
+    while (count >= 8) {
+        uint32_t low, high;
+        std::memcpy(&low, bytes, 4);
+        std::memcpy(&high, bytes + 4, 4);
+        low ^= crc;
+        crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF]
+            ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24]
+            ^ tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF]
+            ^ tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
+        bytes += 8;
+        count -= 8;
+    }
+    while (count--) {
+        crc = (crc >> 8) ^ tables[0][(crc ^ *bytes++) & 0xFF];
+    }
+    return ~crc;
+}
+
+#if defined(__x86_64__)
+
+// Built for SSE4.2 on its own so the rest of the file, and the
+// fallback, still run on any x86-64
+__attribute__((target("sse4.2")))
+uint32_t crc32cHardware(const uint8_t* bytes, size_t count, uint32_t crc){
+    uint64_t state = ~crc;
+    while (count >= 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes, 8);
+        state = _mm_crc32_u64(state, word);
+        bytes += 8;
+        count -= 8;
+    }
+    uint32_t tail = uint32_t(state);
+    while (count--) {tail = _mm_crc32_u8(tail, *bytes++);}
+    return ~tail;
+}
+
+bool detectHardwareCrc(){
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+
+const bool hardware_crc = detectHardwareCrc();
+
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+
+uint32_t crc32cHardware(const uint8_t* bytes, size_t count, uint32_t crc){
+    crc = ~crc;
+    while (count >= 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes, 8);
+        crc = __crc32cd(crc, word);
+        bytes += 8;
+        count -= 8;
+    }
+    while (count--) {crc = __crc32cb(crc, *bytes++);}
+    return ~crc;
+}
+
+const bool hardware_crc = true;
+
+#else
+
+uint32_t crc32cHardware(const uint8_t*, size_t, uint32_t crc){
+    return crc;
+}
+
+const bool hardware_crc = false;
+
+#endif
+
+} // namespace
+
+uint32_t crc32(const void* data, size_t count, uint32_t crc){
+    return sliceBy8(crc32_tables, static_cast<const uint8_t*>(data), count, crc);
+}
+
+uint32_t crc32c(const void* data, size_t count, uint32_t crc){
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    return hardware_crc ? crc32cHardware(bytes, count, crc) : sliceBy8(crc32c_tables, bytes, count, crc);
+}
@@ -0,0 +1,41 @@
+/**
+ * @file crc32.hpp
+ * @brief CRC-32 (the zlib/PNG one) and CRC-32C (Castagnoli) for checking
+ * blocks read back from disk.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief CRC-32 of a buffer, or of several buffers chained together
+ *
+ * @details Uses slicing-by-8 tables, eight bytes per step, so checking a
+ * block costs far less than decoding it.  Pass the result of one call as
+ * crc to continue over the next buffer.
+ *
+ * @param data Bytes to check
+ * @param count Number of bytes
+ * @param crc 0 to start, or the CRC so far
+ */
+uint32_t crc32(const void* data, size_t count, uint32_t crc = 0);
+
+/**
+ * @brief CRC-32C of a buffer, chained the same way as crc32()
+ *
+ * @details The polynomial SSE4.2 and ARMv8 have an instruction for, so
+ * where the CPU has it this is eight bytes per instruction instead of
+ * eight table lookups.  Without it (checked once at startup on x86,
+ * at compile time on ARM) the same slicing-by-8 tables as crc32() are
+ * used, so the result never depends on the machine.
+ *
+ * @param data Bytes to check
+ * @param count Number of bytes
+ * @param crc 0 to start, or the CRC so far
+ */
+uint32_t crc32c(const void* data, size_t count, uint32_t crc = 0);
@@ -0,0 +1,136 @@
+/**
+ * @file latency_histogram.cpp
+ * @brief Per-thread histogram storage, merging and the text report.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "latency_histogram.hpp"
+
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+struct AtomicHistogram {
+    std::atomic<uint64_t> buckets[latency_bucket_count] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+};
+
+/**
+ * @brief One thread's histograms, written only by that thread
+ *
+ * @details With a single writer a relaxed load and store is enough to
+ * add one, no read-modify-write needed; readers merging at the same
+ * time may just miss the newest few counts.
+ */
+struct ThreadLatencies {
+    AtomicHistogram stages[pipeline_stage_count];
+};
+
+inline void bump(std::atomic<uint64_t>& value, uint64_t by){
+    value.store(value.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+// Every thread's histograms, kept after the thread exits so its counts
+// still show up in reports
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<ThreadLatencies>>& registry(){
+    static std::vector<std::unique_ptr<ThreadLatencies>> all;
+    return all;
+}
+
+thread_local ThreadLatencies* thread_latencies = nullptr;
+
+ThreadLatencies& threadLatencies(){
+    if (!thread_latencies) {
+        auto latencies = std::make_unique<ThreadLatencies>();
+        thread_latencies = latencies.get();
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry().push_back(std::move(latencies));
+    }
+    return *thread_latencies;
+}
+
+} // namespace
+
+uint64_t latencyBucketStart(size_t bucket){
+    if (bucket < latency_sub_buckets) {return bucket;}
+    const size_t shift = bucket / latency_sub_buckets - 1;
+    return (latency_sub_buckets + bucket % latency_sub_buckets) << shift;
+}
+
+uint64_t LatencySummary::percentile(double q) const {
+    if (count == 0) {return 0;}
+    const uint64_t rank = std::max<uint64_t>(1, uint64_t(q * count + 0.5));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < buckets.size(); bucket++) {
+        seen += buckets[bucket];
+        if (seen >= rank) {
+            const uint64_t start = latencyBucketStart(bucket);
+            const uint64_t next = bucket + 1 < buckets.size() ? latencyBucketStart(bucket + 1) : start + 1;
+            return std::min(max_ns, start + (next - start) / 2);
+        }
+    }
+    return max_ns;
+}
+
+void recordStageLatency(PipelineStage stage, uint64_t duration_ns){
+    AtomicHistogram& histogram = threadLatencies().stages[size_t(stage)];
+    bump(histogram.buckets[latencyBucket(duration_ns)], 1);
+    bump(histogram.count, 1);
+    bump(histogram.sum_ns, duration_ns);
+    if (duration_ns > histogram.max_ns.load(std::memory_order_relaxed)) {
+        histogram.max_ns.store(duration_ns, std::memory_order_relaxed);
+    }
+}
+
+StageLatencies mergeStageLatencies(){
+    StageLatencies merged;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const auto& thread : registry()) {
+        for (size_t stage = 0; stage < pipeline_stage_count; stage++) {
+            const AtomicHistogram& from = thread->stages[stage];
+            LatencySummary& to = merged[stage];
+            if (from.count.load(std::memory_order_relaxed) == 0) {continue;}
+            for (size_t bucket = 0; bucket < latency_bucket_count; bucket++) {
+                to.buckets[bucket] += from.buckets[bucket].load(std::memory_order_relaxed);
+            }
+            to.sum_ns += from.sum_ns.load(std::memory_order_relaxed);
+            to.max_ns = std::max(to.max_ns, from.max_ns.load(std::memory_order_relaxed));
+        }
+    }
+    // Counted from the buckets so percentiles stay consistent with a
+    // merge that raced a recording thread
+    for (LatencySummary& summary : merged) {
+        for (uint64_t bucket_count : summary.buckets) {summary.count += bucket_count;}
+    }
+    return merged;
+}
+
+void printStageLatencies(std::ostream& out, const StageLatencies& latencies){
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "Latency (us)      " << std::setw(10) << "count" << std::setw(10) << "mean" << std::setw(10) << "p50"
+        << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(10) << "max" << "\n";
+    for (size_t stage = 0; stage < pipeline_stage_count; stage++) {
+        const LatencySummary& summary = latencies[stage];
+        if (summary.count == 0) {continue;}
+        out << std::left << std::setw(18) << pipelineStageName(PipelineStage(stage)) << std::right
+            << std::setw(10) << summary.count
+            << std::setw(10) << summary.meanNs() / 1e3
+            << std::setw(10) << summary.percentile(0.5) / 1e3
+            << std::setw(10) << summary.percentile(0.9) / 1e3
+            << std::setw(10) << summary.percentile(0.99) / 1e3
+            << std::setw(10) << summary.percentile(0.999) / 1e3
+            << std::setw(10) << summary.max_ns / 1e3 << "\n";
+    }
+    out.flush();
+    out.flags(flags);
+    out.precision(precision);
+}
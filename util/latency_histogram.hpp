@@ -0,0 +1,127 @@
+/**
+ * @file latency_histogram.hpp
+ * @brief Per-stage latency histograms for the sample pipeline.
+ *
+ * @details Every thread that records gets its own set of histograms, one
+ * per PipelineStage, so recording is a few relaxed loads and stores with
+ * no locks and no shared cache lines.  Buckets are log-linear like an HDR
+ * histogram: exact below 32 ns, then 32 buckets per power of two, so any
+ * value up to about 18 minutes lands in a bucket within ~3% of it.
+ * mergeStageLatencies() adds up every thread's counts whenever a report
+ * is wanted, recording threads carry on meanwhile.
+ *
+ *     {
+ *         StageTimer timer(PipelineStage::Render);
+ *         updateRadar(...);
+ *     }
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "alloc_profile.hpp"
+#include "perf_counters.hpp"
+#include "pipeline_stage.hpp"
+
+// Log-linear bucket layout, see the file comment
+const int latency_sub_bucket_bits = 5;
+const uint64_t latency_sub_buckets = uint64_t(1) << latency_sub_bucket_bits;
+const int latency_max_exponent = 40;
+const size_t latency_bucket_count = size_t(latency_max_exponent - latency_sub_bucket_bits + 2) * latency_sub_buckets;
+
+/**
+ * @brief Bucket a value in nanoseconds falls in, values past the range
+ * go in the last bucket
+ */
+inline size_t latencyBucket(uint64_t value_ns){
+    if (value_ns < latency_sub_buckets) {return size_t(value_ns);}
+    const int exponent = std::min(63 - __builtin_clzll(value_ns), latency_max_exponent);
+    const int shift = exponent - latency_sub_bucket_bits;
+    const uint64_t mantissa = std::min(value_ns >> shift, 2*latency_sub_buckets - 1);
+    return size_t(shift + 1)*latency_sub_buckets + size_t(mantissa - latency_sub_buckets);
+}
+
+/**
+ * @brief Smallest value that lands in a bucket
+ */
+uint64_t latencyBucketStart(size_t bucket);
+
+/**
+ * @brief One stage's counts summed over every thread
+ */
+struct LatencySummary {
+    std::vector<uint64_t> buckets = std::vector<uint64_t>(latency_bucket_count, 0);
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+    uint64_t max_ns = 0;
+
+    /**
+     * @brief Value below which a fraction q (0-1) of the samples fall,
+     * the middle of the bucket it lands in
+     */
+    uint64_t percentile(double q) const;
+    double meanNs() const { return count ? double(sum_ns) / count : 0; }
+};
+
+using StageLatencies = std::array<LatencySummary, pipeline_stage_count>;
+
+/**
+ * @brief Turns recording on or off for every thread, StageTimer skips
+ * reading the clock while it is off (the default)
+ */
+inline std::atomic<bool> stage_latency_enabled{false};
+
+inline void setStageLatencyEnabled(bool enabled){ stage_latency_enabled.store(enabled, std::memory_order_relaxed); }
+inline bool stageLatencyEnabled(){ return stage_latency_enabled.load(std::memory_order_relaxed); }
+
+/**
+ * @brief Adds one measurement to the calling thread's histogram
+ */
+void recordStageLatency(PipelineStage stage, uint64_t duration_ns);
+
+/**
+ * @brief Every thread's histograms added up, threads that have exited
+ * included
+ */
+StageLatencies mergeStageLatencies();
+
+/**
+ * @brief Prints count, mean, percentiles and max per stage in µs
+ */
+void printStageLatencies(std::ostream& out, const StageLatencies& latencies);
+
+/**
+ * @brief Records the time from construction to destruction against a
+ * stage, and tags allocations and hardware counts made meanwhile with it
+ */
+class StageTimer {
+public:
+    explicit StageTimer(PipelineStage stage)
+        : stage(stage), alloc_scope(stage), perf_scope(stage), start(stageLatencyEnabled() ? std::chrono::steady_clock::now()
+                                                    : std::chrono::steady_clock::time_point()) {}
+    ~StageTimer(){
+        if (start.time_since_epoch().count() == 0) {return;}
+        recordStageLatency(stage, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    const PipelineStage stage;
+    AllocStageScope alloc_scope;    // only does anything in ALLOC_PROFILE builds
+    PerfStageScope perf_scope;      // only reads counters with --perf-counters
+    const std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,214 @@
+/**
+ * @file metrics.cpp
+ * @brief Prometheus text rendering and the scrape server.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "metrics.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// How often the server checks whether it should stop
+const int poll_interval_ms = 200;
+// Longest one scrape may take, so a client that stops reading or
+// trickles its request can't hold up the next scrape or stop()
+const auto client_timeout = std::chrono::seconds(2);
+
+/**
+ * @brief Whether an address is a TCP port rather than a socket path
+ */
+bool parsePort(const std::string& address, uint16_t& port){
+    std::string digits = address;
+    const std::string loopback = "127.0.0.1:";
+    if (digits.compare(0, loopback.size(), loopback) == 0) {digits = digits.substr(loopback.size());}
+    if (digits.empty() || digits.size() > 5 || digits.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    const unsigned long value = std::stoul(digits);
+    if (value == 0 || value > 65535) {return false;}
+    port = uint16_t(value);
+    return true;
+}
+
+/**
+ * @brief Sends everything, false on an error, at the deadline or once
+ * the server is stopping
+ *
+ * @details The socket has SO_SNDTIMEO set to poll_interval_ms, so a
+ * send to a client that has stopped reading comes back that often to
+ * check.
+ */
+bool writeAll(int fd, const char* bytes, size_t count, std::chrono::steady_clock::time_point deadline,
+              const std::atomic<bool>& stopping){
+    while (count > 0) {
+        if (stopping || std::chrono::steady_clock::now() >= deadline) {return false;}
+        const ssize_t written = ::send(fd, bytes, count, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {continue;}
+            return false;
+        }
+        bytes += written;
+        count -= size_t(written);
+    }
+    return true;
+}
+
+} // namespace
+
+MetricCounter& MetricsRegistry::counter(const std::string& name, const std::string& help){
+    counters.emplace_back(std::piecewise_construct, std::forward_as_tuple(Named{name, help}), std::forward_as_tuple());
+    return counters.back().second;
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name, const std::string& help){
+    gauges.emplace_back(std::piecewise_construct, std::forward_as_tuple(Named{name, help}), std::forward_as_tuple());
+    return gauges.back().second;
+}
+
+void MetricsRegistry::collector(std::function<void(std::string&)> collect){
+    collectors.push_back(std::move(collect));
+}
+
+void appendMetricHeader(std::string& out, const std::string& name, const std::string& help, const char* type){
+    out += "# HELP " + name + " " + help + "\n# TYPE " + name + " " + type + "\n";
+}
+
+void appendMetric(std::string& out, const std::string& name, const std::string& labels, double value){
+    char number[32];
+    if (std::isnan(value)) {
+        std::snprintf(number, sizeof(number), "NaN");
+    } else if (value == std::floor(value) && std::fabs(value) < 1e15) {
+        std::snprintf(number, sizeof(number), "%.0f", value);
+    } else {
+        std::snprintf(number, sizeof(number), "%.9g", value);
+    }
+    out += name;
+    if (!labels.empty()) {out += "{" + labels + "}";}
+    out += " ";
+    out += number;
+    out += "\n";
+}
+
+std::string MetricsRegistry::render() const {
+    std::string out;
+    out.reserve(4096);
+    for (const auto& [named, counter] : counters) {
+        appendMetricHeader(out, named.name, named.help, "counter");
+        appendMetric(out, named.name, "", double(counter.get()));
+    }
+    for (const auto& [named, gauge] : gauges) {
+        appendMetricHeader(out, named.name, named.help, "gauge");
+        appendMetric(out, named.name, "", gauge.get());
+    }
+    for (const auto& collect : collectors) {
+        collect(out);
+    }
+    return out;
+}
+
+MetricsServer::~MetricsServer(){
+    stop();
+}
+
+bool MetricsServer::start(const std::string& address, const MetricsRegistry& registry){
+    stop();
+    served = &registry;
+    uint16_t port = 0;
+    if (parsePort(address, port)) {
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        const int reuse = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in bound{};
+        bound.sin_family = AF_INET;
+        bound.sin_port = htons(port);
+        bound.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr*>(&bound), sizeof(bound)) != 0) {
+            std::cerr << "Error binding metrics port " << port << ": " << std::strerror(errno) << std::endl;
+            stop();
+            return false;
+        }
+    } else {
+        sockaddr_un bound{};
+        if (address.size() >= sizeof(bound.sun_path)) {
+            std::cerr << "Metrics socket path too long: " << address << std::endl;
+            return false;
+        }
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        bound.sun_family = AF_UNIX;
+        std::memcpy(bound.sun_path, address.c_str(), address.size() + 1);
+        ::unlink(address.c_str());
+        if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr*>(&bound), sizeof(bound)) != 0) {
+            std::cerr << "Error binding metrics socket " << address << ": " << std::strerror(errno) << std::endl;
+            stop();
+            return false;
+        }
+        socket_path = address;
+    }
+    if (listen(listen_fd, 8) != 0) {
+        std::cerr << "Error listening for metrics: " << std::strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+    stopping = false;
+    server = std::thread([this]() { serveLoop(); });
+    return true;
+}
+
+void MetricsServer::stop(){
+    stopping = true;
+    if (server.joinable()) {server.join();}
+    if (listen_fd >= 0) {::close(listen_fd);}
+    listen_fd = -1;
+    if (!socket_path.empty()) {::unlink(socket_path.c_str());}
+    socket_path.clear();
+}
+
+void MetricsServer::serveLoop(){
+    while (!stopping) {
+        pollfd waiting{listen_fd, POLLIN, 0};
+        if (poll(&waiting, 1, poll_interval_ms) <= 0) {continue;}
+        const int client = accept(listen_fd, nullptr, nullptr);
+        if (client < 0) {continue;}
+
+        // The request itself doesn't matter, every path gets the metrics.
+        // Read what's there so closing doesn't reset the connection.
+        const auto deadline = std::chrono::steady_clock::now() + client_timeout;
+        timeval timeout{0, poll_interval_ms * 1000};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        char request[1024];
+        std::string received;
+        while (received.find("\r\n\r\n") == std::string::npos && received.size() < 8192
+               && !stopping && std::chrono::steady_clock::now() < deadline) {
+            const ssize_t count = ::recv(client, request, sizeof(request), 0);
+            if (count < 0 && errno == EINTR) {continue;}
+            if (count <= 0) {break;}
+            received.append(request, size_t(count));
+        }
+
+        const std::string body = served->render();
+        const std::string header = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                                 + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+        if (writeAll(client, header.data(), header.size(), deadline, stopping)) {
+            writeAll(client, body.data(), body.size(), deadline, stopping);
+        }
+        ::close(client);
+        scrape_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,131 @@
+/**
+ * @file metrics.hpp
+ * @brief Counters and gauges served in Prometheus text format.
+ *
+ * @details Metrics are registered once at startup and then updated from
+ * wherever they are measured with relaxed atomic operations only.  A
+ * MetricsServer thread answers each scrape by reading those atomics (and
+ * running any collectors, which must stick to atomics or their own state
+ * as well), so a scrape never holds up the sample loop.  The endpoint is
+ * plain HTTP on a Unix socket or a loopback TCP port:
+ *
+ *     curl --unix-socket /tmp/radar.sock http://localhost/metrics
+ *     curl http://127.0.0.1:9464/metrics
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MetricCounter {
+public:
+    void add(uint64_t count = 1) { value.fetch_add(count, std::memory_order_relaxed); }
+    /**
+     * @brief Copies a total kept elsewhere, which must only ever grow
+     */
+    void set(uint64_t total) { value.store(total, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+class MetricGauge {
+public:
+    void set(double level) { value.store(level, std::memory_order_relaxed); }
+    double get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value{0};
+};
+
+/**
+ * @brief Every metric the process exports
+ *
+ * @details Register everything before MetricsServer::start, the lists
+ * aren't locked.  Returned references stay valid for the registry's life.
+ */
+class MetricsRegistry {
+public:
+    MetricCounter& counter(const std::string& name, const std::string& help);
+    MetricGauge& gauge(const std::string& name, const std::string& help);
+
+    /**
+     * @brief Adds text of its own to every scrape, called on the server
+     * thread, so it must not touch anything the sample loop locks
+     */
+    void collector(std::function<void(std::string&)> collect);
+
+    /**
+     * @brief The whole exposition, as a scrape returns it
+     */
+    std::string render() const;
+
+private:
+    struct Named {
+        std::string name;
+        std::string help;
+    };
+
+    std::deque<std::pair<Named, MetricCounter>> counters;
+    std::deque<std::pair<Named, MetricGauge>> gauges;
+    std::vector<std::function<void(std::string&)>> collectors;
+};
+
+/**
+ * @brief Appends one sample line, "name{labels} value"
+ */
+void appendMetric(std::string& out, const std::string& name, const std::string& labels, double value);
+
+/**
+ * @brief Appends the "# HELP" and "# TYPE" lines for a metric
+ */
+void appendMetricHeader(std::string& out, const std::string& name, const std::string& help, const char* type);
+
+/**
+ * @brief Answers scrapes from its own thread
+ */
+class MetricsServer {
+public:
+    MetricsServer() = default;
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * @brief Starts listening, false if the address can't be bound
+     *
+     * @param address A port number (or 127.0.0.1:PORT) for loopback TCP,
+     * anything else is a Unix socket path, replaced if it exists
+     * @param registry Metrics to serve, must outlive the server
+     */
+    bool start(const std::string& address, const MetricsRegistry& registry);
+
+    /**
+     * @brief Stops serving, within poll_interval_ms even with a client
+     * that stopped reading halfway through a scrape
+     */
+    void stop();
+
+    uint64_t scrapes() const { return scrape_count.load(std::memory_order_relaxed); }
+
+private:
+    void serveLoop();
+
+    const MetricsRegistry* served = nullptr;
+    int listen_fd = -1;
+    std::string socket_path;
+    std::thread server;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> scrape_count{0};
+};
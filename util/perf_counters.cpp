@@ -0,0 +1,168 @@
+/**
+ * @file perf_counters.cpp
+ * @brief perf_event_open counter groups and the per-stage report.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "perf_counters.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace {
+
+struct StagePerf {
+    std::atomic<uint64_t> passes{0};
+    std::atomic<uint64_t> cycles{0};
+    std::atomic<uint64_t> instructions{0};
+    std::atomic<uint64_t> cache_misses{0};
+    std::atomic<uint64_t> branch_misses{0};
+};
+
+StagePerf stage_perf[pipeline_stage_count];
+
+#ifdef __linux__
+
+const int counter_count = 4;
+const uint64_t counter_configs[counter_count] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+/**
+ * @brief One thread's counter group, closed when the thread exits
+ */
+struct CounterGroup {
+    int fds[counter_count] = {-1, -1, -1, -1};
+    bool tried = false;
+
+    ~CounterGroup(){
+        for (int fd : fds) {
+            if (fd >= 0) {::close(fd);}
+        }
+    }
+
+    /**
+     * @brief Opens the group for the calling thread, errno set on failure
+     */
+    bool open(){
+        tried = true;
+        for (int i = 0; i < counter_count; i++) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = counter_configs[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[i] = int(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0));
+            if (fds[i] < 0) {
+                const int error = errno;
+                for (int& fd : fds) {
+                    if (fd >= 0) {::close(fd);}
+                    fd = -1;
+                }
+                errno = error;
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+thread_local CounterGroup counter_group;
+
+#endif
+
+} // namespace
+
+#ifdef __linux__
+
+bool enablePerfCounters(){
+    if (!counter_group.tried && !counter_group.open()) {
+        const bool missing = errno == ENOENT || errno == EOPNOTSUPP;
+        std::cerr << "Error opening hardware counters: " << std::strerror(errno)
+                  << (missing ? " (none exposed, a VM?)" : " (check /proc/sys/kernel/perf_event_paranoid)") << std::endl;
+        return false;
+    }
+    if (counter_group.fds[0] < 0) {return false;}
+    perf_counters_enabled = true;
+    return true;
+}
+
+PerfCounts readPerfCounts(){
+    if (!perfCountersEnabled()) {return PerfCounts();}
+    if (!counter_group.tried) {counter_group.open();}
+    if (counter_group.fds[0] < 0) {return PerfCounts();}
+
+    // nr, time enabled, time running, then one value per counter
+    uint64_t values[3 + counter_count];
+    if (::read(counter_group.fds[0], values, sizeof(values)) != ssize_t(sizeof(values))) {return PerfCounts();}
+    const uint64_t enabled = values[1];
+    const uint64_t running = values[2];
+    auto scaled = [&](int counter){
+        const uint64_t value = values[3 + counter];
+        return running > 0 && running < enabled ? uint64_t(double(value) * enabled / running) : value;
+    };
+    return PerfCounts{scaled(0), scaled(1), scaled(2), scaled(3)};
+}
+
+#else
+
+bool enablePerfCounters(){
+    std::cerr << "Hardware counters need Linux perf_event_open" << std::endl;
+    return false;
+}
+
+PerfCounts readPerfCounts(){
+    return PerfCounts();
+}
+
+#endif
+
+void recordStagePerf(PipelineStage stage, const PerfCounts& counts){
+    StagePerf& perf = stage_perf[size_t(stage)];
+    perf.passes.fetch_add(1, std::memory_order_relaxed);
+    perf.cycles.fetch_add(counts.cycles, std::memory_order_relaxed);
+    perf.instructions.fetch_add(counts.instructions, std::memory_order_relaxed);
+    perf.cache_misses.fetch_add(counts.cache_misses, std::memory_order_relaxed);
+    perf.branch_misses.fetch_add(counts.branch_misses, std::memory_order_relaxed);
+}
+
+void printStagePerf(std::ostream& out){
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(2)
+        << "Counters per pass " << std::setw(10) << "passes" << std::setw(12) << "cycles" << std::setw(12) << "instrs"
+        << std::setw(8) << "IPC" << std::setw(12) << "cache miss" << std::setw(12) << "branch miss"
+        << std::setw(12) << "miss/kinstr" << "\n";
+    for (size_t stage = 0; stage < pipeline_stage_count; stage++) {
+        const StagePerf& perf = stage_perf[stage];
+        const uint64_t passes = perf.passes.load(std::memory_order_relaxed);
+        if (passes == 0) {continue;}
+        const double cycles = double(perf.cycles.load(std::memory_order_relaxed));
+        const double instructions = double(perf.instructions.load(std::memory_order_relaxed));
+        const double cache_misses = double(perf.cache_misses.load(std::memory_order_relaxed));
+        out << std::left << std::setw(18) << pipelineStageName(PipelineStage(stage)) << std::right
+            << std::setw(10) << passes
+            << std::setw(12) << cycles / passes
+            << std::setw(12) << instructions / passes
+            << std::setw(8) << (cycles > 0 ? instructions / cycles : 0)
+            << std::setw(12) << cache_misses / passes
+            << std::setw(12) << double(perf.branch_misses.load(std::memory_order_relaxed)) / passes
+            << std::setw(12) << (instructions > 0 ? cache_misses * 1000 / instructions : 0) << "\n";
+    }
+    out.flush();
+    out.flags(flags);
+    out.precision(precision);
+}
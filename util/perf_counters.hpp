@@ -0,0 +1,106 @@
+/**
+ * @file perf_counters.hpp
+ * @brief Hardware counters (cycles, instructions, cache and branch
+ * misses) per pipeline stage, through perf_event_open on Linux.
+ *
+ * @details Each thread that reads the counters opens its own group of
+ * four user-space counters the first time, so one read() gets all of them
+ * at the same instant.  PerfStageScope reads the group on entry and exit
+ * and adds the difference to the stage; StageTimer carries one, so every
+ * timed stage is counted too.  Scopes nest inclusively, like the latency
+ * stages, so "frame" includes "render".
+ *
+ * Reading the group is a syscall, about a microsecond, so this is off
+ * unless enablePerfCounters() is called, and the numbers are best
+ * compared with each other rather than against a build without it.
+ * When the kernel multiplexes the counters the values are scaled by
+ * the fraction of time they actually ran.
+ *
+ * Elsewhere than Linux, or when the kernel refuses (see
+ * /proc/sys/kernel/perf_event_paranoid), enablePerfCounters() says why
+ * and returns false.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+#include "pipeline_stage.hpp"
+
+struct PerfCounts {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cache_misses = 0;
+    uint64_t branch_misses = 0;
+
+    PerfCounts& operator+=(const PerfCounts& other){
+        cycles += other.cycles;
+        instructions += other.instructions;
+        cache_misses += other.cache_misses;
+        branch_misses += other.branch_misses;
+        return *this;
+    }
+};
+
+/**
+ * @brief Difference between two readings, clamped at zero since scaling
+ * a multiplexed counter can make it step back slightly
+ */
+inline PerfCounts operator-(const PerfCounts& end, const PerfCounts& start){
+    auto diff = [](uint64_t a, uint64_t b){ return a > b ? a - b : 0; };
+    return PerfCounts{diff(end.cycles, start.cycles), diff(end.instructions, start.instructions),
+                      diff(end.cache_misses, start.cache_misses), diff(end.branch_misses, start.branch_misses)};
+}
+
+inline std::atomic<bool> perf_counters_enabled{false};
+
+inline bool perfCountersEnabled(){ return perf_counters_enabled.load(std::memory_order_relaxed); }
+
+/**
+ * @brief Opens the calling thread's counters and turns counting on,
+ * false (with the reason on stderr) if they aren't available
+ */
+bool enablePerfCounters();
+
+/**
+ * @brief The calling thread's counts so far, zeros when counting is off
+ * or the thread couldn't open its counters
+ */
+PerfCounts readPerfCounts();
+
+/**
+ * @brief Adds one pass through a stage
+ */
+void recordStagePerf(PipelineStage stage, const PerfCounts& counts);
+
+/**
+ * @brief Prints per stage: passes, cycles, instructions, cache and branch
+ * misses per pass, IPC and cache misses per thousand instructions
+ */
+void printStagePerf(std::ostream& out);
+
+/**
+ * @brief Counts the enclosing block against a stage
+ */
+class PerfStageScope {
+public:
+    explicit PerfStageScope(PipelineStage stage) : stage(stage), active(perfCountersEnabled()) {
+        if (active) {start = readPerfCounts();}
+    }
+    ~PerfStageScope(){
+        if (active) {recordStagePerf(stage, readPerfCounts() - start);}
+    }
+
+    PerfStageScope(const PerfStageScope&) = delete;
+    PerfStageScope& operator=(const PerfStageScope&) = delete;
+
+private:
+    const PipelineStage stage;
+    const bool active;
+    PerfCounts start;
+};
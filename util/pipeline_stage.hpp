@@ -0,0 +1,44 @@
+/**
+ * @file pipeline_stage.hpp
+ * @brief Names for the steps a sample goes through, shared by the
+ * latency and allocation profiles.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class PipelineStage : uint8_t {
+    Read,           // read() that returned serial bytes
+    Frame,          // one sample through everything done with it
+    Parse,          // splitting a chunk into samples, handlers not included
+    MapUpdate,      // grid and measurement updates for one sample
+    Render,         // drawing the radar frame
+    Present,        // upscaling and putting it on screen
+    SampleToPhoton, // from the bytes arriving to the frame being shown
+    SampleToFrame,  // the same with --headless, to the frame being drawn
+    IngestWakeup,   // how late the ingest thread woke for its next read
+    Count,
+};
+
+const size_t pipeline_stage_count = size_t(PipelineStage::Count);
+
+inline const char* pipelineStageName(PipelineStage stage){
+    switch (stage) {
+        case PipelineStage::Read: return "read";
+        case PipelineStage::Frame: return "frame";
+        case PipelineStage::Parse: return "parse";
+        case PipelineStage::MapUpdate: return "map update";
+        case PipelineStage::Render: return "render";
+        case PipelineStage::Present: return "present";
+        case PipelineStage::SampleToPhoton: return "sample-to-photon";
+        case PipelineStage::SampleToFrame: return "sample-to-frame";
+        case PipelineStage::IngestWakeup: return "ingest wakeup";
+        case PipelineStage::Count: break;
+    }
+    return "other";
+}
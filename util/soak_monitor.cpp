@@ -0,0 +1,179 @@
+/**
+ * @file soak_monitor.cpp
+ * @brief Memory readings, per-interval latency and the trend check.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "soak_monitor.hpp"
+
+#include <unistd.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// Share of the run left out of the trend while everything fills up
+const double warmup_fraction = 0.25;
+const size_t min_judged_samples = 4;
+
+// Rises smaller than these are noise whatever their percentage, a short
+// run of fast frames can swing its p99 by half
+const double memory_floor_bytes = 1 << 20;
+const double latency_floor_us = 20;
+
+uint64_t nowNanoseconds(){
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+struct Trend {
+    double start = 0;   // where the fitted line starts
+    double rise = 0;    // how far it climbs over the judged span
+};
+
+/**
+ * @brief Least-squares line through the judged samples
+ */
+template <typename F>
+Trend fitTrend(const std::vector<SoakSample>& samples, size_t first, F&& value){
+    const size_t n = samples.size() - first;
+    double mean_x = 0, mean_y = 0;
+    for (size_t i = first; i < samples.size(); i++) {
+        mean_x += samples[i].elapsed_s;
+        mean_y += value(samples[i]);
+    }
+    mean_x /= n;
+    mean_y /= n;
+    double covariance = 0, variance = 0;
+    for (size_t i = first; i < samples.size(); i++) {
+        const double dx = samples[i].elapsed_s - mean_x;
+        covariance += dx * (value(samples[i]) - mean_y);
+        variance += dx * dx;
+    }
+    if (variance == 0) {return Trend{mean_y, 0};}
+    const double slope = covariance / variance;
+    return Trend{mean_y + slope * (samples[first].elapsed_s - mean_x),
+                 slope * (samples.back().elapsed_s - samples[first].elapsed_s)};
+}
+
+} // namespace
+
+size_t residentBytes(){
+    std::FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) {return 0;}
+    unsigned long size = 0, resident = 0;
+    const bool read = std::fscanf(statm, "%lu %lu", &size, &resident) == 2;
+    std::fclose(statm);
+    return read ? size_t(resident) * size_t(sysconf(_SC_PAGESIZE)) : 0;
+}
+
+void heapBytes(size_t& in_use, size_t& mapped){
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    in_use = info.uordblks + info.hblkhd;
+    mapped = info.arena + info.hblkhd;
+#else
+    in_use = 0;
+    mapped = 0;
+#endif
+}
+
+SoakMonitor::SoakMonitor(double memory_pct, double latency_pct)
+    : memory_pct(memory_pct), latency_pct(latency_pct), start_ns(nowNanoseconds()) {}
+
+SoakMonitor::~SoakMonitor(){
+    if (log) {std::fclose(log);}
+}
+
+bool SoakMonitor::openLog(const std::string& path){
+    log = std::fopen(path.c_str(), "w");
+    if (!log) {
+        std::cerr << "Error opening soak log: " << path << std::endl;
+        return false;
+    }
+    std::fprintf(log, "elapsed_s,samples,rss_bytes,heap_in_use_bytes,heap_mapped_bytes,pending_bytes,frame_p50_us,frame_p99_us\n");
+    return true;
+}
+
+void SoakMonitor::record(std::ostream& out, uint64_t samples, size_t pending_bytes){
+    SoakSample sample;
+    sample.elapsed_s = (nowNanoseconds() - start_ns) / 1e9;
+    sample.samples = samples;
+    sample.rss_bytes = residentBytes();
+    heapBytes(sample.heap_in_use_bytes, sample.heap_mapped_bytes);
+    sample.pending_bytes = pending_bytes;
+
+    // Percentiles of this interval alone, the histograms only ever add up
+    const LatencySummary frames = mergeStageLatencies()[size_t(PipelineStage::Frame)];
+    LatencySummary interval = frames;
+    for (size_t bucket = 0; bucket < interval.buckets.size(); bucket++) {
+        interval.buckets[bucket] -= std::min(interval.buckets[bucket], previous_frames.buckets[bucket]);
+    }
+    interval.count = frames.count - std::min(frames.count, previous_frames.count);
+    interval.sum_ns = frames.sum_ns - std::min(frames.sum_ns, previous_frames.sum_ns);
+    previous_frames = frames;
+    sample.p50_us = interval.percentile(0.5) / 1e3;
+    sample.p99_us = interval.percentile(0.99) / 1e3;
+    history.push_back(sample);
+
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(1) << "Soak " << sample.elapsed_s << " s: " << samples << " samples, RSS "
+        << sample.rss_bytes / 1048576.0 << " MiB, heap " << sample.heap_in_use_bytes / 1048576.0 << " MiB, backlog "
+        << pending_bytes << " B, frame p50 " << sample.p50_us << " us p99 " << sample.p99_us << " us" << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+    if (log) {
+        std::fprintf(log, "%.3f,%llu,%zu,%zu,%zu,%zu,%.3f,%.3f\n", sample.elapsed_s, (unsigned long long)samples,
+                     sample.rss_bytes, sample.heap_in_use_bytes, sample.heap_mapped_bytes, pending_bytes,
+                     sample.p50_us, sample.p99_us);
+        std::fflush(log);
+    }
+}
+
+bool SoakMonitor::judge(std::ostream& out) const {
+    const size_t first = size_t(history.size() * warmup_fraction);
+    if (history.size() - first < min_judged_samples) {
+        out << "Soak too short to judge (" << history.size() << " samples, need "
+            << size_t(std::ceil(min_judged_samples / (1 - warmup_fraction))) << ")" << std::endl;
+        return true;
+    }
+
+    struct Series {
+        const char* name;
+        double (*value)(const SoakSample&);
+        double limit_pct;
+        double floor;
+    };
+    const Series series[] = {
+        {"RSS", [](const SoakSample& s){ return double(s.rss_bytes); }, memory_pct, memory_floor_bytes},
+        {"heap in use", [](const SoakSample& s){ return double(s.heap_in_use_bytes); }, memory_pct, memory_floor_bytes},
+        {"frame p99", [](const SoakSample& s){ return s.p99_us; }, latency_pct, latency_floor_us},
+    };
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    bool passed = true;
+    for (const Series& trend : series) {
+        const Trend fit = fitTrend(history, first, trend.value);
+        const double rise = fit.start > 0 ? fit.rise / fit.start * 100 : 0;
+        const bool ok = rise <= trend.limit_pct || fit.rise <= trend.floor;
+        passed = passed && ok;
+        out << "Soak trend " << std::left << std::setw(16) << trend.name << std::right << std::setw(8) << rise
+            << "% (limit " << trend.limit_pct << "%)" << (ok ? "" : "  FAIL") << "\n";
+    }
+    out << (passed ? "Soak passed" : "Soak failed") << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+    return passed;
+}
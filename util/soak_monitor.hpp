@@ -0,0 +1,92 @@
+/**
+ * @file soak_monitor.hpp
+ * @brief Samples memory, backlogs and latency through a long run and
+ * fails it when they trend upward.
+ *
+ * @details Each record() takes the resident set (/proc/self/statm), the
+ * allocator's in-use and mapped bytes (mallinfo2 on glibc), the log
+ * writers' backlog and the frame latency percentiles of the interval
+ * since the previous record.  judge() fits a line through everything
+ * after the first quarter of the run, which is left for the map, trail
+ * and buffers to fill up, and fails if the fit rises by more than the
+ * given percentage of its starting value over that span (and by more
+ * than a small absolute floor, 1 MiB or 20 us, below which it's noise).
+ * A slow leak in the map or history shows up as a steady rise in RSS or
+ * heap; a structure that grows and gets slower to walk shows up in the
+ * p99.  The backlog is recorded but not judged, the writers already cap
+ * it.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.hpp"
+
+struct SoakSample {
+    double elapsed_s = 0;
+    uint64_t samples = 0;
+    size_t rss_bytes = 0;
+    size_t heap_in_use_bytes = 0;
+    size_t heap_mapped_bytes = 0;
+    size_t pending_bytes = 0;
+    double p50_us = 0;
+    double p99_us = 0;
+};
+
+/**
+ * @brief Resident set size of this process, 0 where /proc isn't there
+ */
+size_t residentBytes();
+
+/**
+ * @brief Bytes handed out by malloc and bytes it holds from the OS, both
+ * 0 outside glibc
+ */
+void heapBytes(size_t& in_use, size_t& mapped);
+
+class SoakMonitor {
+public:
+    /**
+     * @param memory_pct Allowed rise in RSS or heap over the judged span
+     * @param latency_pct Allowed rise in frame p99 over the judged span
+     */
+    SoakMonitor(double memory_pct, double latency_pct);
+    ~SoakMonitor();
+
+    SoakMonitor(const SoakMonitor&) = delete;
+    SoakMonitor& operator=(const SoakMonitor&) = delete;
+
+    /**
+     * @brief Also writes every sample to a CSV as it is taken
+     */
+    bool openLog(const std::string& path);
+
+    /**
+     * @brief Takes one sample, printing a line for it
+     *
+     * @param samples Samples handled so far
+     * @param pending_bytes Bytes waiting in the log writers
+     */
+    void record(std::ostream& out, uint64_t samples, size_t pending_bytes);
+
+    /**
+     * @brief Prints the trend of each series, false if any rose too much
+     */
+    bool judge(std::ostream& out) const;
+
+private:
+    const double memory_pct;
+    const double latency_pct;
+    const uint64_t start_ns;
+    std::vector<SoakSample> history;
+    LatencySummary previous_frames;
+    std::FILE* log = nullptr;
+};
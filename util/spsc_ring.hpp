@@ -0,0 +1,89 @@
+/**
+ * @file spsc_ring.hpp
+ * @brief Bounded lock-free queue between exactly one producer thread and
+ * one consumer thread.
+ *
+ * @details Slots are allocated up front, so neither side ever allocates,
+ * locks or makes a syscall, which is what lets a real-time producer hand
+ * data to a thread that may be stalled for a frame.  The two indices live
+ * on their own cache lines, and each side keeps a cached copy of the
+ * other's index, only reloading it when the ring looks full (producer) or
+ * empty (consumer), so in the steady state the line holding the other
+ * index isn't pulled over on every call.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @param capacity Slots, rounded up to a power of two
+     */
+    explicit SpscRing(size_t capacity){
+        size_t slots_count = 1;
+        while (slots_count < capacity) {slots_count <<= 1;}
+        slots.resize(slots_count);
+        mask = slots_count - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return slots.size(); }
+
+    /**
+     * @brief Producer side, false (and nothing stored) when full
+     */
+    bool push(const T& value){
+        const uint64_t tail = producer.index.load(std::memory_order_relaxed);
+        if (tail - producer.cached_other >= slots.size()) {
+            producer.cached_other = consumer.index.load(std::memory_order_acquire);
+            if (tail - producer.cached_other >= slots.size()) {return false;}
+        }
+        slots[tail & mask] = value;
+        producer.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Consumer side, false when empty
+     */
+    bool pop(T& value){
+        const uint64_t head = consumer.index.load(std::memory_order_relaxed);
+        if (head == consumer.cached_other) {
+            consumer.cached_other = producer.index.load(std::memory_order_acquire);
+            if (head == consumer.cached_other) {return false;}
+        }
+        value = slots[head & mask];
+        consumer.index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Items waiting, only a snapshot while the other side runs
+     */
+    size_t size() const {
+        return size_t(producer.index.load(std::memory_order_acquire) - consumer.index.load(std::memory_order_acquire));
+    }
+
+private:
+    // One side's index and its last look at the other side's
+    struct alignas(64) Side {
+        std::atomic<uint64_t> index{0};
+        uint64_t cached_other = 0;
+    };
+
+    std::vector<T> slots;
+    size_t mask = 0;
+    Side producer;
+    Side consumer;
+};
@@ -0,0 +1,115 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Worker startup, shutdown, task queues and stealing for ThreadPool.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "thread_pool.hpp"
+#include "trace.hpp"
+
+namespace {
+
+// Which pool (if any) the current thread works for, and its queue
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads){
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    queues.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    task_ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::homeQueue() const {
+    return current_pool == this ? current_queue : queues.size();
+}
+
+void ThreadPool::submit(std::function<void()> task){
+    WorkerQueue& queue = current_pool == this ? *queues[current_queue] : injected;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        queued.fetch_add(1);
+    }
+    // Taking the lock orders this with a worker checking queued before
+    // it sleeps, so the wakeup can't be missed
+    { std::lock_guard<std::mutex> lock(sleep_mutex); }
+    task_ready.notify_one();
+}
+
+void ThreadPool::wait(){
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    all_done.wait(lock, [this]() { return queued.load() == 0 && active.load() == 0; });
+}
+
+bool ThreadPool::runOneTask(size_t home){
+    std::function<void()> task;
+    auto take = [&](WorkerQueue& queue, bool newest) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {return;}
+        if (newest) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        active.fetch_add(1);
+        queued.fetch_sub(1);
+    };
+    // Newest from our own queue (still warm in cache), then outside
+    // submissions in the order they came, then the oldest of the others
+    if (home < queues.size()) {take(*queues[home], true);}
+    if (!task) {take(injected, false);}
+    for (size_t i = 1; i <= queues.size() && !task; i++) {
+        const size_t victim = (home + i) % queues.size();
+        if (victim != home) {take(*queues[victim], false);}
+    }
+    if (!task) {return false;}
+
+    {
+        TRACE_SCOPE("pool task");
+        task();
+    }
+
+    if (active.fetch_sub(1) == 1 && queued.load() == 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        all_done.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::workerLoop(size_t index){
+    current_pool = this;
+    current_queue = index;
+    setTraceThreadName("pool " + std::to_string(index));
+    while (true) {
+        if (runOneTask(index)) {continue;}
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        task_ready.wait(lock, [this]() { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0) {return;}
+    }
+}
@@ -0,0 +1,152 @@
+/**
+ * @file thread_pool.hpp
+ * @brief Small fixed-size thread pool shared by the mapping code.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of worker threads, each with its own task queue
+ *
+ * @details Workers are started once and reused, so the per-sweep
+ * parallel sections (particle weighting, query batches) don't pay for
+ * thread creation every time they run.  Tasks submitted from outside
+ * go on one shared queue and are started oldest first, in the order
+ * they were submitted; tasks a worker submits go on its own queue.  A
+ * worker takes the newest task from its own queue (still warm in cache),
+ * then the oldest submitted from outside, then steals the oldest from
+ * the other workers, so uneven work (a long session next to short ones)
+ * still keeps every core busy.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Starts the worker threads
+     *
+     * @param threads Worker count, 0 picks std::thread::hardware_concurrency
+     */
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Queues a task to run on some worker
+     *
+     * @param task The work to run, must not throw
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Blocks until every task submitted so far has finished
+     */
+    void wait();
+
+    /**
+     * @brief Splits [begin, end) into chunks and runs them on the pool
+     *
+     * @details The calling thread runs the first chunk itself and then
+     * keeps running queued tasks until its chunks are done, so a pool of
+     * N workers gives N+1 way parallelism and it is safe to call from
+     * inside a pool task.
+     *
+     * @param begin First index
+     * @param end One past the last index
+     * @param grain Indices per chunk
+     * @param fn Called as fn(chunk_begin, chunk_end)
+     */
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F&& fn);
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(size_t index);
+
+    /**
+     * @brief Runs one task, from queue home first and then stolen from
+     * the others, false if every queue was empty
+     */
+    bool runOneTask(size_t home);
+
+    /**
+     * @brief The calling worker's queue, or queues.size() for threads
+     * outside the pool, which have none
+     */
+    size_t homeQueue() const;
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    WorkerQueue injected;               // submitted from outside the pool, FIFO
+    std::atomic<size_t> queued{0};     // tasks sitting in some queue
+    std::atomic<size_t> active{0};     // tasks being run
+    std::mutex sleep_mutex;
+    std::condition_variable task_ready;
+    std::condition_variable all_done;
+    bool stopping = false;
+};
+
+template <typename F>
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain, F&& fn){
+    if (begin >= end) {return;}
+    grain = std::max<size_t>(grain, 1);
+    const size_t chunks = (end - begin + grain - 1) / grain;
+    if (chunks == 1 || workers.empty()) {
+        fn(begin, end);
+        return;
+    }
+
+    // Only touched under done_mutex: the last chunk's decrement and notify
+    // finish before the caller can see 0 and take these off the stack
+    size_t remaining = chunks;
+    std::mutex done_mutex;
+    std::condition_variable done;
+    auto finish_chunk = [&]() {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        if (--remaining == 0) {done.notify_one();}
+    };
+    auto finished = [&]() {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        return remaining == 0;
+    };
+
+    for (size_t chunk = 1; chunk < chunks; chunk++) {
+        const size_t chunk_begin = begin + chunk*grain;
+        const size_t chunk_end = std::min(end, chunk_begin + grain);
+        submit([&, chunk_begin, chunk_end]() {
+            fn(chunk_begin, chunk_end);
+            finish_chunk();
+        });
+    }
+    fn(begin, std::min(end, begin + grain));
+    finish_chunk();
+
+    // Help out rather than sleep while there is anything queued, this is
+    // what keeps a worker waiting here from starving its own chunks
+    const size_t home = homeQueue();
+    while (!finished()) {
+        if (runOneTask(home)) {continue;}
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done.wait(lock, [&]() { return remaining == 0; });
+    }
+}
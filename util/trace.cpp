@@ -0,0 +1,192 @@
+/**
+ * @file trace.cpp
+ * @brief Per-thread span buffers and the Chrome trace-event writer.
+ *
+ * @author Vladimir Herdman
+ * @date 2026-10-18
+ * @version 0.5.0
+ */
+#include "trace.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief A TraceEvent whose fields the trace writer may read while the
+ * recording thread overwrites them
+ */
+struct TraceSlot {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> start_ns{0};
+    std::atomic<uint64_t> end_ns{0};
+};
+
+/**
+ * @brief One thread's spans, appended only by that thread
+ *
+ * @details A ring: span i goes to slot i % slots, and the newest
+ * capacity spans are the ones kept.  count (every span ever recorded)
+ * is stored with release after each span is written, so the trace
+ * writer can copy the spans below it while the thread keeps going, then
+ * reads count again and throws away whatever was overwritten during the
+ * copy.  The one slot more than capacity is the one being written next,
+ * so a full ring still gives the writer capacity spans.
+ */
+struct ThreadTrace {
+    uint32_t id = 0;
+    std::string name;
+    std::unique_ptr<TraceSlot[]> events;
+    size_t capacity = 0;
+    size_t slots = 0;
+    std::atomic<size_t> count{0};
+};
+
+size_t events_per_thread = 0;
+uint64_t trace_start_ns = 0;
+
+// Every thread that ever traced, kept after it exits so its spans still
+// get written
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<ThreadTrace>>& registry(){
+    static std::vector<std::unique_ptr<ThreadTrace>> all;
+    return all;
+}
+
+thread_local ThreadTrace* thread_trace = nullptr;
+
+ThreadTrace& threadTrace(){
+    if (!thread_trace) {
+        auto trace = std::make_unique<ThreadTrace>();
+        trace->capacity = events_per_thread;
+        trace->slots = events_per_thread + 1;
+        trace->events = std::make_unique<TraceSlot[]>(trace->slots);
+        thread_trace = trace.get();
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        trace->id = uint32_t(registry().size() + 1);
+        trace->name = "thread " + std::to_string(trace->id);
+        registry().push_back(std::move(trace));
+    }
+    return *thread_trace;
+}
+
+/**
+ * @brief Writes a string as a JSON string literal
+ */
+void writeJsonString(std::FILE* file, const char* text){
+    std::fputc('"', file);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {std::fputc('\\', file);}
+        if (static_cast<unsigned char>(*c) < 0x20) {
+            std::fprintf(file, "\\u%04x", unsigned(*c));
+            continue;
+        }
+        std::fputc(*c, file);
+    }
+    std::fputc('"', file);
+}
+
+/**
+ * @brief The spans a thread still holds, oldest first
+ */
+std::vector<TraceEvent> copySpans(const ThreadTrace& trace){
+    const size_t count = trace.count.load(std::memory_order_acquire);
+    const size_t first = count > trace.capacity ? count - trace.capacity : 0;
+    std::vector<TraceEvent> spans;
+    spans.reserve(count - first);
+    for (size_t i = first; i < count; i++) {
+        const TraceSlot& slot = trace.events[i % trace.slots];
+        spans.push_back(TraceEvent{slot.name.load(std::memory_order_relaxed),
+                                   slot.start_ns.load(std::memory_order_relaxed),
+                                   slot.end_ns.load(std::memory_order_relaxed)});
+    }
+    // Pairs with the fence in traceComplete: span i's slot is reused by
+    // span i + slots, which only starts once count has reached that
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const size_t now = trace.count.load(std::memory_order_relaxed);
+    if (now > trace.capacity && now - trace.capacity > first) {
+        spans.erase(spans.begin(), spans.begin() + std::min(spans.size(), now - trace.capacity - first));
+    }
+    return spans;
+}
+
+} // namespace
+
+void enableTracing(size_t events){
+    events_per_thread = std::max<size_t>(events, 1);
+    trace_start_ns = traceNowNs();
+    trace_enabled = true;
+}
+
+void setTraceThreadName(const std::string& name){
+    if (!trace_enabled) {return;}
+    ThreadTrace& trace = threadTrace();
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    trace.name = name;
+}
+
+void traceComplete(const char* name, uint64_t start_ns, uint64_t end_ns){
+    if (!trace_enabled) {return;}
+    ThreadTrace& trace = threadTrace();
+    const size_t index = trace.count.load(std::memory_order_relaxed);
+    TraceSlot& slot = trace.events[index % trace.slots];
+    // Overwriting, so count having reached index has to be visible to
+    // a copySpans() that sees any of the new span
+    if (index >= trace.slots) {std::atomic_thread_fence(std::memory_order_release);}
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    trace.count.store(index + 1, std::memory_order_release);
+}
+
+bool writeChromeTrace(const std::string& path){
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "Error writing trace: " << path << std::endl;
+        return false;
+    }
+    const int pid = int(getpid());
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"radar\"}}", pid);
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const auto& trace : registry()) {
+        std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":",
+                     pid, trace->id);
+        writeJsonString(file, trace->name.c_str());
+        std::fprintf(file, "}}");
+
+        // Complete ("X") events, times in µs from enableTracing()
+        for (const TraceEvent& event : copySpans(*trace)) {
+            std::fprintf(file, ",\n{\"name\":");
+            writeJsonString(file, event.name);
+            std::fprintf(file, ",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", pid, trace->id,
+                         (event.start_ns - trace_start_ns) / 1e3, (event.end_ns - event.start_ns) / 1e3);
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+    const bool ok = std::ferror(file) == 0;
+    if (std::fclose(file) != 0 || !ok) {
+        std::cerr << "Error writing trace: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+uint64_t droppedTraceEvents(){
+    uint64_t dropped = 0;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const auto& trace : registry()) {
+        const size_t count = trace->count.load(std::memory_order_relaxed);
+        dropped += count > trace->capacity ? count - trace->capacity : 0;
+    }
+    return dropped;
+}